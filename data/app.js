@@ -5,7 +5,26 @@
 let ws = null;
 let currentConfig = { pins: [] };
 let availablePins = [];
+let availableAnalogPins = [];
 let pendingAction = null;
+let lastTelemetry = null;
+
+// Команды установки выходов ждут ack/nack по id. Неподтверждённые команды
+// повторяются после переподключения с тем же id, а по cid устройство
+// отличает повтор от новой команды и не применяет её дважды.
+const clientId = (crypto.getRandomValues(new Uint32Array(1))[0] >>> 1) || 1;
+let nextCommandId = 1;
+const pendingCommands = new Map();
+
+// Интервал телеметрии, которую устройство присылает по WebSocket (мс)
+const TELEMETRY_INTERVAL = 5000;
+// Интервал обновления значений аналоговых входов (мс)
+const ANALOG_INTERVAL = 500;
+// Сколько ждать подтверждения команды, включая переподключения (мс)
+const COMMAND_TIMEOUT = 10000;
+// Виртуальные пины расширителя MCP23017 (EXPANDER_PIN_BASE в config.h)
+const EXPANDER_PIN_BASE = 40;
+const EXPANDER_PIN_COUNT = 16;
 
 // ==================== ОСНОВНЫЕ ФУНКЦИИ ====================
 
@@ -22,6 +41,12 @@ document.addEventListener('DOMContentLoaded', function() {
     // Загрузка доступных пинов
     updateAvailablePins();
     
+    // Загрузка настроек MQTT
+    loadMQTTConfig();
+    
+    // Загрузка настроек обнаружения в сети
+    loadFleetConfig();
+    
     // Показываем первую вкладку
     showTab('inputs');
     
@@ -38,24 +63,6 @@ function updateConnectionStatus(connected) {
     }
 }
 
-// В функции initWebSocket обновите обработчики:
-ws.onopen = function() {
-    console.log('WebSocket connected');
-    updateConnectionStatus(true);
-    // ... остальной код
-};
-
-ws.onclose = function() {
-    console.log('WebSocket disconnected');
-    updateConnectionStatus(false);
-    setTimeout(initWebSocket, 2000);
-};
-
-ws.onerror = function(error) {
-    console.error('WebSocket error:', error);
-    updateConnectionStatus(false);
-};
-
 // Настройка обработчиков событий
 function setupEventListeners() {
     // Форма WiFi
@@ -64,6 +71,18 @@ function setupEventListeners() {
         wifiForm.addEventListener('submit', saveWiFiConfig);
     }
     
+    // Форма MQTT
+    const mqttForm = document.getElementById('mqtt-form');
+    if (mqttForm) {
+        mqttForm.addEventListener('submit', saveMQTTConfig);
+    }
+    
+    // Форма обнаружения в сети
+    const fleetForm = document.getElementById('fleet-form');
+    if (fleetForm) {
+        fleetForm.addEventListener('submit', saveFleetConfig);
+    }
+    
     // Кнопка проверки IP
     const checkIpBtn = document.getElementById('check-ip-btn');
     if (checkIpBtn) {
@@ -126,10 +145,23 @@ function initWebSocket() {
     
     ws.onopen = function() {
         console.log('WebSocket connected');
+        updateConnectionStatus(true);
         
-        // Запросить текущие состояния после подключения
+        // Запросить текущие состояния после подключения и подписаться на телеметрию
+        // и значения аналоговых входов
         if (ws.readyState === WebSocket.OPEN) {
             ws.send(JSON.stringify({ action: 'getStates' }));
+            ws.send(JSON.stringify({
+                action: 'subscribe',
+                topics: ['telemetry'],
+                rate: TELEMETRY_INTERVAL
+            }));
+            ws.send(JSON.stringify({
+                action: 'subscribe',
+                topics: ['analog'],
+                rate: ANALOG_INTERVAL
+            }));
+            resendPendingCommands();
         }
     };
     
@@ -138,6 +170,10 @@ function initWebSocket() {
             const data = JSON.parse(event.data);
             console.log('WebSocket message:', data);
             
+            if (data.ack !== undefined || data.nack !== undefined) {
+                handleCommandResult(data);
+            }
+            
             // Обработка обновления состояния пина
             if (data.pin !== undefined && data.val !== undefined) {
                 updatePinStatus(data.pin, data.val);
@@ -146,6 +182,10 @@ function initWebSocket() {
             // Обработка других сообщений
             if (data.type === 'info') {
                 updateSystemInfo(data);
+            } else if (data.type === 'analog') {
+                data.pins.forEach(([pin, mv]) => updateAnalogValue(pin, mv));
+            } else if (data.mv !== undefined) {
+                updateAnalogValue(data.pin, data.mv);
             }
         } catch (error) {
             console.error('Error parsing WebSocket message:', error, event.data);
@@ -154,11 +194,14 @@ function initWebSocket() {
     
     ws.onclose = function() {
         console.log('WebSocket disconnected, reconnecting in 2s...');
+        updateConnectionStatus(false);
+        lastTelemetry = null;
         setTimeout(initWebSocket, 2000);
     };
     
     ws.onerror = function(error) {
         console.error('WebSocket error:', error);
+        updateConnectionStatus(false);
     };
 }
 
@@ -207,6 +250,14 @@ function updatePinStatus(pin, value) {
     }
 }
 
+// Обновление значения аналогового входа
+function updateAnalogValue(pin, mv) {
+    const element = document.querySelector(`.input-status[data-pin="${pin}"] .analog-mv`);
+    if (element) {
+        element.textContent = `${mv} мВ`;
+    }
+}
+
 // Управление выходом
 function toggleOutput(pin) {
     const outputElement = document.querySelector(`.output-control[data-pin="${pin}"]`);
@@ -221,10 +272,10 @@ function toggleOutput(pin) {
     
     // Отправляем команду через WebSocket
     if (ws && ws.readyState === WebSocket.OPEN) {
-        ws.send(JSON.stringify({ 
+        sendCommand({ 
             pin: parseInt(pin), 
             val: newState 
-        }));
+        });
         console.log(`Toggling pin ${pin} to ${newState}`);
     } else {
         console.error('WebSocket not connected');
@@ -232,6 +283,43 @@ function toggleOutput(pin) {
     }
 }
 
+// Отправка команды установки с id; ответ обрабатывает handleCommandResult
+function sendCommand(command) {
+    const id = nextCommandId++;
+    const message = JSON.stringify(Object.assign({ id: id, cid: clientId }, command));
+    pendingCommands.set(id, { message: message, sentAt: Date.now() });
+    ws.send(message);
+    return id;
+}
+
+function handleCommandResult(data) {
+    const id = data.ack !== undefined ? data.ack : data.nack;
+    const command = pendingCommands.get(id);
+    if (!command) return;
+    pendingCommands.delete(id);
+    
+    const rtt = Date.now() - command.sentAt;
+    if (data.ack !== undefined) {
+        console.log(`Command ${id} applied in ${rtt} ms${data.dup ? ' (duplicate)' : ''}`);
+    } else {
+        showError(`Пин ${pinLabel(data.pin)}: ${data.error === 'not_output' ? 'не настроен как выход' : 'не настроен'}`);
+    }
+}
+
+// Неподтверждённые команды после переподключения: устройство либо
+// выполнит их, либо ответит сохранённым результатом
+function resendPendingCommands() {
+    const now = Date.now();
+    pendingCommands.forEach((command, id) => {
+        if (now - command.sentAt > COMMAND_TIMEOUT) {
+            pendingCommands.delete(id);
+            showError('Команда не подтверждена устройством');
+        } else {
+            ws.send(command.message);
+        }
+    });
+}
+
 // ==================== ЗАГРУЗКА КОНФИГУРАЦИИ ====================
 
 // Загрузка конфигурации пинов
@@ -283,6 +371,7 @@ async function updateAvailablePins() {
         } else if (data && data.pins && Array.isArray(data.pins)) {
             // Если ответ - объект с полем pins
             availablePins = data.pins;
+            availableAnalogPins = Array.isArray(data.analog) ? data.analog : [];
         } else {
             console.warn('Unexpected response format:', data);
             availablePins = [];
@@ -305,18 +394,22 @@ function updatePinSelect() {
     // Очищаем список
     select.innerHTML = '<option value="">Выберите пин...</option>';
     
+    // Аналоговые входы доступны только на пинах ADC1
+    const pinType = document.getElementById('pin-type');
+    const pins = pinType && pinType.value === 'analog' ? availableAnalogPins : availablePins;
+    
     // Добавляем доступные пины
-    if (Array.isArray(availablePins)) {
-        availablePins.forEach(pin => {
+    if (Array.isArray(pins)) {
+        pins.forEach(pin => {
             const option = document.createElement('option');
             option.value = pin;
-            option.textContent = `GPIO ${pin}`;
+            option.textContent = pinLabel(pin);
             select.appendChild(option);
         });
     }
     
     // Если нет доступных пинов
-    if (availablePins.length === 0) {
+    if (pins.length === 0) {
         const option = document.createElement('option');
         option.value = "";
         option.textContent = "Нет доступных пинов";
@@ -356,9 +449,9 @@ function renderConfigTable() {
         row.dataset.pin = pinConfig.pin;
         
         row.innerHTML = `
-            <td>${pinConfig.pin}</td>
+            <td>${pinLabel(pinConfig.pin)}</td>
             <td>${pinConfig.name || 'Без имени'}</td>
-            <td>${pinConfig.type === 'input' ? 'Вход' : 'Выход'}</td>
+            <td>${pinTypeName(pinConfig.type)}</td>
             <td>${pinConfig.memory ? 'Да' : 'Нет'}</td>
             <td class="pin-status ${pinConfig.type === 'output' ? (digitalRead(pinConfig.pin) ? 'status-high' : 'status-low') : ''}">
                 ${pinConfig.type === 'output' ? (digitalRead(pinConfig.pin) ? 'HIGH' : 'LOW') : '-'}
@@ -380,7 +473,7 @@ function renderInputsTab() {
     
     container.innerHTML = '';
     
-    const inputPins = currentConfig.pins.filter(pin => pin.type === 'input');
+    const inputPins = currentConfig.pins.filter(pin => pin.type === 'input' || pin.type === 'analog');
     
     if (inputPins.length === 0) {
         container.innerHTML = '<div class="empty-state">Нет настроенных входов</div>';
@@ -395,13 +488,16 @@ function renderInputsTab() {
         card.innerHTML = `
             <div class="pin-header">
                 <h4>${pin.name || 'Без имени'}</h4>
-                <span class="pin-label">GPIO${pin.pin}</span>
+                <span class="pin-label">${pinLabel(pin.pin)}</span>
             </div>
             <div class="pin-status-display">
                 <div class="status-indicator status-low" title="LOW"></div>
                 <div class="status-info">
                     <span class="pin-value">LOW</span>
-                    <small>${pin.mode === 'pullup' ? 'С подтяжкой' : 'Без подтяжки'}</small>
+                    ${pin.type === 'analog'
+                        ? `<span class="analog-mv">- мВ</span>
+                           <small>${pin.threshold_high ? `Пороги ${pin.threshold_low}/${pin.threshold_high} мВ` : 'Без порогов'}</small>`
+                        : `<small>${pin.mode === 'pullup' ? 'С подтяжкой' : 'Без подтяжки'}</small>`}
                 </div>
             </div>
         `;
@@ -432,7 +528,7 @@ function renderOutputsTab() {
         card.innerHTML = `
             <div class="pin-header">
                 <h4>${pin.name || 'Без имени'}</h4>
-                <span class="pin-label">GPIO${pin.pin}</span>
+                <span class="pin-label">${pinLabel(pin.pin)}</span>
             </div>
             <div class="pin-status-display">
                 <div class="status-info">
@@ -459,6 +555,7 @@ async function addPinConfig() {
     const pinType = document.getElementById('pin-type');
     const pinMemory = document.getElementById('pin-memory');
     const inputMode = document.getElementById('input-mode');
+    const analogFilter = document.getElementById('analog-filter');
     
     if (!pinSelect || !pinName || !pinType) {
         showError('Форма не найдена');
@@ -469,7 +566,14 @@ async function addPinConfig() {
     const name = pinName.value.trim();
     const type = pinType.value;
     const memory = pinMemory ? pinMemory.checked : false;
-    const mode = type === 'input' ? (inputMode ? inputMode.value : 'pullup') : (memory ? 'memory' : 'normal');
+    let mode;
+    if (type === 'input') {
+        mode = inputMode ? inputMode.value : 'pullup';
+    } else if (type === 'analog') {
+        mode = analogFilter ? analogFilter.value : 'ema';
+    } else {
+        mode = memory ? 'memory' : 'normal';
+    }
     
     // Валидация
     if (!pin || isNaN(pin)) {
@@ -484,7 +588,7 @@ async function addPinConfig() {
     
     // Проверяем, не занят ли уже этот пин
     if (currentConfig.pins.some(p => p.pin === pin)) {
-        showError(`GPIO ${pin} уже используется`);
+        showError(`${pinLabel(pin)} уже используется`);
         return;
     }
     
@@ -498,6 +602,24 @@ async function addPinConfig() {
         enabled: true
     };
     
+    if (type === 'analog') {
+        newPin.decimation = parseInt(document.getElementById('analog-decimation').value) || 100;
+        newPin.window = parseInt(document.getElementById('analog-window').value) || 8;
+        newPin.threshold_high = parseInt(document.getElementById('analog-high').value) || 0;
+        // Без верхнего порога событий нет, нижний не нужен
+        newPin.threshold_low = newPin.threshold_high ?
+            (parseInt(document.getElementById('analog-low').value) || 0) : 0;
+        
+        if (newPin.window < 1 || newPin.window > 32 || newPin.decimation < 1 || newPin.decimation > 10000) {
+            showError('Окно фильтра - от 1 до 32, децимация - от 1 до 10000');
+            return;
+        }
+        if (newPin.threshold_low > newPin.threshold_high) {
+            showError('Нижний порог должен быть не выше верхнего');
+            return;
+        }
+    }
+    
     // Добавляем в текущую конфигурацию
     if (!currentConfig.pins) {
         currentConfig.pins = [];
@@ -546,7 +668,7 @@ async function addPinConfig() {
 // Удаление пина
 async function deletePin(pin) {
     showConfirmModal(
-        `Удалить конфигурацию GPIO ${pin}?`,
+        `Удалить конфигурацию ${pinLabel(pin)}?`,
         async () => {
             try {
                 // Фильтруем удаляемый пин
@@ -609,7 +731,13 @@ function editPin(pin) {
             pinMemory.checked = pinConfig.memory || false;
         }
         
-        if (inputMode && pinConfig.mode) {
+        if (pinConfig.type === 'analog') {
+            document.getElementById('analog-filter').value = pinConfig.mode || 'ema';
+            document.getElementById('analog-window').value = pinConfig.window || 8;
+            document.getElementById('analog-decimation').value = pinConfig.decimation || 100;
+            document.getElementById('analog-high').value = pinConfig.threshold_high || 0;
+            document.getElementById('analog-low').value = pinConfig.threshold_low || 0;
+        } else if (inputMode && pinConfig.mode) {
             inputMode.value = pinConfig.mode;
         }
         
@@ -622,7 +750,7 @@ function editPin(pin) {
         // Прокручиваем к форме
         document.getElementById('gpio-config').scrollIntoView({ behavior: 'smooth' });
         
-        showInfo(`Редактирование GPIO ${pin}. Измените параметры и сохраните.`);
+        showInfo(`Редактирование ${pinLabel(pin)}. Измените параметры и сохраните.`);
     }
 }
 
@@ -695,6 +823,137 @@ async function saveWiFiConfig(event) {
     }
 }
 
+// ==================== MQTT ====================
+
+// Загрузка настроек MQTT
+async function loadMQTTConfig() {
+    try {
+        const response = await fetch('/api/mqtt');
+        if (!response.ok) {
+            throw new Error(`HTTP error! status: ${response.status}`);
+        }
+        
+        const config = await response.json();
+        
+        document.getElementById('mqtt-enabled').checked = config.enabled || false;
+        document.getElementById('mqtt-host').value = config.host || '';
+        document.getElementById('mqtt-port').value = config.port || 1883;
+        document.getElementById('mqtt-user').value = config.user || '';
+        document.getElementById('mqtt-topic').value = config.base_topic || '';
+        
+        const status = document.getElementById('mqtt-status');
+        if (status) {
+            const stats = config.stats || {};
+            status.textContent = `Статус: ${config.connected ? 'подключено' : 'не подключено'}, ` +
+                `опубликовано: ${stats.published || 0}, в очереди: ${stats.queue_depth || 0}, ` +
+                `задержка: ${stats.latency_avg_ms || 0} мс`;
+        }
+    } catch (error) {
+        console.error('Error loading MQTT config:', error);
+    }
+}
+
+// Сохранение настроек MQTT
+async function saveMQTTConfig(event) {
+    event.preventDefault();
+    
+    const mqttConfig = {
+        enabled: document.getElementById('mqtt-enabled')?.checked || false,
+        host: document.getElementById('mqtt-host')?.value || '',
+        port: parseInt(document.getElementById('mqtt-port')?.value) || 1883,
+        user: document.getElementById('mqtt-user')?.value || '',
+        password: document.getElementById('mqtt-password')?.value || '',
+        base_topic: document.getElementById('mqtt-topic')?.value || ''
+    };
+    
+    if (mqttConfig.enabled && !mqttConfig.host) {
+        showError('Введите адрес MQTT брокера');
+        return;
+    }
+    
+    try {
+        const response = await fetch('/api/mqtt', {
+            method: 'POST',
+            headers: {
+                'Content-Type': 'application/json',
+            },
+            body: JSON.stringify(mqttConfig)
+        });
+        
+        if (response.ok) {
+            showSuccess('Настройки MQTT сохранены');
+            document.getElementById('mqtt-password').value = '';
+            loadMQTTConfig();
+        } else {
+            const error = await response.text();
+            throw new Error(error);
+        }
+    } catch (error) {
+        console.error('Error saving MQTT config:', error);
+        showError('Ошибка сохранения настроек MQTT: ' + error.message);
+    }
+}
+
+// ==================== Обнаружение в сети ====================
+
+// Загрузка настроек UDP multicast
+async function loadFleetConfig() {
+    try {
+        const response = await fetch('/api/fleet');
+        if (!response.ok) {
+            throw new Error(`HTTP error! status: ${response.status}`);
+        }
+        
+        const config = await response.json();
+        
+        document.getElementById('fleet-announce').checked = config.announce || false;
+        document.getElementById('fleet-state').checked = config.state || false;
+        document.getElementById('fleet-heartbeat').value = config.heartbeat || 5000;
+        
+        const status = document.getElementById('fleet-status');
+        if (status) {
+            const stats = config.stats || {};
+            status.textContent = `Группа: ${config.group}:${config.port}, ` +
+                `объявлений: ${stats.announces || 0}, состояний: ${stats.states || 0}, ` +
+                `ошибок: ${stats.send_errors || 0}`;
+        }
+    } catch (error) {
+        console.error('Error loading fleet config:', error);
+    }
+}
+
+// Сохранение настроек UDP multicast
+async function saveFleetConfig(event) {
+    event.preventDefault();
+    
+    const fleetConfig = {
+        announce: document.getElementById('fleet-announce')?.checked || false,
+        state: document.getElementById('fleet-state')?.checked || false,
+        heartbeat: parseInt(document.getElementById('fleet-heartbeat')?.value) || 5000
+    };
+    
+    try {
+        const response = await fetch('/api/fleet', {
+            method: 'POST',
+            headers: {
+                'Content-Type': 'application/json',
+            },
+            body: JSON.stringify(fleetConfig)
+        });
+        
+        if (response.ok) {
+            showSuccess('Настройки обнаружения сохранены');
+            loadFleetConfig();
+        } else {
+            const error = await response.text();
+            throw new Error(error);
+        }
+    } catch (error) {
+        console.error('Error saving fleet config:', error);
+        showError('Ошибка сохранения настроек обнаружения: ' + error.message);
+    }
+}
+
 // Проверка текущего IP
 async function checkCurrentIP() {
     try {
@@ -753,7 +1012,8 @@ async function showSystemInfo() {
             throw new Error(`HTTP error! status: ${response.status}`);
         }
         
-        const info = await response.json();
+        // Динамические поля берём из последней телеметрии, если она есть
+        const info = Object.assign(await response.json(), lastTelemetry || {});
         
         // Форматируем информацию
         const formattedInfo = {
@@ -766,6 +1026,29 @@ async function showSystemInfo() {
             'Имя сети': info.ssid || 'Неизвестно'
         };
         
+        if (lastTelemetry) {
+            formattedInfo['Минимум свободной памяти'] = formatBytes(info.min_free_heap || 0);
+            formattedInfo['Циклов loop() в секунду'] = info.loop_rate || 0;
+            formattedInfo['Время loop() (сред./макс.)'] = `${info.loop_avg_us || 0} / ${info.loop_max_us || 0} мкс`;
+        }
+        
+        // Сетевая задержка WebSocket по замерам устройства
+        try {
+            const clients = await (await fetch('/api/clients')).json();
+            if (clients.rtt && clients.rtt.samples) {
+                formattedInfo['RTT WebSocket (p50/p99)'] =
+                    `${(clients.rtt.p50_us / 1000).toFixed(1)} / ${(clients.rtt.p99_us / 1000).toFixed(1)} мс`;
+            }
+        } catch (error) {
+            console.error('Error loading client stats:', error);
+        }
+        
+        if (info.expander) {
+            formattedInfo['Расширитель MCP23017'] = info.expander.present
+                ? `чтений ${info.expander.reads}, записей ${info.expander.writes}, ошибок ${info.expander.errors}`
+                : 'Не найден';
+        }
+        
         // Отображаем в модальном окне
         const infoDialog = document.getElementById('info-dialog');
         const infoContent = document.getElementById('system-info');
@@ -805,18 +1088,40 @@ function togglePinOptions() {
     const pinType = document.getElementById('pin-type');
     const inputOptions = document.getElementById('input-options');
     const outputOptions = document.getElementById('output-options');
+    const analogOptions = document.getElementById('analog-options');
     
-    if (pinType && inputOptions && outputOptions) {
-        if (pinType.value === 'input') {
-            inputOptions.style.display = 'block';
-            outputOptions.style.display = 'none';
-        } else {
-            inputOptions.style.display = 'none';
-            outputOptions.style.display = 'block';
+    if (pinType && inputOptions && outputOptions && analogOptions) {
+        inputOptions.style.display = pinType.value === 'input' ? 'block' : 'none';
+        outputOptions.style.display = pinType.value === 'output' ? 'block' : 'none';
+        analogOptions.style.display = pinType.value === 'analog' ? 'block' : 'none';
+        
+        // При редактировании номер пина не меняется
+        const pinSelect = document.getElementById('pin-select');
+        if (pinSelect && !pinSelect.disabled) {
+            updatePinSelect();
         }
     }
 }
 
+// Подпись пина: GPIO ESP32 или порт расширителя (EXP GPA0..GPB7)
+function pinLabel(pin) {
+    if (pin >= EXPANDER_PIN_BASE && pin < EXPANDER_PIN_BASE + EXPANDER_PIN_COUNT) {
+        const bit = pin - EXPANDER_PIN_BASE;
+        return `EXP GP${bit < 8 ? 'A' : 'B'}${bit % 8}`;
+    }
+    return `GPIO ${pin}`;
+}
+
+// Название типа пина для таблицы
+function pinTypeName(type) {
+    switch (type) {
+        case 'input': return 'Вход';
+        case 'output': return 'Выход';
+        case 'analog': return 'Аналоговый';
+        default: return type;
+    }
+}
+
 // Обновление статусов
 function updateStatusDisplays() {
     // Запрашиваем начальные состояния через WebSocket
@@ -825,9 +1130,10 @@ function updateStatusDisplays() {
     }
 }
 
-// Обновление информации о системе
+// Обновление информации о системе (телеметрия по WebSocket)
 function updateSystemInfo(info) {
-    // Можно обновлять информацию на странице в реальном времени
+    lastTelemetry = info;
+    
     const uptimeElement = document.getElementById('uptime-display');
     if (uptimeElement && info.uptime) {
         uptimeElement.textContent = formatUptime(info.uptime);
@@ -1025,14 +1331,8 @@ if (document.head) {
 
 // ==================== АВТООБНОВЛЕНИЕ ====================
 
-// Автоматическое обновление статусов каждые 30 секунд
-setInterval(() => {
-    if (ws && ws.readyState === WebSocket.OPEN) {
-        ws.send(JSON.stringify({ action: 'ping' }));
-    }
-}, 30000);
+// Соединение проверяет само устройство: кадры ping для замера RTT
+// (/api/clients) приходят каждые 5 секунд, браузер отвечает на них сам
 
-// Автоматическое обновление информации о системе каждую минуту
-setInterval(() => {
-    updateAvailablePins();
-}, 60000);
\ No newline at end of file
+// Состояния пинов и телеметрия приходят по WebSocket по подписке,
+// периодический опрос HTTP не нужен
\ No newline at end of file
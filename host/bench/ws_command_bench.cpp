@@ -0,0 +1,66 @@
+// Производительность разбора команд WebSocket на ПК: pio run -e bench_ws_command
+// Запуск: .pio/build/bench_ws_command/program [итераций]
+// Абсолютные числа относятся к ПК; для сравнения версий парсера между собой.
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include "ws_command.h"
+
+namespace {
+
+struct Frame {
+    const char* name;
+    char text[WS_MAX_FRAME_SIZE];
+    size_t length;
+};
+
+void setFrame(Frame& frame, const char* name, const char* text) {
+    frame.name = name;
+    frame.length = (size_t)snprintf(frame.text, sizeof(frame.text), "%s", text);
+}
+
+// Пакет из WS_BATCH_MAX элементов с идентификатором - худший случай по длине
+void setFullBatch(Frame& frame) {
+    frame.name = "batch33+id";
+    int len = snprintf(frame.text, sizeof(frame.text), "{\"batch\":[");
+    for (int i = 0; i < WS_BATCH_MAX; i++) {
+        len += snprintf(frame.text + len, sizeof(frame.text) - len, "%s[%d,%d]", i ? "," : "", i, i & 1);
+    }
+    len += snprintf(frame.text + len, sizeof(frame.text) - len, "],\"id\":4294967295,\"cid\":4294967295}");
+    frame.length = (size_t)len;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    unsigned long iterations = argc > 1 ? strtoul(argv[1], nullptr, 10) : 2000000;
+
+    Frame frames[6];
+    setFrame(frames[0], "set", "{\"pin\":2,\"val\":1}");
+    setFrame(frames[1], "set+id", "{\"pin\":2,\"val\":1,\"id\":123456,\"cid\":42}");
+    setFullBatch(frames[2]);
+    setFrame(frames[3], "getStates", "{\"action\":\"getStates\"}");
+    setFrame(frames[4], "subscribe",
+             "{\"action\":\"subscribe\",\"topics\":[\"inputs\",\"telemetry\"],\"pins\":[2,4,16],\"rate\":250}");
+    setFrame(frames[5], "bad_number", "{\"pin\":2,\"val\":7}");
+
+    printf("%-12s %8s %12s %10s\n", "frame", "bytes", "ns/frame", "MB/s");
+    for (const Frame& frame : frames) {
+        WsCommand cmd;
+        // Результат накапливается, чтобы компилятор не выбросил цикл
+        unsigned long check = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (unsigned long i = 0; i < iterations; i++) {
+            check += parseWsCommand((const uint8_t*)frame.text, frame.length, cmd, nullptr);
+            check += cmd.count;
+        }
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        double ns = std::chrono::duration<double, std::nano>(elapsed).count() / iterations;
+        double mbps = frame.length / ns * 1e3;
+        printf("%-12s %8zu %12.1f %10.1f  (%lu)\n", frame.name, frame.length, ns, mbps, check % 10);
+    }
+    return 0;
+}
@@ -0,0 +1,216 @@
+// Фаззинг разбора команд WebSocket (src/ws_command.cpp).
+//
+// С libFuzzer (clang):
+//   clang++ -std=gnu++17 -g -O1 -fsanitize=fuzzer,address,undefined -D WS_FUZZ_LIBFUZZER
+//       -I src host/fuzz/ws_command_fuzz.cpp src/ws_command.cpp -o ws_command_fuzz
+// Без libFuzzer (pio run -e fuzz_ws_command) собирается собственный драйвер:
+// мутации встроенного корпуса под ASan/UBSan, либо прогон файлов из аргументов.
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "ws_command.h"
+
+namespace {
+
+void fail(const char* what, const uint8_t* data, size_t size) {
+    fprintf(stderr, "invariant violated: %s\ninput (%zu bytes): ", what, size);
+    fwrite(data, 1, size, stderr);
+    fputc('\n', stderr);
+    abort();
+}
+
+// Кадр из разобранной команды установки - для проверки обратимости разбора
+size_t formatSet(const WsCommand& cmd, char* buf, size_t size) {
+    int len;
+    if (cmd.type == WS_CMD_SET) {
+        len = snprintf(buf, size, "{\"pin\":%u,\"val\":%u", cmd.items[0].pin, cmd.items[0].value);
+    } else {
+        len = snprintf(buf, size, "{\"batch\":[");
+        for (uint8_t i = 0; i < cmd.count; i++) {
+            len += snprintf(buf + len, size - len, "%s[%u,%u]", i ? "," : "",
+                            cmd.items[i].pin, cmd.items[i].value);
+        }
+        len += snprintf(buf + len, size - len, "]");
+    }
+    if (cmd.hasId) {
+        len += snprintf(buf + len, size - len, ",\"id\":%lu", (unsigned long)cmd.id);
+        if (cmd.clientId) len += snprintf(buf + len, size - len, ",\"cid\":%lu", (unsigned long)cmd.clientId);
+    }
+    len += snprintf(buf + len, size - len, "}");
+    return (size_t)len;
+}
+
+}  // namespace
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    WsCommand cmd;
+    size_t errorPos = (size_t)-1;
+    WsParseError err = parseWsCommand(data, size, cmd, &errorPos);
+
+    if (err != WS_PARSE_OK) {
+        if (cmd.type != WS_CMD_NONE || cmd.count != 0 || cmd.hasId) fail("error leaves a command", data, size);
+        if (errorPos > size) fail("error position past end", data, size);
+        if (strcmp(wsParseErrorName(err), "unknown") == 0) fail("unnamed error", data, size);
+        return 0;
+    }
+
+    if (cmd.type == WS_CMD_NONE) fail("ok without command", data, size);
+    if (cmd.count > WS_BATCH_MAX) fail("count over WS_BATCH_MAX", data, size);
+    if (cmd.clientId && !cmd.hasId) fail("cid without id", data, size);
+
+    if (cmd.type == WS_CMD_SET || cmd.type == WS_CMD_BATCH_SET) {
+        for (uint8_t i = 0; i < cmd.count; i++) {
+            if (cmd.items[i].value > 1) fail("level above 1", data, size);
+        }
+
+        // Повторный разбор канонической записи даёт ту же команду
+        char buf[WS_MAX_FRAME_SIZE];
+        size_t len = formatSet(cmd, buf, sizeof(buf));
+        if (len >= sizeof(buf)) return 0;
+        WsCommand again;
+        if (parseWsCommand((const uint8_t*)buf, len, again, nullptr) != WS_PARSE_OK) {
+            fail("canonical form does not parse", data, size);
+        }
+        if (again.type != cmd.type || again.count != cmd.count || again.hasId != cmd.hasId ||
+            again.id != cmd.id || again.clientId != cmd.clientId ||
+            memcmp(again.items, cmd.items, cmd.count * sizeof(WsPinValue)) != 0) {
+            fail("round trip mismatch", data, size);
+        }
+    }
+    return 0;
+}
+
+#ifndef WS_FUZZ_LIBFUZZER
+
+namespace {
+
+const char* const seeds[] = {
+    "{\"pin\":2,\"val\":1}",
+    "{\"pin\":2,\"val\":0,\"id\":4294967295,\"cid\":7}",
+    "{\"batch\":[[2,1],[4,0],[16,1]],\"id\":12}",
+    "{\"batch\":[]}",
+    "{\"action\":\"getStates\"}",
+    "{\"action\":\"getStates\",\"pin\":13}",
+    "{\"action\":\"ping\"}",
+    "{\"action\":\"subscribe\",\"topics\":[\"inputs\",\"telemetry\",\"analog\"],\"pins\":[2,4],\"rate\":1000}",
+    "{\"action\":\"unsubscribe\",\"topics\":[\"logs\"],\"pins\":[63]}",
+    " { \"val\" : 1 , \"pin\" : 255 } ",
+};
+
+// Токены для вставки: так мутации чаще проходят дальше первого символа
+const char* const tokens[] = {
+    "\"pin\":", "\"val\":", "\"batch\":", "\"action\":", "\"id\":", "\"cid\":",
+    "\"topics\":", "\"pins\":", "\"rate\":", "[", "]", "{", "}", ",", "\"",
+    "0", "1", "2", "255", "256", "65535", "4294967296", "1.5", "1e3", "-1",
+};
+
+uint32_t rngState = 0x12345678;
+
+uint32_t next() {
+    rngState ^= rngState << 13;
+    rngState ^= rngState >> 17;
+    rngState ^= rngState << 5;
+    return rngState;
+}
+
+size_t mutate(uint8_t* buf, size_t len, size_t capacity) {
+    uint32_t rounds = 1 + next() % 4;
+    for (uint32_t r = 0; r < rounds; r++) {
+        uint32_t pos = len ? next() % (len + 1) : 0;
+        switch (next() % 5) {
+            case 0:  // Замена байта
+                if (len) buf[next() % len] = (uint8_t)next();
+                break;
+            case 1:  // Удаление отрезка
+                if (pos < len) {
+                    size_t n = 1 + next() % (len - pos);
+                    memmove(buf + pos, buf + pos + n, len - pos - n);
+                    len -= n;
+                }
+                break;
+            case 2: {  // Вставка токена
+                const char* token = tokens[next() % (sizeof(tokens) / sizeof(tokens[0]))];
+                size_t n = strlen(token);
+                if (len + n > capacity) break;
+                memmove(buf + pos + n, buf + pos, len - pos);
+                memcpy(buf + pos, token, n);
+                len += n;
+                break;
+            }
+            case 3:  // Повтор отрезка - длинные пакеты и вложенность
+                if (pos < len) {
+                    size_t n = 1 + next() % (len - pos);
+                    if (len + n > capacity) break;
+                    memmove(buf + pos + n, buf + pos, len - pos);
+                    len += n;
+                }
+                break;
+            default:  // Обрезка
+                len = pos;
+                break;
+        }
+    }
+    return len;
+}
+
+int runFile(const char* path) {
+    FILE* f = fopen(path, "rb");
+    if (!f) {
+        perror(path);
+        return 1;
+    }
+    static uint8_t buf[1 << 16];
+    size_t len = fread(buf, 1, sizeof(buf), f);
+    fclose(f);
+    LLVMFuzzerTestOneInput(buf, len);
+    printf("%s: ok\n", path);
+    return 0;
+}
+
+}  // namespace
+
+// program [-runs=N] [-seed=S] [файлы...]
+int main(int argc, char** argv) {
+    unsigned long runs = 1000000;
+    int files = 0;
+    for (int i = 1; i < argc; i++) {
+        if (strncmp(argv[i], "-runs=", 6) == 0) {
+            runs = strtoul(argv[i] + 6, nullptr, 10);
+        } else if (strncmp(argv[i], "-seed=", 6) == 0) {
+            rngState = (uint32_t)strtoul(argv[i] + 6, nullptr, 10) | 1;
+        } else {
+            if (runFile(argv[i]) != 0) return 1;
+            files++;
+        }
+    }
+    if (files) return 0;
+
+    const size_t seedCount = sizeof(seeds) / sizeof(seeds[0]);
+    // Кадры длиннее WS_MAX_FRAME_SIZE тоже проверяются
+    static uint8_t buf[WS_MAX_FRAME_SIZE * 2];
+    unsigned long accepted = 0;
+    clock_t start = clock();
+
+    for (size_t i = 0; i < seedCount; i++) {
+        LLVMFuzzerTestOneInput((const uint8_t*)seeds[i], strlen(seeds[i]));
+    }
+    for (unsigned long run = 0; run < runs; run++) {
+        const char* seed = seeds[next() % seedCount];
+        size_t len = strlen(seed);
+        memcpy(buf, seed, len);
+        len = mutate(buf, len, sizeof(buf));
+
+        WsCommand cmd;
+        if (parseWsCommand(buf, len, cmd, nullptr) == WS_PARSE_OK) accepted++;
+        LLVMFuzzerTestOneInput(buf, len);
+    }
+
+    double seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+    printf("%lu runs, %lu accepted, %.1f s\n", runs, accepted, seconds);
+    return 0;
+}
+
+#endif
@@ -0,0 +1,122 @@
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+// Минимальная замена ядра Arduino-ESP32 для сборки прошивки под Linux
+// (env:native). Реализовано только то, что использует код в src/.
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <algorithm>
+#include <string>
+
+#define HIGH 1
+#define LOW 0
+#define INPUT 0x01
+#define OUTPUT 0x03
+#define INPUT_PULLUP 0x05
+
+using std::min;
+using std::max;
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void yield();
+
+void pinMode(uint8_t pin, uint8_t mode);
+int digitalRead(uint8_t pin);
+void digitalWrite(uint8_t pin, uint8_t value);
+
+// strlcpy есть в glibc начиная с 2.38
+#if !defined(__GLIBC__) || __GLIBC__ < 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ < 38)
+#define HOST_NEEDS_STRLCPY 1
+size_t strlcpy(char* dst, const char* src, size_t size);
+#endif
+
+class String {
+public:
+    String(const char* str = "") : value(str ? str : "") {}
+    String(const std::string& str) : value(str) {}
+    String(char c) : value(1, c) {}
+    String(int number) : value(std::to_string(number)) {}
+    String(unsigned int number) : value(std::to_string(number)) {}
+    String(long number) : value(std::to_string(number)) {}
+    String(unsigned long number) : value(std::to_string(number)) {}
+
+    const char* c_str() const { return value.c_str(); }
+    unsigned int length() const { return value.size(); }
+    bool reserve(unsigned int size) { value.reserve(size); return true; }
+    unsigned char concat(const char* str) { value += str; return 1; }
+    unsigned char concat(const char* str, unsigned int length) { value.append(str, length); return 1; }
+    unsigned char concat(char c) { value += c; return 1; }
+    bool endsWith(const String& suffix) const {
+        return value.size() >= suffix.value.size() &&
+               value.compare(value.size() - suffix.value.size(), suffix.value.size(), suffix.value) == 0;
+    }
+    bool startsWith(const String& prefix) const { return value.compare(0, prefix.value.size(), prefix.value) == 0; }
+    int indexOf(char c) const { size_t pos = value.find(c); return pos == std::string::npos ? -1 : (int)pos; }
+    String substring(unsigned int from) const { return value.substr(std::min<size_t>(from, value.size())); }
+    String substring(unsigned int from, unsigned int to) const {
+        from = std::min<size_t>(from, value.size());
+        return value.substr(from, to > from ? to - from : 0);
+    }
+    char operator[](unsigned int index) const { return index < value.size() ? value[index] : 0; }
+
+    String& operator+=(const String& other) { value += other.value; return *this; }
+    String& operator+=(const char* str) { value += str; return *this; }
+    String& operator+=(char c) { value += c; return *this; }
+    bool operator==(const String& other) const { return value == other.value; }
+    bool operator==(const char* str) const { return value == str; }
+    bool operator!=(const String& other) const { return value != other.value; }
+
+    friend String operator+(const String& a, const String& b) { return a.value + b.value; }
+    friend String operator+(const String& a, const char* b) { return a.value + b; }
+    friend String operator+(const char* a, const String& b) { return a + b.value; }
+
+private:
+    std::string value;
+};
+
+class IPAddress {
+public:
+    IPAddress() : bytes{0, 0, 0, 0} {}
+    IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d) : bytes{a, b, c, d} {}
+    explicit IPAddress(uint32_t address) { memcpy(bytes, &address, 4); }
+    uint8_t operator[](int index) const { return bytes[index]; }
+    operator uint32_t() const { uint32_t address; memcpy(&address, bytes, 4); return address; }
+    bool fromString(const char* str);
+    String toString() const;
+
+private:
+    uint8_t bytes[4];
+};
+
+class HardwareSerial {
+public:
+    void begin(unsigned long baud) {}
+    size_t print(const char* str);
+    size_t print(const String& str) { return print(str.c_str()); }
+    size_t println(const char* str = "");
+    size_t println(const String& str) { return println(str.c_str()); }
+    size_t println(const IPAddress& ip) { return println(ip.toString()); }
+    size_t printf(const char* format, ...) __attribute__((format(printf, 2, 3)));
+};
+
+extern HardwareSerial Serial;
+
+class EspClass {
+public:
+    uint32_t getFreeHeap();
+    uint32_t getMinFreeHeap();
+    uint64_t getEfuseMac();
+    [[noreturn]] void restart();
+};
+
+extern EspClass ESP;
+
+#endif
@@ -0,0 +1,36 @@
+#ifndef HOST_FS_H
+#define HOST_FS_H
+
+// Файлы LittleFS отображаются на каталог хоста (EMU_FS_ROOT, по умолчанию временная копия ./data)
+
+#include <Arduino.h>
+#include <memory>
+#include <string>
+
+struct FileImpl;
+
+class File {
+public:
+    File() {}
+    explicit File(std::shared_ptr<FileImpl> impl) : impl(impl) {}
+
+    operator bool() const;
+    size_t read(uint8_t* buf, size_t size);
+    int read();
+    size_t write(const uint8_t* buf, size_t size);
+    size_t write(uint8_t c) { return write(&c, 1); }
+    size_t size();
+    bool seek(size_t position);
+    size_t position();
+    int available();
+    void flush();
+    void close();
+    const char* name();
+    bool isDirectory();
+    File openNextFile();
+
+private:
+    std::shared_ptr<FileImpl> impl;
+};
+
+#endif
@@ -0,0 +1,26 @@
+#ifndef HOST_PREFERENCES_H
+#define HOST_PREFERENCES_H
+
+// NVS в памяти процесса. Содержимое сохраняется в файл EMU_NVS_FILE
+// (по умолчанию .emu_nvs), чтобы конфигурация переживала ESP.restart().
+
+#include <Arduino.h>
+#include <string>
+
+class Preferences {
+public:
+    bool begin(const char* name, bool readOnly = false);
+    void end() {}
+
+    String getString(const char* key, const String& defaultValue = String());
+    size_t putString(const char* key, const String& value);
+    uint8_t getUChar(const char* key, uint8_t defaultValue = 0);
+    size_t putUChar(const char* key, uint8_t value);
+    bool remove(const char* key);
+    bool clear();
+
+private:
+    std::string space;
+};
+
+#endif
@@ -0,0 +1,77 @@
+#ifndef HOST_PUBSUBCLIENT_H
+#define HOST_PUBSUBCLIENT_H
+
+// Клиент MQTT, подключённый к брокеру-заглушке emu::MqttBroker.
+// По умолчанию брокер недоступен: подключение завершается ошибкой, и события
+// копятся в очереди MQTTManager. Тесты включают брокер и читают из него
+// опубликованные сообщения.
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+#define MQTT_CONNECTION_LOST -3
+#define MQTT_CONNECT_FAILED -2
+#define MQTT_DISCONNECTED -1
+#define MQTT_CONNECTED 0
+
+namespace emu {
+
+struct MqttMessage {
+    std::string topic;
+    std::string payload;
+    bool retained;
+};
+
+class MqttBroker {
+public:
+    // Недоступный брокер разрывает текущее подключение
+    void setAvailable(bool available);
+    bool isAvailable();
+
+    // Записанный обмен с клиентом
+    std::vector<MqttMessage> published();
+    std::map<std::string, std::string> retained();   // Последнее retained-значение топика
+    std::vector<std::string> subscriptions();
+    uint32_t connectAttempts();
+    void clear();
+
+    // Сообщение от брокера; клиент получает его в следующем loop()
+    void deliver(const char* topic, const char* payload);
+};
+
+MqttBroker& mqttBroker();
+
+}
+
+class PubSubClient {
+public:
+    typedef std::function<void(char*, uint8_t*, unsigned int)> Callback;
+
+    explicit PubSubClient(Client& client) {}
+    PubSubClient& setServer(const char* host, uint16_t port) { return *this; }
+    PubSubClient& setCallback(Callback callback) {
+        this->callback = callback;
+        return *this;
+    }
+    PubSubClient& setSocketTimeout(uint16_t timeout) { return *this; }
+
+    bool connect(const char* id, const char* user, const char* password,
+                 const char* willTopic, uint8_t willQos, bool willRetain, const char* willMessage);
+    void disconnect();
+    bool publish(const char* topic, const char* payload, bool retained);
+    bool subscribe(const char* topic);
+    bool loop();
+    bool connected();
+    int state();
+
+private:
+    Callback callback;
+    bool session = false;
+    int lastState = MQTT_DISCONNECTED;
+};
+
+#endif
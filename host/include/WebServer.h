@@ -0,0 +1,60 @@
+#ifndef HOST_WEBSERVER_H
+#define HOST_WEBSERVER_H
+
+// HTTP/1.1 сервер с интерфейсом WebServer из Arduino-ESP32. Как и
+// оригинал, обслуживает один запрос за вызов handleClient(); соединение
+// закрывается после ответа.
+
+#include <Arduino.h>
+#include <FS.h>
+#include <functional>
+#include <string>
+#include <vector>
+
+enum HTTPMethod { HTTP_ANY, HTTP_GET, HTTP_POST, HTTP_PUT, HTTP_DELETE };
+
+class WebServer {
+public:
+    typedef std::function<void()> THandlerFunction;
+
+    explicit WebServer(int port) : devicePort(port) {}
+    void begin();
+    void handleClient();
+    void on(const char* uri, HTTPMethod method, THandlerFunction handler);
+    void onNotFound(THandlerFunction handler);
+
+    void send(int code, const char* contentType, const String& content);
+    void send(int code, const char* contentType, const char* content) { send(code, contentType, String(content)); }
+    void sendHeader(const char* name, const char* value);
+    size_t streamFile(File& file, const String& contentType);
+
+    bool hasArg(const char* name);
+    String arg(const char* name);
+    String uri() { return requestUri; }
+    HTTPMethod method() { return requestMethod; }
+
+private:
+    struct Route {
+        std::string uri;
+        HTTPMethod method;
+        THandlerFunction handler;
+    };
+
+    uint16_t devicePort;
+    int listenFd = -1;
+    std::vector<Route> routes;
+    THandlerFunction notFoundHandler;
+
+    int clientFd = -1;
+    bool responded = false;
+    HTTPMethod requestMethod = HTTP_GET;
+    String requestUri;
+    std::string requestQuery;
+    std::string requestBody;
+    std::string extraHeaders;
+
+    bool readRequest(int fd);
+    void sendRaw(int code, const char* contentType, const char* body, size_t length);
+};
+
+#endif
@@ -0,0 +1,79 @@
+#ifndef HOST_WEBSOCKETSSERVER_H
+#define HOST_WEBSOCKETSSERVER_H
+
+// Сервер WebSocket (RFC 6455) с интерфейсом библиотеки links2004/WebSockets:
+// текстовые кадры, ping/pong (события WStype_PING/WStype_PONG), закрытие. Фрагментированные кадры и
+// расширения не поддерживаются.
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include <functional>
+#include <string>
+
+#ifndef WEBSOCKETS_SERVER_CLIENT_MAX
+#define WEBSOCKETS_SERVER_CLIENT_MAX 5
+#endif
+
+typedef enum {
+    WStype_ERROR,
+    WStype_DISCONNECTED,
+    WStype_CONNECTED,
+    WStype_TEXT,
+    WStype_BIN,
+    WStype_FRAGMENT_TEXT_START,
+    WStype_FRAGMENT_BIN_START,
+    WStype_FRAGMENT,
+    WStype_FRAGMENT_FIN,
+    WStype_PING,
+    WStype_PONG,
+} WStype_t;
+
+namespace emu {
+
+// Перехват текстовых сообщений, отправленных клиентам (для модульных тестов):
+// вызывается из sendTXT до записи в сокет, в том числе для неподключённых
+// номеров. Пустая функция отключает перехват.
+typedef std::function<void(uint8_t num, const std::string& payload)> WebSocketTap;
+void setWebSocketTap(WebSocketTap tap);
+
+}
+
+class WebSocketsServer {
+public:
+    typedef std::function<void(uint8_t num, WStype_t type, uint8_t* payload, size_t length)> WebSocketServerEvent;
+
+    explicit WebSocketsServer(uint16_t port) : devicePort(port) {}
+    void begin();
+    void loop();
+    void onEvent(WebSocketServerEvent event) { callback = event; }
+
+    bool sendTXT(uint8_t num, const char* payload, size_t length = 0);
+    bool sendTXT(uint8_t num, const String& payload) { return sendTXT(num, payload.c_str(), payload.length()); }
+    bool broadcastTXT(const char* payload, size_t length = 0);
+    bool broadcastTXT(const String& payload) { return broadcastTXT(payload.c_str(), payload.length()); }
+    bool sendPing(uint8_t num, uint8_t* payload = nullptr, size_t length = 0);
+    void disconnect(uint8_t num);
+    IPAddress remoteIP(uint8_t num);
+    uint8_t connectedClients();
+
+private:
+    struct WSClient {
+        int fd = -1;
+        bool upgraded = false;
+        std::string in;
+    };
+
+    uint16_t devicePort;
+    int listenFd = -1;
+    WSClient clients[WEBSOCKETS_SERVER_CLIENT_MAX];
+    WebSocketServerEvent callback;
+
+    void acceptClients();
+    void readClient(uint8_t num);
+    bool handshake(uint8_t num);
+    bool parseFrames(uint8_t num);
+    bool sendFrame(uint8_t num, uint8_t opcode, const uint8_t* payload, size_t length);
+    void closeClient(uint8_t num);
+};
+
+#endif
@@ -0,0 +1,94 @@
+#ifndef HOST_WIFI_H
+#define HOST_WIFI_H
+
+// WiFi всегда подключён (адрес 127.0.0.1); WiFiServer и WiFiClient -
+// неблокирующие TCP-сокеты Linux.
+
+#include <Arduino.h>
+#include <memory>
+
+#define WL_CONNECTED 3
+#define WL_DISCONNECTED 6
+
+typedef enum {
+    WIFI_MODE_NULL = 0,
+    WIFI_MODE_STA,
+    WIFI_MODE_AP,
+    WIFI_MODE_APSTA
+} wifi_mode_t;
+
+#define WIFI_OFF WIFI_MODE_NULL
+#define WIFI_STA WIFI_MODE_STA
+#define WIFI_AP WIFI_MODE_AP
+#define WIFI_AP_STA WIFI_MODE_APSTA
+
+class Client {
+public:
+    virtual ~Client() {}
+    virtual int connect(const char* host, uint16_t port) = 0;
+    virtual size_t write(const uint8_t* buf, size_t size) = 0;
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int read(uint8_t* buf, size_t size) = 0;
+    virtual void stop() = 0;
+    virtual uint8_t connected() = 0;
+};
+
+class WiFiClient : public Client {
+public:
+    WiFiClient() {}
+    explicit WiFiClient(int fd);
+
+    int connect(const char* host, uint16_t port) override;
+    size_t write(const uint8_t* buf, size_t size) override;
+    size_t write(uint8_t c) { return write(&c, 1); }
+    int available() override;
+    int read() override;
+    int read(uint8_t* buf, size_t size) override;
+    void stop() override;
+    uint8_t connected() override;
+    void setNoDelay(bool noDelay);
+    IPAddress remoteIP();
+    operator bool() { return connected(); }
+
+private:
+    // Копии клиента разделяют сокет, как в Arduino-ESP32
+    std::shared_ptr<int> socket;
+    int fd() const { return socket ? *socket : -1; }
+};
+
+class WiFiServer {
+public:
+    explicit WiFiServer(uint16_t port) : devicePort(port) {}
+    void begin();
+    void setNoDelay(bool noDelay) { this->noDelay = noDelay; }
+    WiFiClient available();
+    WiFiClient accept() { return available(); }
+
+private:
+    uint16_t devicePort;
+    int listenFd = -1;
+    bool noDelay = false;
+};
+
+class WiFiClass {
+public:
+    int status() { return WL_CONNECTED; }
+    int RSSI() { return -50; }
+    IPAddress localIP() { return IPAddress(127, 0, 0, 1); }
+    IPAddress softAPIP() { return IPAddress(127, 0, 0, 1); }
+    wifi_mode_t getMode() { return currentMode; }
+    bool mode(wifi_mode_t mode) { currentMode = mode; return true; }
+    int begin(const char* ssid, const char* password) { return WL_CONNECTED; }
+    bool config(IPAddress ip, IPAddress gateway, IPAddress subnet, IPAddress dns) { return true; }
+    bool disconnect() { return true; }
+    bool softAP(const char* ssid, const char* password) { currentMode = WIFI_MODE_AP; return true; }
+    uint8_t softAPgetStationNum() { return 0; }
+
+private:
+    wifi_mode_t currentMode = WIFI_MODE_STA;
+};
+
+extern WiFiClass WiFi;
+
+#endif
@@ -0,0 +1,40 @@
+#ifndef HOST_WIFI_UDP_H
+#define HOST_WIFI_UDP_H
+
+// Отправка датаграмм через UDP-сокет Linux. Multicast уходит через
+// интерфейс из EMU_MULTICAST_IF (по умолчанию 127.0.0.1), так что
+// сборщик на той же машине видит все эмуляторы.
+
+#include <Arduino.h>
+#include <functional>
+#include <vector>
+
+namespace emu {
+
+// Перехват отправляемых датаграмм (для модульных тестов): вызывается из
+// endPacket до записи в сокет. Пустая функция отключает перехват.
+typedef std::function<void(IPAddress ip, uint16_t port, const std::vector<uint8_t>& packet)> UdpTap;
+void setUdpTap(UdpTap tap);
+
+}
+
+class WiFiUDP {
+public:
+    ~WiFiUDP() { stop(); }
+    uint8_t begin(uint16_t port);
+    int beginPacket(IPAddress ip, uint16_t port);
+    size_t write(const uint8_t* buf, size_t size);
+    size_t write(uint8_t c) { return write(&c, 1); }
+    int endPacket();
+    void stop();
+
+private:
+    int fd = -1;
+    IPAddress remoteIp;
+    uint16_t remotePort = 0;
+    std::vector<uint8_t> packet;
+
+    bool open();
+};
+
+#endif
@@ -0,0 +1,32 @@
+#ifndef HOST_WIRE_H
+#define HOST_WIRE_H
+
+// Шина I2C с моделью MCP23017 на уровне регистров (адрес EXPANDER_I2C_ADDRESS).
+// Входы расширителя задаются командой set для пинов EXPANDER_PIN_BASE..,
+// линия INT выведена на EXPANDER_INT_PIN.
+
+#include <Arduino.h>
+#include <vector>
+
+class TwoWire {
+public:
+    bool begin(int sda, int scl, uint32_t frequency);
+    bool end();
+    void beginTransmission(uint8_t address);
+    uint8_t endTransmission(bool sendStop = true);
+    uint8_t requestFrom(uint8_t address, uint8_t quantity);
+    size_t write(uint8_t data);
+    int available();
+    int read();
+
+private:
+    bool started = false;
+    uint8_t txAddress = 0;
+    std::vector<uint8_t> txBuffer;
+    std::vector<uint8_t> rxBuffer;
+    size_t rxPos = 0;
+};
+
+extern TwoWire Wire;
+
+#endif
@@ -0,0 +1,43 @@
+#ifndef HOST_EMULATOR_H
+#define HOST_EMULATOR_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Состояние эмулируемой платы, общее для замен библиотек и управляющего
+// канала. Внешние уровни задаются тестом (команда set), выходы читаются
+// командой get.
+namespace emu {
+
+// Порт с учётом смещения EMU_PORT_OFFSET: 80 -> 8080 при смещении 8000
+uint16_t port(uint16_t devicePort);
+
+// Уровень, который внешняя схема подаёт на пин (GPIO или пин расширителя)
+void setExternalLevel(uint8_t pin, uint8_t level);
+uint8_t getExternalLevel(uint8_t pin);
+// Уровень выхода, как его видит внешняя схема
+uint8_t getOutputLevel(uint8_t pin);
+
+void setAnalogMillivolts(uint8_t pin, uint16_t millivolts);
+uint16_t getAnalogMillivolts(uint8_t pin);
+
+// Расширитель на шине I2C (wire.cpp)
+bool expanderInterruptLine();
+uint8_t expanderOutputLevel(uint8_t bit);
+
+struct HeapStats {
+    size_t used;
+    size_t peak;
+    size_t rssKb;
+};
+HeapStats heapStats();
+
+extern volatile uint64_t loopCount;
+
+void startControlServer();
+void saveArgs(int argc, char** argv);
+[[noreturn]] void restart();
+
+}
+
+#endif
@@ -0,0 +1,8 @@
+#ifndef HOST_ESP_OTA_OPS_H
+#define HOST_ESP_OTA_OPS_H
+
+#include <stddef.h>
+
+int esp_ota_get_app_elf_sha256(char* dst, size_t size);
+
+#endif
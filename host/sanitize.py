@@ -0,0 +1,5 @@
+# build_flags попадают только в команды компиляции; санитайзерам нужен
+# тот же флаг при компоновке
+Import("env")
+
+env.Append(LINKFLAGS=["-fsanitize=address,undefined"])
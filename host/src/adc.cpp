@@ -0,0 +1,81 @@
+#include <driver/adc.h>
+#include <esp_adc_cal.h>
+#include <chrono>
+#include <thread>
+#include "emulator.h"
+
+// Выборки генерируются по кругу для каналов из шаблона, значение берётся
+// из напряжения, заданного командой analog. Чтение длится столько же,
+// сколько заняло бы заполнение кадра при sample_freq_hz.
+
+#define ADC_PATTERN_MAX 8
+
+static const uint8_t gpioForChannel[8] = {36, 37, 38, 39, 32, 33, 34, 35};
+
+static bool initialized = false;
+static bool started = false;
+static uint8_t patternChannels[ADC_PATTERN_MAX];
+static uint32_t patternLength = 0;
+static uint32_t patternPos = 0;
+static uint32_t sampleFrequency = 20000;
+static std::chrono::steady_clock::time_point nextFrame;
+
+esp_err_t adc_digi_initialize(const adc_digi_init_config_t* config) {
+    if (initialized) return ESP_ERR_INVALID_STATE;
+    initialized = true;
+    return ESP_OK;
+}
+
+esp_err_t adc_digi_deinitialize() {
+    initialized = false;
+    started = false;
+    return ESP_OK;
+}
+
+esp_err_t adc_digi_controller_configure(const adc_digi_configuration_t* config) {
+    if (!initialized || config->pattern_num == 0 || config->pattern_num > ADC_PATTERN_MAX) return ESP_FAIL;
+    for (uint32_t i = 0; i < config->pattern_num; i++) {
+        patternChannels[i] = config->adc_pattern[i].channel;
+    }
+    patternLength = config->pattern_num;
+    patternPos = 0;
+    if (config->sample_freq_hz) sampleFrequency = config->sample_freq_hz;
+    return ESP_OK;
+}
+
+esp_err_t adc_digi_start() {
+    if (!initialized || patternLength == 0) return ESP_ERR_INVALID_STATE;
+    started = true;
+    nextFrame = std::chrono::steady_clock::now();
+    return ESP_OK;
+}
+
+esp_err_t adc_digi_read_bytes(uint8_t* buf, uint32_t length, uint32_t* outLength, uint32_t timeoutMs) {
+    if (!started) return ESP_ERR_INVALID_STATE;
+
+    uint32_t count = length / ADC_RESULT_BYTE;
+    adc_digi_output_data_t* samples = reinterpret_cast<adc_digi_output_data_t*>(buf);
+    for (uint32_t i = 0; i < count; i++) {
+        uint8_t channel = patternChannels[patternPos];
+        patternPos = (patternPos + 1) % patternLength;
+        uint32_t raw = (uint32_t)emu::getAnalogMillivolts(gpioForChannel[channel]) * 4095 / 3300;
+        samples[i].val = 0;
+        samples[i].type1.data = raw > 4095 ? 4095 : raw;
+        samples[i].type1.channel = channel;
+    }
+
+    nextFrame += std::chrono::microseconds((uint64_t)count * 1000000 / sampleFrequency);
+    std::this_thread::sleep_until(nextFrame);
+    *outLength = count * ADC_RESULT_BYTE;
+    return ESP_OK;
+}
+
+int esp_adc_cal_characterize(adc_unit_t unit, adc_atten_t atten, adc_bits_width_t width,
+                             uint32_t defaultVref, esp_adc_cal_characteristics_t* chars) {
+    chars->vref = defaultVref;
+    return 0;
+}
+
+uint32_t esp_adc_cal_raw_to_voltage(uint32_t raw, const esp_adc_cal_characteristics_t* chars) {
+    return raw * 3300 / 4095;
+}
@@ -0,0 +1,250 @@
+#include <Arduino.h>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <stdarg.h>
+#include <thread>
+#include <malloc.h>
+#include <time.h>
+#include <unistd.h>
+#include "emulator.h"
+#include "config.h"
+
+HardwareSerial Serial;
+EspClass ESP;
+
+// Объём кучи ESP32 после загрузки, от которого считается free_heap
+#define EMU_HEAP_SIZE (320 * 1024)
+
+static const auto startTime = std::chrono::steady_clock::now();
+static std::mutex serialLock;
+
+static std::atomic<uint8_t> pinModes[NATIVE_PIN_COUNT];
+static std::atomic<uint8_t> outputLevels[NATIVE_PIN_COUNT];
+static std::atomic<uint8_t> externalLevels[PIN_COUNT];
+static std::atomic<uint16_t> analogLevels[NATIVE_PIN_COUNT];
+static size_t minFreeHeap = EMU_HEAP_SIZE;
+static std::atomic<size_t> peakHeapUsed{0};
+
+// Пик занятой кучи: замеряется при каждом запросе свободной памяти
+static size_t sampleHeapUsed() {
+    size_t used = mallinfo2().uordblks;
+    size_t peak = peakHeapUsed.load();
+    while (used > peak && !peakHeapUsed.compare_exchange_weak(peak, used)) {}
+    return used;
+}
+
+namespace emu {
+
+volatile uint64_t loopCount = 0;
+
+uint16_t port(uint16_t devicePort) {
+    const char* offset = getenv("EMU_PORT_OFFSET");
+    return devicePort + (offset ? atoi(offset) : 8000);
+}
+
+void setExternalLevel(uint8_t pin, uint8_t level) {
+    if (pin < PIN_COUNT) externalLevels[pin] = level ? HIGH : LOW;
+}
+
+uint8_t getExternalLevel(uint8_t pin) {
+    return pin < PIN_COUNT ? externalLevels[pin].load() : LOW;
+}
+
+uint8_t getOutputLevel(uint8_t pin) {
+    if (pin < NATIVE_PIN_COUNT) {
+        return pinModes[pin] == OUTPUT ? outputLevels[pin].load() : LOW;
+    }
+    if (pin >= EXPANDER_PIN_BASE && pin < EXPANDER_PIN_BASE + EXPANDER_PIN_COUNT) {
+        return expanderOutputLevel(pin - EXPANDER_PIN_BASE);
+    }
+    return LOW;
+}
+
+void setAnalogMillivolts(uint8_t pin, uint16_t millivolts) {
+    if (pin < NATIVE_PIN_COUNT) analogLevels[pin] = millivolts;
+}
+
+uint16_t getAnalogMillivolts(uint8_t pin) {
+    return pin < NATIVE_PIN_COUNT ? analogLevels[pin].load() : 0;
+}
+
+HeapStats heapStats() {
+    HeapStats stats = {};
+    stats.used = sampleHeapUsed();
+    stats.peak = peakHeapUsed.load();
+
+    FILE* status = fopen("/proc/self/status", "r");
+    if (status) {
+        char line[128];
+        while (fgets(line, sizeof(line), status)) {
+            if (sscanf(line, "VmRSS: %zu kB", &stats.rssKb) == 1) break;
+        }
+        fclose(status);
+    }
+    return stats;
+}
+
+}
+
+unsigned long millis() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - startTime).count();
+}
+
+unsigned long micros() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - startTime).count();
+}
+
+void delay(unsigned long ms) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+void yield() {
+    std::this_thread::yield();
+}
+
+void pinMode(uint8_t pin, uint8_t mode) {
+    if (pin >= NATIVE_PIN_COUNT) return;
+    pinModes[pin] = mode;
+}
+
+int digitalRead(uint8_t pin) {
+    if (pin >= NATIVE_PIN_COUNT) return LOW;
+    if (pinModes[pin] == OUTPUT) return outputLevels[pin];
+#if EXPANDER_ENABLED
+    if (pin == EXPANDER_INT_PIN) return emu::expanderInterruptLine() ? LOW : HIGH;
+#endif
+    return externalLevels[pin];
+}
+
+void digitalWrite(uint8_t pin, uint8_t value) {
+    if (pin >= NATIVE_PIN_COUNT) return;
+    outputLevels[pin] = value ? HIGH : LOW;
+}
+
+#ifdef HOST_NEEDS_STRLCPY
+size_t strlcpy(char* dst, const char* src, size_t size) {
+    size_t length = strlen(src);
+    if (size) {
+        size_t n = length < size - 1 ? length : size - 1;
+        memcpy(dst, src, n);
+        dst[n] = '\0';
+    }
+    return length;
+}
+#endif
+
+bool IPAddress::fromString(const char* str) {
+    unsigned a, b, c, d;
+    if (sscanf(str, "%u.%u.%u.%u", &a, &b, &c, &d) != 4 || a > 255 || b > 255 || c > 255 || d > 255) {
+        return false;
+    }
+    bytes[0] = a;
+    bytes[1] = b;
+    bytes[2] = c;
+    bytes[3] = d;
+    return true;
+}
+
+String IPAddress::toString() const {
+    char buf[16];
+    snprintf(buf, sizeof(buf), "%u.%u.%u.%u", bytes[0], bytes[1], bytes[2], bytes[3]);
+    return String(buf);
+}
+
+size_t HardwareSerial::print(const char* str) {
+    std::lock_guard<std::mutex> lock(serialLock);
+    size_t n = fputs(str, stdout);
+    fflush(stdout);
+    return n;
+}
+
+size_t HardwareSerial::println(const char* str) {
+    std::lock_guard<std::mutex> lock(serialLock);
+    size_t n = ::printf("%s\n", str);
+    fflush(stdout);
+    return n;
+}
+
+size_t HardwareSerial::printf(const char* format, ...) {
+    std::lock_guard<std::mutex> lock(serialLock);
+    va_list args;
+    va_start(args, format);
+    int n = vprintf(format, args);
+    va_end(args);
+    fflush(stdout);
+    return n < 0 ? 0 : n;
+}
+
+uint32_t EspClass::getFreeHeap() {
+    size_t used = sampleHeapUsed();
+    size_t free = used < EMU_HEAP_SIZE ? EMU_HEAP_SIZE - used : 0;
+    if (free < minFreeHeap) minFreeHeap = free;
+    return free;
+}
+
+uint32_t EspClass::getMinFreeHeap() {
+    getFreeHeap();
+    return minFreeHeap;
+}
+
+uint64_t EspClass::getEfuseMac() {
+    // EMU_MAC задаёт свой адрес каждому эмулятору (идентификатор в MQTT и UDP)
+    const char* env = getenv("EMU_MAC");
+    return env ? strtoull(env, nullptr, 16) : 0x0000AABBCCDDEEFFULL;
+}
+
+static char** savedArgv = nullptr;
+
+namespace emu {
+
+void saveArgs(int argc, char** argv) {
+    savedArgv = argv;
+}
+
+void restart() {
+    // ESP.restart(): процесс перезапускается с теми же аргументами,
+    // NVS и файлы LittleFS сохраняются на диске
+    Serial.printf("[emu] restart\n");
+    fflush(stdout);
+    execv("/proc/self/exe", savedArgv);
+    _exit(1);
+}
+
+}
+
+void EspClass::restart() {
+    emu::restart();
+}
+
+int esp_ota_get_app_elf_sha256(char* dst, size_t size) {
+    // Строки формата журнала действительны только для того же исполняемого
+    // файла, поэтому идентификатор сборки - FNV-1a хэш самого бинарника.
+    // Время компиляции не годится: оно совпадает у разных сборок за секунду
+    // и не меняется при пересборке одного объекта без main
+    // Журнал сравнивает первые 16 символов, как у настоящего SHA-256
+    static char buildId[17] = "";
+    if (buildId[0] == '\0') {
+        uint64_t hash = 0xcbf29ce484222325ULL;
+        FILE* exe = fopen("/proc/self/exe", "rb");
+        if (exe) {
+            uint8_t chunk[4096];
+            size_t n;
+            while ((n = fread(chunk, 1, sizeof(chunk), exe)) > 0) {
+                for (size_t i = 0; i < n; i++) {
+                    hash = (hash ^ chunk[i]) * 0x100000001b3ULL;
+                }
+            }
+            fclose(exe);
+        } else {
+            // Без /proc - идентификатор запуска: формат всё равно не переживёт
+            // перезапуск с другим бинарником
+            hash ^= (uint64_t)getpid() << 32 ^ (uint64_t)time(nullptr);
+        }
+        snprintf(buildId, sizeof(buildId), "%016llx", (unsigned long long)hash);
+    }
+    snprintf(dst, size, "%s", buildId);
+    return size;
+}
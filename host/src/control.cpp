@@ -0,0 +1,94 @@
+#include "emulator.h"
+#include <Arduino.h>
+#include <stdio.h>
+#include <string.h>
+#include <thread>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "net.h"
+#include "config.h"
+
+// Управляющий канал для нагрузочных тестов: построчный текстовый протокол
+// на порту 7000 (+ EMU_PORT_OFFSET).
+//
+//   set <pin> <0|1>       внешний уровень входа         -> ok
+//   analog <pin> <mv>     напряжение на аналоговом входе -> ok
+//   get <pin>             уровень выхода                 -> 0|1
+//   stats                 heap_used= heap_peak= rss_kb= loop_count= uptime_ms=
+//
+// На неверную команду отвечает error.
+
+#define CONTROL_PORT 7000
+#define CONTROL_LINE_SIZE 128
+
+static void reply(int fd, const char* text) {
+    char buf[CONTROL_LINE_SIZE + 2];
+    int len = snprintf(buf, sizeof(buf), "%s\n", text);
+    netSendAll(fd, buf, len);
+}
+
+static void handleCommand(int fd, char* line) {
+    char command[16];
+    unsigned pin = 0, value = 0;
+    char buf[CONTROL_LINE_SIZE];
+
+    int fields = sscanf(line, "%15s %u %u", command, &pin, &value);
+    if (fields < 1) return;
+
+    if (strcmp(command, "set") == 0 && fields == 3 && pin < PIN_COUNT && value <= 1) {
+        emu::setExternalLevel(pin, value);
+        reply(fd, "ok");
+    } else if (strcmp(command, "analog") == 0 && fields == 3 && pin < PIN_COUNT && value <= 3300) {
+        emu::setAnalogMillivolts(pin, value);
+        reply(fd, "ok");
+    } else if (strcmp(command, "get") == 0 && fields == 2 && pin < PIN_COUNT) {
+        reply(fd, emu::getOutputLevel(pin) ? "1" : "0");
+    } else if (strcmp(command, "stats") == 0) {
+        emu::HeapStats heap = emu::heapStats();
+        snprintf(buf, sizeof(buf), "heap_used=%zu heap_peak=%zu rss_kb=%zu loop_count=%llu uptime_ms=%lu",
+                 heap.used, heap.peak, heap.rssKb, (unsigned long long)emu::loopCount, millis());
+        reply(fd, buf);
+    } else {
+        reply(fd, "error");
+    }
+}
+
+static void serveConnection(int fd) {
+    char line[CONTROL_LINE_SIZE];
+    size_t length = 0;
+    char c;
+
+    // Сокет от netAccept неблокирующий, здесь нужен блокирующий
+    netSetBlocking(fd);
+    while (recv(fd, &c, 1, 0) == 1) {
+        if (c == '\n') {
+            line[length] = '\0';
+            if (length && line[length - 1] == '\r') line[length - 1] = '\0';
+            handleCommand(fd, line);
+            length = 0;
+        } else if (length < sizeof(line) - 1) {
+            line[length++] = c;
+        }
+    }
+    close(fd);
+}
+
+namespace emu {
+
+void startControlServer() {
+    int listenFd = netListen(CONTROL_PORT);
+    if (listenFd < 0) return;
+    netSetBlocking(listenFd);
+
+    std::thread([listenFd] {
+        while (true) {
+            int fd = accept(listenFd, nullptr, nullptr);
+            if (fd < 0) continue;
+            netSetNoDelay(fd, true);
+            std::thread(serveConnection, fd).detach();
+        }
+    }).detach();
+    Serial.printf("[emu] control port %u\n", port(CONTROL_PORT));
+}
+
+}
@@ -0,0 +1,106 @@
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+#include <Arduino.h>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+
+struct Queue {
+    std::mutex lock;
+    std::condition_variable notEmpty;
+    std::condition_variable notFull;
+    std::deque<std::string> items;
+    size_t length;
+    size_t itemSize;
+};
+
+static bool waitFor(std::condition_variable& cv, std::unique_lock<std::mutex>& lock,
+                    TickType_t ticks, std::function<bool()> ready) {
+    if (ticks == portMAX_DELAY) {
+        cv.wait(lock, ready);
+        return true;
+    }
+    return cv.wait_for(lock, std::chrono::milliseconds(ticks), ready);
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t task, const char* name, uint32_t stackDepth,
+                                   void* parameter, UBaseType_t priority, TaskHandle_t* handle,
+                                   BaseType_t core) {
+    std::thread(task, parameter).detach();
+    if (handle) *handle = nullptr;
+    return pdPASS;
+}
+
+void vTaskDelay(TickType_t ticks) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(ticks ? ticks : 1));
+}
+
+TickType_t xTaskGetTickCount() {
+    return millis();
+}
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t itemSize) {
+    Queue* queue = new Queue();
+    queue->length = length;
+    queue->itemSize = itemSize;
+    return queue;
+}
+
+BaseType_t xQueueSend(QueueHandle_t handle, const void* item, TickType_t ticksToWait) {
+    Queue* queue = static_cast<Queue*>(handle);
+    std::unique_lock<std::mutex> lock(queue->lock);
+    if (!waitFor(queue->notFull, lock, ticksToWait, [queue] { return queue->items.size() < queue->length; })) {
+        return pdFALSE;
+    }
+    queue->items.emplace_back(static_cast<const char*>(item), queue->itemSize);
+    queue->notEmpty.notify_one();
+    return pdTRUE;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t handle, void* item, TickType_t ticksToWait) {
+    Queue* queue = static_cast<Queue*>(handle);
+    std::unique_lock<std::mutex> lock(queue->lock);
+    if (!waitFor(queue->notEmpty, lock, ticksToWait, [queue] { return !queue->items.empty(); })) {
+        return pdFALSE;
+    }
+    memcpy(item, queue->items.front().data(), queue->itemSize);
+    queue->items.pop_front();
+    queue->notFull.notify_one();
+    return pdTRUE;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t handle) {
+    Queue* queue = static_cast<Queue*>(handle);
+    std::lock_guard<std::mutex> lock(queue->lock);
+    return queue->items.size();
+}
+
+UBaseType_t uxQueueSpacesAvailable(QueueHandle_t handle) {
+    Queue* queue = static_cast<Queue*>(handle);
+    std::lock_guard<std::mutex> lock(queue->lock);
+    return queue->length - queue->items.size();
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex() {
+    return new std::timed_mutex();
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t handle, TickType_t ticksToWait) {
+    std::timed_mutex* mutex = static_cast<std::timed_mutex*>(handle);
+    if (ticksToWait == portMAX_DELAY) {
+        mutex->lock();
+        return pdTRUE;
+    }
+    return mutex->try_lock_for(std::chrono::milliseconds(ticksToWait)) ? pdTRUE : pdFALSE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t handle) {
+    static_cast<std::timed_mutex*>(handle)->unlock();
+    return pdTRUE;
+}
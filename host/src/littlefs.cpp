@@ -0,0 +1,146 @@
+#include <LittleFS.h>
+#include <dirent.h>
+#include <filesystem>
+#include <sys/stat.h>
+#include <unistd.h>
+
+LittleFSFS LittleFS;
+
+struct FileImpl {
+    FILE* file = nullptr;
+    DIR* dir = nullptr;
+    std::string hostPath;
+    std::string name;
+
+    ~FileImpl() {
+        if (file) fclose(file);
+        if (dir) closedir(dir);
+    }
+};
+
+File::operator bool() const {
+    return impl && (impl->file || impl->dir);
+}
+
+size_t File::read(uint8_t* buf, size_t size) {
+    return impl && impl->file ? fread(buf, 1, size, impl->file) : 0;
+}
+
+int File::read() {
+    uint8_t c;
+    return read(&c, 1) == 1 ? c : -1;
+}
+
+size_t File::write(const uint8_t* buf, size_t size) {
+    return impl && impl->file ? fwrite(buf, 1, size, impl->file) : 0;
+}
+
+size_t File::size() {
+    struct stat st;
+    if (!impl || stat(impl->hostPath.c_str(), &st) != 0) return 0;
+    if (impl->file) fflush(impl->file);
+    stat(impl->hostPath.c_str(), &st);
+    return st.st_size;
+}
+
+bool File::seek(size_t position) {
+    return impl && impl->file && fseek(impl->file, position, SEEK_SET) == 0;
+}
+
+size_t File::position() {
+    return impl && impl->file ? ftell(impl->file) : 0;
+}
+
+int File::available() {
+    return impl && impl->file ? size() - position() : 0;
+}
+
+void File::flush() {
+    if (impl && impl->file) fflush(impl->file);
+}
+
+void File::close() {
+    impl.reset();
+}
+
+const char* File::name() {
+    return impl ? impl->name.c_str() : "";
+}
+
+bool File::isDirectory() {
+    return impl && impl->dir;
+}
+
+File File::openNextFile() {
+    if (!impl || !impl->dir) return File();
+
+    dirent* entry;
+    while ((entry = readdir(impl->dir)) != nullptr) {
+        if (entry->d_name[0] == '.') continue;
+        auto next = std::make_shared<FileImpl>();
+        next->hostPath = impl->hostPath + "/" + entry->d_name;
+        next->name = entry->d_name;
+        next->file = fopen(next->hostPath.c_str(), "rb");
+        if (next->file) return File(next);
+    }
+    return File();
+}
+
+bool LittleFSFS::begin(bool formatOnFail) {
+    const char* env = getenv("EMU_FS_ROOT");
+    if (env) {
+        root = env;
+    } else {
+        // Прошивка пишет в ФС (журнал, конфигурация), поэтому работаем с
+        // копией data/ во временном каталоге, а не с файлами репозитория.
+        // Путь сохраняется в окружении, чтобы ESP.restart() видел те же файлы
+        char tmpl[] = "/tmp/emu-fs-XXXXXX";
+        if (!mkdtemp(tmpl)) return false;
+        std::error_code ec;
+        std::filesystem::copy("data", tmpl, std::filesystem::copy_options::recursive, ec);
+        if (ec) {
+            fprintf(stderr, "[emu] cannot copy data/ to %s: %s\n", tmpl, ec.message().c_str());
+        }
+        root = tmpl;
+        setenv("EMU_FS_ROOT", tmpl, 1);
+        fprintf(stderr, "[emu] filesystem in %s\n", tmpl);
+    }
+    struct stat st;
+    return stat(root.c_str(), &st) == 0 && S_ISDIR(st.st_mode);
+}
+
+std::string LittleFSFS::hostPath(const char* path) {
+    // Выход за пределы корня не допускается
+    if (strstr(path, "..")) return std::string();
+    return root + (path[0] == '/' ? "" : "/") + path;
+}
+
+File LittleFSFS::open(const char* path, const char* mode) {
+    std::string host = hostPath(path);
+    if (host.empty()) return File();
+
+    auto impl = std::make_shared<FileImpl>();
+    impl->hostPath = host;
+    const char* slash = strrchr(path, '/');
+    impl->name = slash ? slash + 1 : path;
+
+    struct stat st;
+    if (stat(host.c_str(), &st) == 0 && S_ISDIR(st.st_mode)) {
+        impl->dir = opendir(host.c_str());
+    } else {
+        std::string fileMode = std::string(mode) + "b";
+        impl->file = fopen(host.c_str(), fileMode.c_str());
+    }
+    return (impl->file || impl->dir) ? File(impl) : File();
+}
+
+bool LittleFSFS::exists(const char* path) {
+    std::string host = hostPath(path);
+    struct stat st;
+    return !host.empty() && stat(host.c_str(), &st) == 0;
+}
+
+bool LittleFSFS::remove(const char* path) {
+    std::string host = hostPath(path);
+    return !host.empty() && unlink(host.c_str()) == 0;
+}
@@ -0,0 +1,37 @@
+#include <Arduino.h>
+#include <chrono>
+#include <thread>
+#include "emulator.h"
+#include "config.h"
+
+// Точка входа эмулятора: тот же setup()/loop(), что и на плате.
+// Пауза между итерациями (EMU_LOOP_SLEEP_US) заменяет время, которое
+// на ESP32 уходит на задачи Wi-Fi и прерывания; 0 - цикл без пауз.
+
+#define EMU_DEFAULT_LOOP_SLEEP_US 100
+
+void setup();
+void loop();
+
+int main(int argc, char** argv) {
+    emu::saveArgs(argc, argv);
+
+    // Входы с подтяжкой к питанию в покое читаются как HIGH
+    for (uint8_t pin = 0; pin < PIN_COUNT; pin++) {
+        emu::setExternalLevel(pin, HIGH);
+    }
+
+    const char* sleepEnv = getenv("EMU_LOOP_SLEEP_US");
+    long loopSleep = sleepEnv ? atol(sleepEnv) : EMU_DEFAULT_LOOP_SLEEP_US;
+
+    emu::startControlServer();
+    setup();
+
+    while (true) {
+        loop();
+        emu::loopCount++;
+        if (loopSleep > 0) {
+            std::this_thread::sleep_for(std::chrono::microseconds(loopSleep));
+        }
+    }
+}
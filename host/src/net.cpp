@@ -0,0 +1,173 @@
+#include "net.h"
+#include <WiFi.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "emulator.h"
+
+#define NET_SEND_TIMEOUT 5000   // мс
+
+WiFiClass WiFi;
+
+int netListen(uint16_t devicePort) {
+    int fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) return -1;
+
+    int one = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons(emu::port(devicePort));
+    if (bind(fd, (sockaddr*)&addr, sizeof(addr)) < 0 || listen(fd, 16) < 0) {
+        Serial.printf("[emu] cannot listen on port %u: %s\n", emu::port(devicePort), strerror(errno));
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+int netAccept(int listenFd) {
+    if (listenFd < 0) return -1;
+    return accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+}
+
+bool netSendAll(int fd, const void* data, size_t length) {
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+    while (length > 0) {
+        ssize_t sent = send(fd, p, length, MSG_NOSIGNAL);
+        if (sent > 0) {
+            p += sent;
+            length -= sent;
+            continue;
+        }
+        if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            pollfd pfd = {fd, POLLOUT, 0};
+            if (poll(&pfd, 1, NET_SEND_TIMEOUT) > 0) continue;
+        } else if (sent < 0 && errno == EINTR) {
+            continue;
+        }
+        return false;
+    }
+    return true;
+}
+
+void netSetNoDelay(int fd, bool noDelay) {
+    int value = noDelay ? 1 : 0;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &value, sizeof(value));
+}
+
+void netSetBlocking(int fd) {
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) & ~O_NONBLOCK);
+}
+
+// ==================== WiFiClient ====================
+
+static void closeSocket(int* fd) {
+    if (*fd >= 0) close(*fd);
+    delete fd;
+}
+
+WiFiClient::WiFiClient(int fd) : socket(new int(fd), closeSocket) {
+}
+
+int WiFiClient::connect(const char* host, uint16_t port) {
+    stop();
+
+    addrinfo hints = {};
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* result;
+    char service[8];
+    snprintf(service, sizeof(service), "%u", port);
+    if (getaddrinfo(host, service, &hints, &result) != 0) return 0;
+
+    int fd = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    bool ok = fd >= 0 && ::connect(fd, result->ai_addr, result->ai_addrlen) == 0;
+    freeaddrinfo(result);
+    if (!ok) {
+        if (fd >= 0) close(fd);
+        return 0;
+    }
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    socket.reset(new int(fd), closeSocket);
+    return 1;
+}
+
+size_t WiFiClient::write(const uint8_t* buf, size_t size) {
+    if (fd() < 0) return 0;
+    if (!netSendAll(fd(), buf, size)) {
+        stop();
+        return 0;
+    }
+    return size;
+}
+
+int WiFiClient::available() {
+    if (fd() < 0) return 0;
+    int count = 0;
+    if (ioctl(fd(), FIONREAD, &count) < 0) return 0;
+    return count;
+}
+
+int WiFiClient::read() {
+    uint8_t c;
+    return read(&c, 1) == 1 ? c : -1;
+}
+
+int WiFiClient::read(uint8_t* buf, size_t size) {
+    if (fd() < 0) return -1;
+    ssize_t received = recv(fd(), buf, size, 0);
+    if (received == 0) {
+        stop();
+        return -1;
+    }
+    return received < 0 ? -1 : received;
+}
+
+void WiFiClient::stop() {
+    socket.reset();
+}
+
+uint8_t WiFiClient::connected() {
+    if (fd() < 0) return 0;
+    // Закрытие соединения видно как готовность к чтению с нулём байт
+    uint8_t c;
+    ssize_t peeked = recv(fd(), &c, 1, MSG_PEEK | MSG_DONTWAIT);
+    if (peeked == 0 || (peeked < 0 && errno != EAGAIN && errno != EWOULDBLOCK)) {
+        stop();
+        return 0;
+    }
+    return 1;
+}
+
+void WiFiClient::setNoDelay(bool noDelay) {
+    if (fd() >= 0) netSetNoDelay(fd(), noDelay);
+}
+
+IPAddress WiFiClient::remoteIP() {
+    sockaddr_in addr = {};
+    socklen_t length = sizeof(addr);
+    if (fd() < 0 || getpeername(fd(), (sockaddr*)&addr, &length) < 0) return IPAddress();
+    return IPAddress(addr.sin_addr.s_addr);
+}
+
+// ==================== WiFiServer ====================
+
+void WiFiServer::begin() {
+    listenFd = netListen(devicePort);
+}
+
+WiFiClient WiFiServer::available() {
+    int fd = netAccept(listenFd);
+    if (fd < 0) return WiFiClient();
+    if (noDelay) netSetNoDelay(fd, true);
+    return WiFiClient(fd);
+}
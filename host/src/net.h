@@ -0,0 +1,18 @@
+#ifndef HOST_NET_H
+#define HOST_NET_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Неблокирующий слушающий сокет на порту устройства (со смещением emu::port)
+int netListen(uint16_t devicePort);
+// Принять соединение; -1, если ожидающих нет
+int netAccept(int listenFd);
+// Отправить всё; false при ошибке. Сокет временно переводится в блокирующий
+// режим с таймаутом, как запись в TCP-буфер lwIP
+bool netSendAll(int fd, const void* data, size_t length);
+void netSetNoDelay(int fd, bool noDelay);
+// Для потоков управляющего канала, которым не нужен опрос
+void netSetBlocking(int fd);
+
+#endif
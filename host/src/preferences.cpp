@@ -0,0 +1,97 @@
+#include <Preferences.h>
+#include <map>
+#include <mutex>
+
+// Ключи всех пространств: "<пространство>/<ключ>" -> значение
+static std::map<std::string, std::string> store;
+static std::mutex storeLock;
+static bool loaded = false;
+
+static const char* storeFile() {
+    const char* env = getenv("EMU_NVS_FILE");
+    return env ? env : ".emu_nvs";
+}
+
+// Формат файла: строки "ключ<TAB>hex-значение"
+static void loadStore() {
+    loaded = true;
+    FILE* file = fopen(storeFile(), "r");
+    if (!file) return;
+
+    char line[8192];
+    while (fgets(line, sizeof(line), file)) {
+        char* tab = strchr(line, '\t');
+        if (!tab) continue;
+        *tab = '\0';
+        std::string value;
+        for (char* p = tab + 1; p[0] && p[1] && p[0] != '\n'; p += 2) {
+            char hex[3] = {p[0], p[1], 0};
+            value += (char)strtol(hex, nullptr, 16);
+        }
+        store[line] = value;
+    }
+    fclose(file);
+}
+
+static void saveStore() {
+    std::string tmp = std::string(storeFile()) + ".tmp";
+    FILE* file = fopen(tmp.c_str(), "w");
+    if (!file) return;
+    for (const auto& entry : store) {
+        fprintf(file, "%s\t", entry.first.c_str());
+        for (unsigned char c : entry.second) fprintf(file, "%02x", c);
+        fputc('\n', file);
+    }
+    fclose(file);
+    rename(tmp.c_str(), storeFile());
+}
+
+bool Preferences::begin(const char* name, bool readOnly) {
+    std::lock_guard<std::mutex> lock(storeLock);
+    if (!loaded) loadStore();
+    space = name;
+    return true;
+}
+
+String Preferences::getString(const char* key, const String& defaultValue) {
+    std::lock_guard<std::mutex> lock(storeLock);
+    auto it = store.find(space + "/" + key);
+    return it == store.end() ? defaultValue : String(it->second);
+}
+
+size_t Preferences::putString(const char* key, const String& value) {
+    std::lock_guard<std::mutex> lock(storeLock);
+    store[space + "/" + key] = value.c_str();
+    saveStore();
+    return value.length() ? value.length() : 1;
+}
+
+uint8_t Preferences::getUChar(const char* key, uint8_t defaultValue) {
+    std::lock_guard<std::mutex> lock(storeLock);
+    auto it = store.find(space + "/" + key);
+    return it == store.end() || it->second.empty() ? defaultValue : (uint8_t)it->second[0];
+}
+
+size_t Preferences::putUChar(const char* key, uint8_t value) {
+    std::lock_guard<std::mutex> lock(storeLock);
+    store[space + "/" + key] = std::string(1, (char)value);
+    saveStore();
+    return 1;
+}
+
+bool Preferences::remove(const char* key) {
+    std::lock_guard<std::mutex> lock(storeLock);
+    bool removed = store.erase(space + "/" + key) > 0;
+    saveStore();
+    return removed;
+}
+
+bool Preferences::clear() {
+    std::lock_guard<std::mutex> lock(storeLock);
+    std::string prefix = space + "/";
+    for (auto it = store.begin(); it != store.end();) {
+        it = it->first.compare(0, prefix.size(), prefix) == 0 ? store.erase(it) : std::next(it);
+    }
+    saveStore();
+    return true;
+}
@@ -0,0 +1,150 @@
+#include <PubSubClient.h>
+#include <deque>
+#include <mutex>
+
+// Брокер-заглушка на одного клиента. Клиент работает в задаче MQTT,
+// тест обращается к брокеру из своего потока, поэтому всё под мьютексом.
+
+namespace {
+
+struct BrokerState {
+    std::mutex lock;
+    bool available = false;
+    bool clientConnected = false;
+    uint32_t connectAttempts = 0;
+    std::vector<emu::MqttMessage> published;
+    std::map<std::string, std::string> retained;
+    std::vector<std::string> subscriptions;
+    std::deque<emu::MqttMessage> inbox;
+    emu::MqttMessage will;
+};
+
+BrokerState broker;
+
+}
+
+namespace emu {
+
+MqttBroker& mqttBroker() {
+    static MqttBroker instance;
+    return instance;
+}
+
+void MqttBroker::setAvailable(bool available) {
+    std::lock_guard<std::mutex> guard(broker.lock);
+    broker.available = available;
+    if (!available && broker.clientConnected) {
+        // Обрыв связи: брокер публикует завещание клиента
+        broker.clientConnected = false;
+        broker.published.push_back(broker.will);
+        if (broker.will.retained) broker.retained[broker.will.topic] = broker.will.payload;
+    }
+}
+
+bool MqttBroker::isAvailable() {
+    std::lock_guard<std::mutex> guard(broker.lock);
+    return broker.available;
+}
+
+std::vector<MqttMessage> MqttBroker::published() {
+    std::lock_guard<std::mutex> guard(broker.lock);
+    return broker.published;
+}
+
+std::map<std::string, std::string> MqttBroker::retained() {
+    std::lock_guard<std::mutex> guard(broker.lock);
+    return broker.retained;
+}
+
+std::vector<std::string> MqttBroker::subscriptions() {
+    std::lock_guard<std::mutex> guard(broker.lock);
+    return broker.subscriptions;
+}
+
+uint32_t MqttBroker::connectAttempts() {
+    std::lock_guard<std::mutex> guard(broker.lock);
+    return broker.connectAttempts;
+}
+
+void MqttBroker::clear() {
+    std::lock_guard<std::mutex> guard(broker.lock);
+    broker.connectAttempts = 0;
+    broker.published.clear();
+    broker.retained.clear();
+    broker.inbox.clear();
+}
+
+void MqttBroker::deliver(const char* topic, const char* payload) {
+    std::lock_guard<std::mutex> guard(broker.lock);
+    broker.inbox.push_back({topic, payload, false});
+}
+
+}
+
+bool PubSubClient::connect(const char* id, const char* user, const char* password,
+                           const char* willTopic, uint8_t willQos, bool willRetain, const char* willMessage) {
+    std::lock_guard<std::mutex> guard(broker.lock);
+    broker.connectAttempts++;
+    if (!broker.available) {
+        session = false;
+        lastState = MQTT_CONNECT_FAILED;
+        return false;
+    }
+    broker.clientConnected = true;
+    broker.subscriptions.clear();
+    broker.will = {willTopic ? willTopic : "", willMessage ? willMessage : "", willRetain};
+    session = true;
+    lastState = MQTT_CONNECTED;
+    return true;
+}
+
+void PubSubClient::disconnect() {
+    std::lock_guard<std::mutex> guard(broker.lock);
+    if (session) broker.clientConnected = false;
+    session = false;
+    lastState = MQTT_DISCONNECTED;
+}
+
+bool PubSubClient::publish(const char* topic, const char* payload, bool retained) {
+    std::lock_guard<std::mutex> guard(broker.lock);
+    if (!session || !broker.clientConnected) return false;
+    broker.published.push_back({topic, payload, retained});
+    if (retained) broker.retained[topic] = payload;
+    return true;
+}
+
+bool PubSubClient::subscribe(const char* topic) {
+    std::lock_guard<std::mutex> guard(broker.lock);
+    if (!session || !broker.clientConnected) return false;
+    broker.subscriptions.push_back(topic);
+    return true;
+}
+
+bool PubSubClient::loop() {
+    std::deque<emu::MqttMessage> incoming;
+    {
+        std::lock_guard<std::mutex> guard(broker.lock);
+        if (!session || !broker.clientConnected) return false;
+        incoming.swap(broker.inbox);
+    }
+    // Обработчик вызывается без блокировки: он может публиковать
+    for (auto& message : incoming) {
+        if (!callback) continue;
+        std::string payload = message.payload;
+        callback(&message.topic[0], (uint8_t*)&payload[0], payload.size());
+    }
+    return true;
+}
+
+bool PubSubClient::connected() {
+    std::lock_guard<std::mutex> guard(broker.lock);
+    if (session && !broker.clientConnected) {
+        session = false;
+        lastState = MQTT_CONNECTION_LOST;
+    }
+    return session;
+}
+
+int PubSubClient::state() {
+    return lastState;
+}
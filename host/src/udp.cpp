@@ -0,0 +1,76 @@
+#include <WiFiUdp.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#define UDP_MAX_PACKET 1460
+
+bool WiFiUDP::open() {
+    if (fd >= 0) return true;
+
+    fd = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) return false;
+
+    const char* env = getenv("EMU_MULTICAST_IF");
+    in_addr iface = {};
+    if (!env || inet_pton(AF_INET, env, &iface) != 1) {
+        iface.s_addr = htonl(INADDR_LOOPBACK);
+    }
+    setsockopt(fd, IPPROTO_IP, IP_MULTICAST_IF, &iface, sizeof(iface));
+
+    unsigned char loop = 1;
+    unsigned char ttl = 1;
+    setsockopt(fd, IPPROTO_IP, IP_MULTICAST_LOOP, &loop, sizeof(loop));
+    setsockopt(fd, IPPROTO_IP, IP_MULTICAST_TTL, &ttl, sizeof(ttl));
+    return true;
+}
+
+uint8_t WiFiUDP::begin(uint16_t port) {
+    // Приём не эмулируется: сокет нужен только для отправки
+    return open() ? 1 : 0;
+}
+
+int WiFiUDP::beginPacket(IPAddress ip, uint16_t port) {
+    if (!open()) return 0;
+    remoteIp = ip;
+    remotePort = port;
+    packet.clear();
+    return 1;
+}
+
+size_t WiFiUDP::write(const uint8_t* buf, size_t size) {
+    if (packet.size() + size > UDP_MAX_PACKET) {
+        size = UDP_MAX_PACKET - packet.size();
+    }
+    packet.insert(packet.end(), buf, buf + size);
+    return size;
+}
+
+static emu::UdpTap udpTap;
+
+void emu::setUdpTap(UdpTap tap) {
+    udpTap = tap;
+}
+
+int WiFiUDP::endPacket() {
+    if (fd < 0 || remotePort == 0) return 0;
+    if (udpTap) udpTap(remoteIp, remotePort, packet);
+
+    // Порт назначения без смещения EMU_PORT_OFFSET: группа общая для всех эмуляторов
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = (uint32_t)remoteIp;
+    addr.sin_port = htons(remotePort);
+
+    ssize_t sent = sendto(fd, packet.data(), packet.size(), 0, (sockaddr*)&addr, sizeof(addr));
+    packet.clear();
+    return sent < 0 ? 0 : 1;
+}
+
+void WiFiUDP::stop() {
+    if (fd >= 0) {
+        close(fd);
+        fd = -1;
+    }
+}
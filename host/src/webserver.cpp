@@ -0,0 +1,190 @@
+#include <WebServer.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "net.h"
+
+#define HTTP_REQUEST_TIMEOUT 2000    // мс на получение запроса
+#define HTTP_MAX_REQUEST 65536
+
+static const char* statusText(int code) {
+    switch (code) {
+        case 200: return "OK";
+        case 400: return "Bad Request";
+        case 404: return "Not Found";
+        case 500: return "Internal Server Error";
+    }
+    return "";
+}
+
+static std::string urlDecode(const std::string& str) {
+    std::string out;
+    for (size_t i = 0; i < str.size(); i++) {
+        if (str[i] == '+') {
+            out += ' ';
+        } else if (str[i] == '%' && i + 2 < str.size()) {
+            out += (char)strtol(str.substr(i + 1, 2).c_str(), nullptr, 16);
+            i += 2;
+        } else {
+            out += str[i];
+        }
+    }
+    return out;
+}
+
+void WebServer::begin() {
+    listenFd = netListen(devicePort);
+}
+
+void WebServer::on(const char* uri, HTTPMethod method, THandlerFunction handler) {
+    routes.push_back({uri, method, handler});
+}
+
+void WebServer::onNotFound(THandlerFunction handler) {
+    notFoundHandler = handler;
+}
+
+void WebServer::handleClient() {
+    int fd = netAccept(listenFd);
+    if (fd < 0) return;
+
+    if (readRequest(fd)) {
+        clientFd = fd;
+        responded = false;
+        extraHeaders.clear();
+
+        std::string path = requestUri.c_str();
+        THandlerFunction handler = notFoundHandler;
+        for (const auto& route : routes) {
+            if (route.uri == path && (route.method == HTTP_ANY || route.method == requestMethod)) {
+                handler = route.handler;
+                break;
+            }
+        }
+
+        if (handler) {
+            handler();
+        }
+        if (!responded) {
+            send(404, "text/plain", "Not found");
+        }
+        clientFd = -1;
+    }
+    close(fd);
+}
+
+bool WebServer::readRequest(int fd) {
+    std::string data;
+    size_t headerEnd = std::string::npos;
+    size_t contentLength = 0;
+    unsigned long start = millis();
+    char buf[4096];
+
+    while (millis() - start < HTTP_REQUEST_TIMEOUT && data.size() < HTTP_MAX_REQUEST) {
+        if (headerEnd != std::string::npos && data.size() >= headerEnd + 4 + contentLength) break;
+
+        pollfd pfd = {fd, POLLIN, 0};
+        if (poll(&pfd, 1, 50) <= 0) continue;
+        ssize_t received = recv(fd, buf, sizeof(buf), 0);
+        if (received <= 0) return false;
+        data.append(buf, received);
+
+        if (headerEnd == std::string::npos) {
+            headerEnd = data.find("\r\n\r\n");
+            if (headerEnd != std::string::npos) {
+                std::string headers = data.substr(0, headerEnd);
+                for (auto& c : headers) c = tolower(c);
+                size_t pos = headers.find("content-length:");
+                if (pos != std::string::npos) {
+                    contentLength = strtoul(headers.c_str() + pos + 15, nullptr, 10);
+                }
+            }
+        }
+    }
+    if (headerEnd == std::string::npos) return false;
+
+    // Строка запроса: METHOD /path?query HTTP/1.1
+    size_t lineEnd = data.find("\r\n");
+    std::string line = data.substr(0, lineEnd);
+    size_t methodEnd = line.find(' ');
+    size_t uriEnd = line.find(' ', methodEnd + 1);
+    if (methodEnd == std::string::npos || uriEnd == std::string::npos) return false;
+
+    std::string method = line.substr(0, methodEnd);
+    if (method == "GET") requestMethod = HTTP_GET;
+    else if (method == "POST") requestMethod = HTTP_POST;
+    else if (method == "PUT") requestMethod = HTTP_PUT;
+    else if (method == "DELETE") requestMethod = HTTP_DELETE;
+    else return false;
+
+    std::string target = line.substr(methodEnd + 1, uriEnd - methodEnd - 1);
+    size_t query = target.find('?');
+    requestUri = String(target.substr(0, query));
+    requestQuery = query == std::string::npos ? "" : target.substr(query + 1);
+    requestBody = data.substr(headerEnd + 4, contentLength);
+    return true;
+}
+
+bool WebServer::hasArg(const char* name) {
+    if (strcmp(name, "plain") == 0) return !requestBody.empty();
+
+    std::string key = std::string(name) + "=";
+    size_t pos = 0;
+    while (pos < requestQuery.size()) {
+        if (requestQuery.compare(pos, key.size(), key) == 0) return true;
+        size_t next = requestQuery.find('&', pos);
+        if (next == std::string::npos) break;
+        pos = next + 1;
+    }
+    return false;
+}
+
+String WebServer::arg(const char* name) {
+    if (strcmp(name, "plain") == 0) return String(requestBody);
+
+    std::string key = std::string(name) + "=";
+    size_t pos = 0;
+    while (pos < requestQuery.size()) {
+        size_t next = requestQuery.find('&', pos);
+        std::string pair = requestQuery.substr(pos, next == std::string::npos ? std::string::npos : next - pos);
+        if (pair.compare(0, key.size(), key) == 0) return String(urlDecode(pair.substr(key.size())));
+        if (next == std::string::npos) break;
+        pos = next + 1;
+    }
+    return String();
+}
+
+void WebServer::sendHeader(const char* name, const char* value) {
+    extraHeaders += std::string(name) + ": " + value + "\r\n";
+}
+
+void WebServer::send(int code, const char* contentType, const String& content) {
+    sendRaw(code, contentType, content.c_str(), content.length());
+}
+
+size_t WebServer::streamFile(File& file, const String& contentType) {
+    std::string body;
+    uint8_t buf[4096];
+    size_t n;
+    while (file && (n = file.read(buf, sizeof(buf))) > 0) {
+        body.append((const char*)buf, n);
+    }
+    sendRaw(200, contentType.c_str(), body.data(), body.size());
+    return body.size();
+}
+
+void WebServer::sendRaw(int code, const char* contentType, const char* body, size_t length) {
+    if (clientFd < 0 || responded) return;
+    responded = true;
+
+    char header[256];
+    int headerLength = snprintf(header, sizeof(header),
+        "HTTP/1.1 %d %s\r\nContent-Type: %s\r\nContent-Length: %zu\r\nConnection: close\r\n",
+        code, statusText(code), contentType, length);
+
+    std::string response(header, headerLength);
+    response += extraHeaders;
+    response += "\r\n";
+    response.append(body, length);
+    netSendAll(clientFd, response.data(), response.size());
+}
@@ -0,0 +1,298 @@
+#include <WebSocketsServer.h>
+#include <errno.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "net.h"
+
+#define WS_MAX_MESSAGE 65536
+#define WS_GUID "258EAFA5-E914-47DA-95CA-C5AB0DC85B11"
+
+#define WS_OP_TEXT   0x1
+#define WS_OP_BINARY 0x2
+#define WS_OP_CLOSE  0x8
+#define WS_OP_PING   0x9
+#define WS_OP_PONG   0xA
+
+// SHA-1 нужен только для Sec-WebSocket-Accept
+static void sha1(const uint8_t* data, size_t length, uint8_t out[20]) {
+    uint32_t h[5] = {0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0};
+    std::string message((const char*)data, length);
+    uint64_t bitLength = (uint64_t)length * 8;
+    message += (char)0x80;
+    while (message.size() % 64 != 56) message += (char)0;
+    for (int i = 7; i >= 0; i--) message += (char)(bitLength >> (i * 8));
+
+    auto rotl = [](uint32_t x, int n) { return (x << n) | (x >> (32 - n)); };
+    for (size_t chunk = 0; chunk < message.size(); chunk += 64) {
+        uint32_t w[80];
+        for (int i = 0; i < 16; i++) {
+            const uint8_t* p = (const uint8_t*)message.data() + chunk + i * 4;
+            w[i] = ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+        }
+        for (int i = 16; i < 80; i++) w[i] = rotl(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+
+        uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4];
+        for (int i = 0; i < 80; i++) {
+            uint32_t f, k;
+            if (i < 20)      { f = (b & c) | (~b & d);          k = 0x5A827999; }
+            else if (i < 40) { f = b ^ c ^ d;                   k = 0x6ED9EBA1; }
+            else if (i < 60) { f = (b & c) | (b & d) | (c & d); k = 0x8F1BBCDC; }
+            else             { f = b ^ c ^ d;                   k = 0xCA62C1D6; }
+            uint32_t temp = rotl(a, 5) + f + e + k + w[i];
+            e = d; d = c; c = rotl(b, 30); b = a; a = temp;
+        }
+        h[0] += a; h[1] += b; h[2] += c; h[3] += d; h[4] += e;
+    }
+    for (int i = 0; i < 5; i++) {
+        out[i * 4] = h[i] >> 24;
+        out[i * 4 + 1] = h[i] >> 16;
+        out[i * 4 + 2] = h[i] >> 8;
+        out[i * 4 + 3] = h[i];
+    }
+}
+
+static std::string base64(const uint8_t* data, size_t length) {
+    static const char table[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    std::string out;
+    for (size_t i = 0; i < length; i += 3) {
+        uint32_t n = data[i] << 16;
+        if (i + 1 < length) n |= data[i + 1] << 8;
+        if (i + 2 < length) n |= data[i + 2];
+        out += table[(n >> 18) & 63];
+        out += table[(n >> 12) & 63];
+        out += i + 1 < length ? table[(n >> 6) & 63] : '=';
+        out += i + 2 < length ? table[n & 63] : '=';
+    }
+    return out;
+}
+
+void WebSocketsServer::begin() {
+    listenFd = netListen(devicePort);
+}
+
+void WebSocketsServer::loop() {
+    acceptClients();
+    for (uint8_t num = 0; num < WEBSOCKETS_SERVER_CLIENT_MAX; num++) {
+        if (clients[num].fd >= 0) readClient(num);
+    }
+}
+
+void WebSocketsServer::acceptClients() {
+    int fd;
+    while ((fd = netAccept(listenFd)) >= 0) {
+        uint8_t num = 0;
+        while (num < WEBSOCKETS_SERVER_CLIENT_MAX && clients[num].fd >= 0) num++;
+        if (num == WEBSOCKETS_SERVER_CLIENT_MAX) {
+            // Свободных слотов нет - как и библиотека, закрываем соединение
+            close(fd);
+            continue;
+        }
+        netSetNoDelay(fd, true);
+        clients[num].fd = fd;
+        clients[num].upgraded = false;
+        clients[num].in.clear();
+    }
+}
+
+void WebSocketsServer::readClient(uint8_t num) {
+    WSClient& client = clients[num];
+    char buf[4096];
+
+    while (true) {
+        ssize_t received = recv(client.fd, buf, sizeof(buf), 0);
+        if (received > 0) {
+            client.in.append(buf, received);
+            if (client.in.size() > WS_MAX_MESSAGE + 16) {
+                closeClient(num);
+                return;
+            }
+            continue;
+        }
+        if (received == 0 || (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) {
+            closeClient(num);
+            return;
+        }
+        break;
+    }
+
+    if (!client.upgraded && !handshake(num)) return;
+    if (client.upgraded) parseFrames(num);
+}
+
+bool WebSocketsServer::handshake(uint8_t num) {
+    WSClient& client = clients[num];
+    size_t headerEnd = client.in.find("\r\n\r\n");
+    if (headerEnd == std::string::npos) return false;
+
+    std::string headers = client.in.substr(0, headerEnd + 2);
+    std::string lower = headers;
+    for (auto& c : lower) c = tolower(c);
+
+    size_t keyPos = lower.find("sec-websocket-key:");
+    if (keyPos == std::string::npos) {
+        closeClient(num);
+        return false;
+    }
+    size_t keyStart = headers.find_first_not_of(' ', keyPos + 18);
+    size_t keyEnd = headers.find("\r\n", keyStart);
+    std::string key = headers.substr(keyStart, keyEnd - keyStart) + WS_GUID;
+
+    uint8_t digest[20];
+    sha1((const uint8_t*)key.data(), key.size(), digest);
+    std::string response =
+        "HTTP/1.1 101 Switching Protocols\r\n"
+        "Upgrade: websocket\r\n"
+        "Connection: Upgrade\r\n"
+        "Sec-WebSocket-Accept: " + base64(digest, sizeof(digest)) + "\r\n\r\n";
+    if (!netSendAll(client.fd, response.data(), response.size())) {
+        closeClient(num);
+        return false;
+    }
+
+    size_t pathStart = headers.find(' ') + 1;
+    std::string path = headers.substr(pathStart, headers.find(' ', pathStart) - pathStart);
+    client.in.erase(0, headerEnd + 4);
+    client.upgraded = true;
+
+    if (callback) callback(num, WStype_CONNECTED, (uint8_t*)path.c_str(), path.size());
+    return clients[num].fd >= 0;
+}
+
+bool WebSocketsServer::parseFrames(uint8_t num) {
+    while (clients[num].fd >= 0) {
+        std::string& in = clients[num].in;
+        if (in.size() < 2) return true;
+
+        const uint8_t* p = (const uint8_t*)in.data();
+        uint8_t opcode = p[0] & 0x0F;
+        bool masked = p[1] & 0x80;
+        uint64_t length = p[1] & 0x7F;
+        size_t offset = 2;
+
+        if (length == 126) {
+            if (in.size() < 4) return true;
+            length = (p[2] << 8) | p[3];
+            offset = 4;
+        } else if (length == 127) {
+            if (in.size() < 10) return true;
+            length = 0;
+            for (int i = 0; i < 8; i++) length = (length << 8) | p[2 + i];
+            offset = 10;
+        }
+        if (length > WS_MAX_MESSAGE || !masked) {
+            closeClient(num);
+            return false;
+        }
+        if (in.size() < offset + 4 + length) return true;
+
+        const uint8_t* mask = p + offset;
+        std::string payload(in, offset + 4, length);
+        for (size_t i = 0; i < payload.size(); i++) payload[i] ^= mask[i % 4];
+        in.erase(0, offset + 4 + length);
+
+        switch (opcode) {
+            case WS_OP_TEXT:
+                if (callback) callback(num, WStype_TEXT, (uint8_t*)&payload[0], payload.size());
+                break;
+            case WS_OP_BINARY:
+                if (callback) callback(num, WStype_BIN, (uint8_t*)&payload[0], payload.size());
+                break;
+            case WS_OP_PING:
+                sendFrame(num, WS_OP_PONG, (const uint8_t*)payload.data(), payload.size());
+                if (callback) callback(num, WStype_PING, (uint8_t*)&payload[0], payload.size());
+                break;
+            case WS_OP_PONG:
+                if (callback) callback(num, WStype_PONG, (uint8_t*)&payload[0], payload.size());
+                break;
+            case WS_OP_CLOSE:
+                sendFrame(num, WS_OP_CLOSE, (const uint8_t*)payload.data(), std::min<size_t>(payload.size(), 2));
+                closeClient(num);
+                return false;
+        }
+    }
+    return false;
+}
+
+bool WebSocketsServer::sendFrame(uint8_t num, uint8_t opcode, const uint8_t* payload, size_t length) {
+    if (num >= WEBSOCKETS_SERVER_CLIENT_MAX || clients[num].fd < 0 || !clients[num].upgraded) return false;
+
+    std::string frame;
+    frame += (char)(0x80 | opcode);
+    if (length < 126) {
+        frame += (char)length;
+    } else if (length < 65536) {
+        frame += (char)126;
+        frame += (char)(length >> 8);
+        frame += (char)(length & 0xFF);
+    } else {
+        frame += (char)127;
+        for (int i = 7; i >= 0; i--) frame += (char)((uint64_t)length >> (i * 8));
+    }
+    frame.append((const char*)payload, length);
+
+    if (!netSendAll(clients[num].fd, frame.data(), frame.size())) {
+        closeClient(num);
+        return false;
+    }
+    return true;
+}
+
+static emu::WebSocketTap webSocketTap;
+
+void emu::setWebSocketTap(WebSocketTap tap) {
+    webSocketTap = tap;
+}
+
+bool WebSocketsServer::sendTXT(uint8_t num, const char* payload, size_t length) {
+    if (length == 0) length = strlen(payload);
+    if (webSocketTap) webSocketTap(num, std::string(payload, length));
+    return sendFrame(num, WS_OP_TEXT, (const uint8_t*)payload, length);
+}
+
+bool WebSocketsServer::sendPing(uint8_t num, uint8_t* payload, size_t length) {
+    return sendFrame(num, WS_OP_PING, payload, length);
+}
+
+bool WebSocketsServer::broadcastTXT(const char* payload, size_t length) {
+    if (length == 0) length = strlen(payload);
+    bool ok = true;
+    for (uint8_t num = 0; num < WEBSOCKETS_SERVER_CLIENT_MAX; num++) {
+        if (clients[num].fd >= 0 && clients[num].upgraded) {
+            ok = sendFrame(num, WS_OP_TEXT, (const uint8_t*)payload, length) && ok;
+        }
+    }
+    return ok;
+}
+
+void WebSocketsServer::disconnect(uint8_t num) {
+    if (num < WEBSOCKETS_SERVER_CLIENT_MAX && clients[num].fd >= 0) closeClient(num);
+}
+
+IPAddress WebSocketsServer::remoteIP(uint8_t num) {
+    sockaddr_in addr = {};
+    socklen_t length = sizeof(addr);
+    if (num >= WEBSOCKETS_SERVER_CLIENT_MAX || clients[num].fd < 0 ||
+        getpeername(clients[num].fd, (sockaddr*)&addr, &length) < 0) {
+        return IPAddress();
+    }
+    return IPAddress(addr.sin_addr.s_addr);
+}
+
+uint8_t WebSocketsServer::connectedClients() {
+    uint8_t count = 0;
+    for (const auto& client : clients) {
+        if (client.fd >= 0 && client.upgraded) count++;
+    }
+    return count;
+}
+
+void WebSocketsServer::closeClient(uint8_t num) {
+    WSClient& client = clients[num];
+    bool wasUpgraded = client.upgraded;
+    close(client.fd);
+    client.fd = -1;
+    client.upgraded = false;
+    client.in.clear();
+    if (wasUpgraded && callback) callback(num, WStype_DISCONNECTED, nullptr, 0);
+}
@@ -0,0 +1,132 @@
+#include <Wire.h>
+#include <atomic>
+#include <mutex>
+#include "emulator.h"
+#include "config.h"
+
+TwoWire Wire;
+
+// Модель MCP23017 (IOCON.BANK = 0, последовательная адресация).
+// Прерывание: INTCON = 0, т.е. по изменению относительно значения,
+// прочитанного последним; сбрасывается чтением GPIO или INTCAP.
+#define MCP_IODIRA   0x00
+#define MCP_GPINTENA 0x04
+#define MCP_IOCON_A  0x0A
+#define MCP_IOCON_B  0x0B
+#define MCP_GPIOA    0x12
+#define MCP_GPIOB    0x13
+#define MCP_INTCAPA  0x10
+#define MCP_OLATA    0x14
+#define MCP_REGISTERS 0x16
+
+static std::mutex expanderLock;
+static uint8_t registers[MCP_REGISTERS] = {0xFF, 0xFF};   // IODIR после сброса - все входы
+static uint16_t capturedInputs = 0;
+static uint8_t pointer = 0;
+
+static uint16_t reg16(uint8_t reg) {
+    return registers[reg] | (registers[reg + 1] << 8);
+}
+
+static uint16_t externalInputs() {
+    uint16_t value = 0;
+    for (uint8_t bit = 0; bit < EXPANDER_PIN_COUNT; bit++) {
+        if (emu::getExternalLevel(EXPANDER_PIN_BASE + bit)) value |= 1 << bit;
+    }
+    return value;
+}
+
+// Значение порта: входы - внешний уровень, выходы - защёлка
+static uint16_t portValue() {
+    uint16_t direction = reg16(MCP_IODIRA);
+    return (externalInputs() & direction) | (reg16(MCP_OLATA) & ~direction);
+}
+
+static void writeRegister(uint8_t reg, uint8_t value) {
+    if (reg == MCP_IOCON_A || reg == MCP_IOCON_B) {
+        registers[MCP_IOCON_A] = registers[MCP_IOCON_B] = value;
+    } else if (reg == MCP_GPIOA || reg == MCP_GPIOB) {
+        registers[reg + 2] = value;     // Запись в GPIO меняет OLAT
+    } else if (reg < MCP_REGISTERS) {
+        registers[reg] = value;
+    }
+}
+
+static uint8_t readRegister(uint8_t reg) {
+    if (reg == MCP_GPIOA || reg == MCP_GPIOB || reg == MCP_INTCAPA || reg == MCP_INTCAPA + 1) {
+        uint16_t value = portValue();
+        capturedInputs = value;
+        return reg & 1 ? value >> 8 : value & 0xFF;
+    }
+    return reg < MCP_REGISTERS ? registers[reg] : 0;
+}
+
+namespace emu {
+
+bool expanderInterruptLine() {
+    std::lock_guard<std::mutex> lock(expanderLock);
+    uint16_t enabled = reg16(MCP_GPINTENA) & reg16(MCP_IODIRA);
+    return ((portValue() ^ capturedInputs) & enabled) != 0;
+}
+
+uint8_t expanderOutputLevel(uint8_t bit) {
+    std::lock_guard<std::mutex> lock(expanderLock);
+    return (portValue() >> bit) & 1;
+}
+
+}
+
+bool TwoWire::begin(int sda, int scl, uint32_t frequency) {
+    started = true;
+    return true;
+}
+
+bool TwoWire::end() {
+    started = false;
+    return true;
+}
+
+void TwoWire::beginTransmission(uint8_t address) {
+    txAddress = address;
+    txBuffer.clear();
+}
+
+size_t TwoWire::write(uint8_t data) {
+    txBuffer.push_back(data);
+    return 1;
+}
+
+uint8_t TwoWire::endTransmission(bool sendStop) {
+    // 2 - NACK по адресу, как у драйвера ESP32
+    if (!started || txAddress != EXPANDER_I2C_ADDRESS || getenv("EMU_NO_EXPANDER")) return 2;
+    if (txBuffer.empty()) return 0;
+
+    std::lock_guard<std::mutex> lock(expanderLock);
+    pointer = txBuffer[0];
+    for (size_t i = 1; i < txBuffer.size(); i++) {
+        writeRegister(pointer, txBuffer[i]);
+        pointer = (pointer + 1) % MCP_REGISTERS;
+    }
+    return 0;
+}
+
+uint8_t TwoWire::requestFrom(uint8_t address, uint8_t quantity) {
+    rxBuffer.clear();
+    rxPos = 0;
+    if (!started || address != EXPANDER_I2C_ADDRESS || getenv("EMU_NO_EXPANDER")) return 0;
+
+    std::lock_guard<std::mutex> lock(expanderLock);
+    for (uint8_t i = 0; i < quantity; i++) {
+        rxBuffer.push_back(readRegister(pointer));
+        pointer = (pointer + 1) % MCP_REGISTERS;
+    }
+    return quantity;
+}
+
+int TwoWire::available() {
+    return rxBuffer.size() - rxPos;
+}
+
+int TwoWire::read() {
+    return rxPos < rxBuffer.size() ? rxBuffer[rxPos++] : -1;
+}
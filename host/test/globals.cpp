@@ -0,0 +1,15 @@
+#include <Preferences.h>
+#include <WebSocketsServer.h>
+#include "analog_sampler.h"
+#include "gpio_manager.h"
+#include "logger.h"
+#include "subscription_manager.h"
+
+// Глобальные объекты для модульных тестов (env:native_test). В прошивке
+// они определены в main.cpp, который в тесты не входит.
+GPIOManager gpioManager;
+AnalogSampler analogSampler;
+Logger logger;
+Preferences preferences;
+WebSocketsServer webSocket(WEB_SOCKET_PORT);
+LoopStats loopStats;
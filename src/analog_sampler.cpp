@@ -0,0 +1,239 @@
+#include "analog_sampler.h"
+#include <driver/adc.h>
+#include <esp_adc_cal.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/task.h>
+#include "logger.h"
+
+#define ANALOG_DEFAULT_VREF 1100    // мВ, если в eFuse нет калибровки
+
+static QueueHandle_t eventQueue = nullptr;
+static esp_adc_cal_characteristics_t adcCharacteristics;
+
+int8_t AnalogSampler::adcChannelForPin(uint8_t pin) {
+    switch (pin) {
+        case 36: return ADC1_CHANNEL_0;
+        case 37: return ADC1_CHANNEL_1;
+        case 38: return ADC1_CHANNEL_2;
+        case 39: return ADC1_CHANNEL_3;
+        case 32: return ADC1_CHANNEL_4;
+        case 33: return ADC1_CHANNEL_5;
+        case 34: return ADC1_CHANNEL_6;
+        case 35: return ADC1_CHANNEL_7;
+    }
+    return -1;
+}
+
+bool AnalogSampler::begin(const std::vector<PinConfig>& configs) {
+    // Непрерывный режим настраивается один раз при загрузке
+    if (running) return false;
+
+    uint16_t channelMask = configureChannels(configs);
+    if (channelCount == 0) return false;
+
+    esp_adc_cal_characterize(ADC_UNIT_1, ADC_ATTEN_DB_11, ADC_WIDTH_BIT_12,
+                             ANALOG_DEFAULT_VREF, &adcCharacteristics);
+
+    adc_digi_init_config_t initConfig = {};
+    initConfig.max_store_buf_size = ANALOG_DMA_FRAME * 4;
+    initConfig.conv_num_each_intr = ANALOG_DMA_FRAME;
+    initConfig.adc1_chan_mask = channelMask;
+    initConfig.adc2_chan_mask = 0;
+    if (adc_digi_initialize(&initConfig) != ESP_OK) {
+        LOG_ERROR("ADC DMA init failed");
+        return false;
+    }
+
+    adc_digi_pattern_config_t pattern[ANALOG_PINS_COUNT] = {};
+    for (uint8_t i = 0; i < channelCount; i++) {
+        pattern[i].atten = ADC_ATTEN_DB_11;
+        pattern[i].channel = channels[i].adcChannel;
+        pattern[i].unit = 0;
+        pattern[i].bit_width = SOC_ADC_DIGI_MAX_BITWIDTH;
+    }
+
+    adc_digi_configuration_t digitalConfig = {};
+    digitalConfig.conv_limit_en = true;
+    digitalConfig.conv_limit_num = 250;
+    digitalConfig.pattern_num = channelCount;
+    digitalConfig.adc_pattern = pattern;
+    digitalConfig.sample_freq_hz = ANALOG_SAMPLE_RATE;
+    digitalConfig.conv_mode = ADC_CONV_SINGLE_UNIT_1;
+    digitalConfig.format = ADC_DIGI_OUTPUT_FORMAT_TYPE1;
+    if (adc_digi_controller_configure(&digitalConfig) != ESP_OK || adc_digi_start() != ESP_OK) {
+        LOG_ERROR("ADC DMA configure failed");
+        adc_digi_deinitialize();
+        return false;
+    }
+
+    xTaskCreatePinnedToCore(taskEntry, "analog", ANALOG_TASK_STACK, this,
+                            ANALOG_TASK_PRIORITY, nullptr, ANALOG_TASK_CORE);
+    running = true;
+
+    LOG_INFO("ADC DMA started: %u channels, %u Hz", channelCount, ANALOG_SAMPLE_RATE);
+    return true;
+}
+
+uint16_t AnalogSampler::configureChannels(const std::vector<PinConfig>& configs) {
+    memset(slotByAdcChannel, -1, sizeof(slotByAdcChannel));
+    channelCount = 0;
+    uint16_t channelMask = 0;
+
+    for (const auto& config : configs) {
+        if (!config.enabled || strcmp(config.type, "analog") != 0) continue;
+        int8_t adcChannel = adcChannelForPin(config.pin);
+        if (adcChannel < 0 || slotByAdcChannel[adcChannel] >= 0) continue;
+        if (channelCount >= ANALOG_PINS_COUNT) break;
+
+        Channel& channel = channels[channelCount];
+        channel.pin = config.pin;
+        channel.adcChannel = adcChannel;
+        channel.ema = strcmp(config.mode, "avg") != 0;
+        // Диапазоны проверяет GPIOManager::validateConfig; ограничение здесь -
+        // только защита от старой конфигурации в NVS
+        channel.decimation = constrain(config.decimation, 1, ANALOG_MAX_DECIMATION);
+        channel.window = constrain(config.window, 1, ANALOG_MAX_WINDOW);
+        channel.thresholdHigh = config.threshold_high;
+        channel.thresholdLow = min(config.threshold_low, config.threshold_high);
+        channel.accumulator = 0;
+        channel.accumulated = 0;
+        channel.primed = false;
+        channel.emaValue = 0;
+        channel.historySum = 0;
+        channel.historyPos = 0;
+        channel.historyFill = 0;
+        channel.millivolts.store(0, std::memory_order_relaxed);
+        channel.state.store(0, std::memory_order_relaxed);
+
+        slotByAdcChannel[adcChannel] = channelCount;
+        channelMask |= 1 << adcChannel;
+        channelCount++;
+    }
+
+    if (!eventQueue) eventQueue = xQueueCreate(ANALOG_EVENT_QUEUE_SIZE, sizeof(AnalogEvent));
+    return channelMask;
+}
+
+bool AnalogSampler::readEvent(AnalogEvent& event) {
+    return eventQueue && xQueueReceive(eventQueue, &event, 0) == pdTRUE;
+}
+
+bool AnalogSampler::isAnalog(uint8_t pin) {
+    return findSlot(pin) >= 0;
+}
+
+uint16_t AnalogSampler::getMillivolts(uint8_t pin) {
+    int8_t slot = findSlot(pin);
+    return slot >= 0 ? channels[slot].millivolts.load(std::memory_order_relaxed) : 0;
+}
+
+uint8_t AnalogSampler::getState(uint8_t pin) {
+    int8_t slot = findSlot(pin);
+    return slot >= 0 ? channels[slot].state.load(std::memory_order_relaxed) : 0;
+}
+
+uint8_t AnalogSampler::getChannelCount() {
+    return running ? channelCount : 0;
+}
+
+uint8_t AnalogSampler::getChannelPin(uint8_t index) {
+    return channels[index].pin;
+}
+
+AnalogStats AnalogSampler::getStats() {
+    AnalogStats stats;
+    stats.samples = samples.load(std::memory_order_relaxed);
+    stats.overruns = overruns.load(std::memory_order_relaxed);
+    stats.eventsDropped = eventsDropped.load(std::memory_order_relaxed);
+    return stats;
+}
+
+int8_t AnalogSampler::findSlot(uint8_t pin) {
+    if (!running) return -1;
+    for (uint8_t i = 0; i < channelCount; i++) {
+        if (channels[i].pin == pin) return i;
+    }
+    return -1;
+}
+
+void AnalogSampler::taskEntry(void* arg) {
+    AnalogSampler* self = static_cast<AnalogSampler*>(arg);
+    static uint8_t frame[ANALOG_DMA_FRAME];
+
+    while (true) {
+        uint32_t length = 0;
+        esp_err_t result = adc_digi_read_bytes(frame, sizeof(frame), &length, ADC_MAX_DELAY);
+        if (result == ESP_ERR_INVALID_STATE) {
+            // Задача не успела забрать данные, часть выборок потеряна
+            self->overruns.fetch_add(1, std::memory_order_relaxed);
+        } else if (result != ESP_OK) {
+            continue;
+        }
+        self->processFrame(frame, length);
+    }
+}
+
+void AnalogSampler::processFrame(const uint8_t* data, uint32_t length) {
+    for (uint32_t i = 0; i + ADC_RESULT_BYTE <= length; i += ADC_RESULT_BYTE) {
+        const adc_digi_output_data_t* sample = reinterpret_cast<const adc_digi_output_data_t*>(data + i);
+        uint8_t adcChannel = sample->type1.channel;
+        if (adcChannel >= 8 || slotByAdcChannel[adcChannel] < 0) continue;
+
+        // Децимация: среднее из decimation выборок
+        Channel& channel = channels[slotByAdcChannel[adcChannel]];
+        channel.accumulator += sample->type1.data;
+        if (++channel.accumulated < channel.decimation) continue;
+
+        uint16_t raw = channel.accumulator / channel.accumulated;
+        channel.accumulator = 0;
+        channel.accumulated = 0;
+        processValue(channel, raw);
+    }
+    samples.fetch_add(length / ADC_RESULT_BYTE, std::memory_order_relaxed);
+}
+
+void AnalogSampler::processValue(Channel& channel, uint16_t raw) {
+    uint16_t filtered;
+    if (channel.ema) {
+        // alpha = 1/window
+        if (!channel.primed) {
+            channel.emaValue = (int32_t)raw << 8;
+        } else {
+            channel.emaValue += (((int32_t)raw << 8) - channel.emaValue) / channel.window;
+        }
+        filtered = (channel.emaValue + 128) >> 8;
+    } else {
+        if (channel.historyFill == channel.window) {
+            channel.historySum -= channel.history[channel.historyPos];
+        } else {
+            channel.historyFill++;
+        }
+        channel.history[channel.historyPos] = raw;
+        channel.historySum += raw;
+        channel.historyPos = (channel.historyPos + 1) % channel.window;
+        filtered = channel.historySum / channel.historyFill;
+    }
+    channel.primed = true;
+
+    uint16_t mv = esp_adc_cal_raw_to_voltage(filtered, &adcCharacteristics);
+    channel.millivolts.store(mv, std::memory_order_relaxed);
+
+    if (channel.thresholdHigh == 0) return;
+
+    // Гистерезис: между порогами состояние не меняется
+    uint8_t state = channel.state.load(std::memory_order_relaxed);
+    uint8_t newState = state;
+    if (mv >= channel.thresholdHigh) {
+        newState = 1;
+    } else if (mv <= channel.thresholdLow) {
+        newState = 0;
+    }
+    if (newState == state) return;
+
+    channel.state.store(newState, std::memory_order_relaxed);
+    AnalogEvent event = {channel.pin, newState};
+    if (xQueueSend(eventQueue, &event, 0) != pdTRUE) {
+        eventsDropped.fetch_add(1, std::memory_order_relaxed);
+    }
+}
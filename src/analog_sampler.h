@@ -0,0 +1,84 @@
+#ifndef ANALOG_SAMPLER_H
+#define ANALOG_SAMPLER_H
+
+#include <Arduino.h>
+#include <atomic>
+#include <vector>
+#include "config.h"
+
+// Аналоговые входы читаются ADC1 в непрерывном режиме: контроллер сам
+// перебирает каналы с частотой ANALOG_SAMPLE_RATE и складывает результаты
+// в DMA-буфер. Отдельная задача забирает кадры, усредняет выборки
+// (децимация), фильтрует (EMA или скользящее среднее), переводит в мВ
+// по калибровке eFuse и формирует события при пересечении порогов.
+// Основной цикл не опрашивает ADC и только получает готовые значения.
+
+struct AnalogEvent {
+    uint8_t pin;
+    uint8_t state;      // 1 - выше threshold_high, 0 - ниже threshold_low
+};
+
+struct AnalogStats {
+    uint32_t samples;       // Выборок прочитано из DMA
+    uint32_t overruns;      // Переполнений DMA-буфера
+    uint32_t eventsDropped; // Очередь событий была полна
+};
+
+class AnalogSampler {
+public:
+    bool begin(const std::vector<PinConfig>& configs);
+    bool readEvent(AnalogEvent& event);
+    bool isAnalog(uint8_t pin);
+    uint16_t getMillivolts(uint8_t pin);
+    uint8_t getState(uint8_t pin);
+    uint8_t getChannelCount();
+    uint8_t getChannelPin(uint8_t index);
+    AnalogStats getStats();
+
+    static int8_t adcChannelForPin(uint8_t pin);
+
+private:
+    struct Channel {
+        uint8_t pin;
+        uint8_t adcChannel;
+        bool ema;
+        uint16_t decimation;
+        uint8_t window;
+        uint16_t thresholdHigh;
+        uint16_t thresholdLow;
+
+        // Состояние фильтра; доступно только задаче чтения
+        uint32_t accumulator;
+        uint16_t accumulated;
+        bool primed;
+        int32_t emaValue;       // Фиксированная точка, 8 дробных бит
+        uint16_t history[ANALOG_MAX_WINDOW];
+        uint32_t historySum;
+        uint8_t historyPos;
+        uint8_t historyFill;
+
+        std::atomic<uint16_t> millivolts;
+        std::atomic<uint8_t> state;
+    };
+
+    Channel channels[ANALOG_PINS_COUNT];
+    uint8_t channelCount = 0;
+    int8_t slotByAdcChannel[8];
+    bool running = false;
+
+    std::atomic<uint32_t> samples{0};
+    std::atomic<uint32_t> overruns{0};
+    std::atomic<uint32_t> eventsDropped{0};
+
+    int8_t findSlot(uint8_t pin);
+    uint16_t configureChannels(const std::vector<PinConfig>& configs);
+    void processFrame(const uint8_t* data, uint32_t length);
+    void processValue(Channel& channel, uint16_t raw);
+    static void taskEntry(void* arg);
+
+    friend struct AnalogSamplerTest;
+};
+
+extern AnalogSampler analogSampler;
+
+#endif
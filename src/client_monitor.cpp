@@ -0,0 +1,109 @@
+#include "client_monitor.h"
+
+extern WebSocketsServer webSocket;
+
+// Верхние границы корзин, мс
+static const uint16_t bucketBounds[WS_RTT_BUCKETS - 1] = {1, 2, 5, 10, 20, 50, 100, 200, 500, 1000, 2000};
+
+// Ping дольше этого считается потерянным, даже если pong всё-таки пришёл
+#define RTT_MAX_US 60000000UL
+
+void RttHistogram::add(uint32_t us) {
+    uint8_t bucket = 0;
+    while (bucket < WS_RTT_BUCKETS - 1 && us >= (uint32_t)bucketBounds[bucket] * 1000) {
+        bucket++;
+    }
+    buckets[bucket]++;
+    if (count == 0 || us < minUs) minUs = us;
+    if (us > maxUs) maxUs = us;
+    lastUs = us;
+    totalUs += us;
+    count++;
+}
+
+uint32_t RttHistogram::percentileUs(uint8_t percent) const {
+    if (count == 0) return 0;
+    uint32_t target = ((uint64_t)count * percent + 99) / 100;
+    uint32_t seen = 0;
+    for (uint8_t bucket = 0; bucket < WS_RTT_BUCKETS - 1; bucket++) {
+        seen += buckets[bucket];
+        if (seen >= target) {
+            return min((uint32_t)bucketBounds[bucket] * 1000, maxUs);
+        }
+    }
+    return maxUs;
+}
+
+void ClientMonitor::clientConnected(uint8_t num) {
+    if (num >= WEBSOCKETS_SERVER_CLIENT_MAX) return;
+    ClientStats& client = clients[num];
+    memset(&client, 0, sizeof(client));
+    client.connected = true;
+    client.connectedAt = millis();
+    client.lastPing = client.connectedAt;
+}
+
+void ClientMonitor::clientDisconnected(uint8_t num) {
+    if (num >= WEBSOCKETS_SERVER_CLIENT_MAX) return;
+    clients[num].connected = false;
+}
+
+void ClientMonitor::handle(unsigned long currentMillis) {
+    for (uint8_t num = 0; num < WEBSOCKETS_SERVER_CLIENT_MAX; num++) {
+        ClientStats& client = clients[num];
+        if (!client.connected || currentMillis - client.lastPing < WS_RTT_PING_INTERVAL) continue;
+
+        if (client.pendingSeq) client.pingsLost++;
+
+        // Номер и время отправки возвращаются в pong без изменений
+        uint32_t payload[2] = {nextSeq, (uint32_t)micros()};
+        nextSeq = nextSeq == UINT32_MAX ? 1 : nextSeq + 1;
+        client.pendingSeq = payload[0];
+        client.lastPing = currentMillis;
+        client.pingsSent++;
+        webSocket.sendPing(num, (uint8_t*)payload, sizeof(payload));
+    }
+}
+
+void ClientMonitor::onPong(uint8_t num, const uint8_t* payload, size_t length) {
+    if (num >= WEBSOCKETS_SERVER_CLIENT_MAX || length != 2 * sizeof(uint32_t)) return;
+    ClientStats& client = clients[num];
+
+    uint32_t seq, sent;
+    memcpy(&seq, payload, sizeof(seq));
+    memcpy(&sent, payload + sizeof(seq), sizeof(sent));
+    // Ответ на устаревший или чужой ping не учитывается
+    if (!client.connected || client.pendingSeq == 0 || seq != client.pendingSeq) return;
+    client.pendingSeq = 0;
+
+    uint32_t rtt = (uint32_t)micros() - sent;
+    if (rtt > RTT_MAX_US) {
+        client.pingsLost++;
+        return;
+    }
+    client.rtt.add(rtt);
+    total.add(rtt);
+}
+
+void ClientMonitor::countCommand(uint8_t num, bool ok, bool duplicate) {
+    if (num >= WEBSOCKETS_SERVER_CLIENT_MAX) return;
+    ClientStats& client = clients[num];
+    if (duplicate) client.duplicates++;
+    if (ok) {
+        client.acks++;
+    } else {
+        client.nacks++;
+    }
+}
+
+const ClientStats& ClientMonitor::getClient(uint8_t num) {
+    return clients[num < WEBSOCKETS_SERVER_CLIENT_MAX ? num : 0];
+}
+
+const RttHistogram& ClientMonitor::getTotal() {
+    return total;
+}
+
+uint16_t ClientMonitor::bucketBoundMs(uint8_t bucket) {
+    return bucket < WS_RTT_BUCKETS - 1 ? bucketBounds[bucket] : 0;
+}
@@ -0,0 +1,60 @@
+#ifndef CLIENT_MONITOR_H
+#define CLIENT_MONITOR_H
+
+#include <Arduino.h>
+#include <WebSocketsServer.h>
+#include "config.h"
+
+// Гистограмма времени приёма-передачи. Границы корзин (мс) задаёт
+// ClientMonitor::bucketBoundMs, последняя корзина - всё, что больше.
+struct RttHistogram {
+    uint32_t buckets[WS_RTT_BUCKETS];
+    uint32_t count;
+    uint64_t totalUs;
+    uint32_t minUs;
+    uint32_t maxUs;
+    uint32_t lastUs;
+
+    void add(uint32_t us);
+    // Оценка перцентиля по верхней границе корзины (мкс)
+    uint32_t percentileUs(uint8_t percent) const;
+};
+
+struct ClientStats {
+    bool connected;
+    unsigned long connectedAt;
+    RttHistogram rtt;
+    uint32_t pingsSent;
+    uint32_t pingsLost;                 // Не было pong до следующего ping
+    uint32_t acks;
+    uint32_t nacks;
+    uint32_t duplicates;                // Повторы, подавленные по cid/id
+
+    unsigned long lastPing;
+    uint32_t pendingSeq;                // 0 - ответа не ждём
+};
+
+// Сетевая задержка каждого клиента WebSocket: раз в WS_RTT_PING_INTERVAL
+// клиенту уходит кадр ping с номером и временем отправки, браузер отвечает
+// pong автоматически. RTT включает задержку разбора в webSocket.loop(),
+// но не обработку команд, поэтому её можно сравнивать со временем ack.
+class ClientMonitor {
+public:
+    void clientConnected(uint8_t num);
+    void clientDisconnected(uint8_t num);
+    void handle(unsigned long currentMillis);
+    void onPong(uint8_t num, const uint8_t* payload, size_t length);
+    void countCommand(uint8_t num, bool ok, bool duplicate);
+
+    const ClientStats& getClient(uint8_t num);
+    // Все замеры с момента загрузки, включая отключившихся клиентов
+    const RttHistogram& getTotal();
+    static uint16_t bucketBoundMs(uint8_t bucket);
+
+private:
+    ClientStats clients[WEBSOCKETS_SERVER_CLIENT_MAX] = {};
+    RttHistogram total = {};
+    uint32_t nextSeq = 1;
+};
+
+#endif
@@ -0,0 +1,55 @@
+#include "command_journal.h"
+
+static bool isExpired(uint32_t lastUsed, uint32_t now) {
+    return now - lastUsed > WS_COMMAND_RETAIN_TIME;
+}
+
+const CommandJournal::ClientJournal* CommandJournal::findClient(uint32_t clientId, uint32_t now) const {
+    for (const ClientJournal& client : clients) {
+        if (client.clientId == clientId && !isExpired(client.lastUsed, now)) {
+            return &client;
+        }
+    }
+    return nullptr;
+}
+
+CommandJournal::ClientJournal& CommandJournal::allocateClient(uint32_t clientId, uint32_t now) {
+    ClientJournal* free = nullptr;
+    ClientJournal* oldest = &clients[0];
+    for (ClientJournal& client : clients) {
+        if (client.clientId == clientId) return client;
+        if (!free && (client.clientId == 0 || isExpired(client.lastUsed, now))) free = &client;
+        if (now - client.lastUsed > now - oldest->lastUsed) oldest = &client;
+    }
+
+    ClientJournal& client = free ? *free : *oldest;
+    client.clientId = clientId;
+    client.next = 0;
+    client.count = 0;
+    return client;
+}
+
+const CommandRecord* CommandJournal::find(uint32_t clientId, uint32_t id) const {
+    const ClientJournal* client = findClient(clientId, millis());
+    if (!client) return nullptr;
+    for (uint8_t i = 0; i < client->count; i++) {
+        if (client->records[i].id == id) {
+            return &client->records[i];
+        }
+    }
+    return nullptr;
+}
+
+void CommandJournal::add(const CommandRecord& record) {
+    uint32_t now = millis();
+    ClientJournal& client = allocateClient(record.clientId, now);
+    // Истёкшие записи того же клиента не должны отвечать на новый id
+    if (isExpired(client.lastUsed, now)) {
+        client.next = 0;
+        client.count = 0;
+    }
+    client.lastUsed = now;
+    client.records[client.next] = record;
+    client.next = (client.next + 1) % WS_COMMAND_JOURNAL_DEPTH;
+    if (client.count < WS_COMMAND_JOURNAL_DEPTH) client.count++;
+}
@@ -0,0 +1,46 @@
+#ifndef COMMAND_JOURNAL_H
+#define COMMAND_JOURNAL_H
+
+#include <Arduino.h>
+#include "config.h"
+#include "ws_command.h"
+
+// Результат команды установки с идентификатором. По нему повторная
+// команда (тот же cid и id, например после переподключения) получает
+// тот же ответ и не применяется второй раз.
+struct CommandRecord {
+    uint32_t clientId;
+    uint32_t id;
+    uint32_t timestamp;                 // millis() выполнения
+    bool batch;
+    const char* error;                  // nullptr - команда выполнена
+    uint8_t errorPin;
+    uint8_t count;
+    WsPinValue items[WS_BATCH_MAX];     // Применённые значения
+};
+
+// Команды хранятся по cid: у каждого клиента своё кольцо из
+// WS_COMMAND_JOURNAL_DEPTH записей. Клиент, молчащий дольше
+// WS_COMMAND_RETAIN_TIME, забывается; при нехватке мест вытесняется
+// клиент, дольше всех не присылавший команд.
+class CommandJournal {
+public:
+    const CommandRecord* find(uint32_t clientId, uint32_t id) const;
+    void add(const CommandRecord& record);
+
+private:
+    struct ClientJournal {
+        uint32_t clientId;              // 0 - слот свободен
+        uint32_t lastUsed;              // millis() последней команды
+        uint8_t next;
+        uint8_t count;
+        CommandRecord records[WS_COMMAND_JOURNAL_DEPTH];
+    };
+
+    const ClientJournal* findClient(uint32_t clientId, uint32_t now) const;
+    ClientJournal& allocateClient(uint32_t clientId, uint32_t now);
+
+    ClientJournal clients[WS_COMMAND_JOURNAL_CLIENTS] = {};
+};
+
+#endif
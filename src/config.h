@@ -15,11 +15,111 @@
 #define WEB_SERVER_PORT 80
 #define WEB_SOCKET_PORT 81
 #define JSON_BUFFER_SIZE 3072
+#define WS_MAX_FRAME_SIZE 512       // Максимальный размер входящей команды (байт)
+#define WS_BATCH_MAX 33             // Максимум пинов в пакетной команде (GPIO и расширитель)
+#define WS_REPLY_BUFFER_SIZE 64     // Буфер ответа на одну команду
+#define WS_TELEMETRY_INTERVAL 2000  // Интервал телеметрии по умолчанию (мс)
+#define WS_TELEMETRY_MIN_INTERVAL 250
+#define WS_TELEMETRY_BUFFER_SIZE 192
+#define LOOP_STATS_WINDOW 2000      // Окно статистики loop() в телеметрии (мс)
+// ack пакетной команды со всеми пинами: заголовок и хвост с 32-битными
+// id/ts и "dup" (до 64 байт) плюс WS_BATCH_MAX элементов ",[255,1]"
+#define WS_ACK_ITEM_MAX_LEN 8
+#define WS_ACK_BUFFER_SIZE (64 + WS_BATCH_MAX * WS_ACK_ITEM_MAX_LEN)
+// Журнал команд с cid для подавления повторов: у каждого клиента свои
+// последние команды, чтобы чужой поток не вытеснял их до переподключения
+#define WS_COMMAND_JOURNAL_CLIENTS 8    // Клиентов (cid) в журнале
+#define WS_COMMAND_JOURNAL_DEPTH 4      // Последних команд на клиента
+#ifndef WS_COMMAND_RETAIN_TIME
+#define WS_COMMAND_RETAIN_TIME 60000    // Хранение после последней команды клиента (мс)
+#endif
+#define WS_RTT_PING_INTERVAL 5000   // Интервал ping для замера RTT клиента (мс)
+#define WS_RTT_BUCKETS 12           // Корзины гистограммы RTT, последняя - переполнение
+
+// Обнаружение устройств и поток состояний по UDP multicast
+#define FLEET_MULTICAST_GROUP 239, 255, 70, 71
+#define FLEET_MULTICAST_PORT 4270
+#define FLEET_ANNOUNCE_INTERVAL 30000   // Объявление о себе (мс)
+#define FLEET_DEFAULT_HEARTBEAT 5000    // Датаграмма состояния без изменений (мс)
+#define FLEET_MIN_HEARTBEAT 250
+#define FLEET_ANNOUNCE_BUFFER_SIZE 320
+
+// Настройки MQTT
+#define MQTT_DEFAULT_PORT 1883
+#define MQTT_DEFAULT_BASE_TOPIC "esp32_gpio"
+#ifndef MQTT_RECONNECT_INTERVAL
+#define MQTT_RECONNECT_INTERVAL 5000  // Пауза после первой неудачной попытки подключения (мс)
+#endif
+#ifndef MQTT_RECONNECT_MAX_INTERVAL
+#define MQTT_RECONNECT_MAX_INTERVAL 60000  // Предел удвоения паузы между попытками (мс)
+#endif
+#define MQTT_SOCKET_TIMEOUT 2         // Таймаут сокета (с)
+#define MQTT_PUBLISH_BATCH 8          // Максимум публикаций за один проход задачи
+#define MQTT_TOPIC_SIZE 96
+#define MQTT_COMMAND_QUEUE_SIZE 16    // Очередь команд /set в основной цикл
+#define MQTT_TASK_INTERVAL 10         // Период прохода задачи MQTT (мс)
+#define MQTT_TASK_STACK 4096
+#define MQTT_TASK_PRIORITY 1
+#define MQTT_TASK_CORE 0
+
+// Настройки Modbus TCP
+#define MODBUS_TCP_PORT 502
+#define MODBUS_MAX_CLIENTS 4
+#define MODBUS_CLIENT_TIMEOUT 60000     // Отключение неактивного клиента (мс)
+#define MODBUS_WRITE_QUEUE_SIZE 32      // Очередь запросов записи в основной цикл (один на запрос)
+#define MODBUS_TASK_STACK 4096
+#define MODBUS_TASK_PRIORITY 1
+#define MODBUS_TASK_CORE 0
+
+// Настройки журнала
+#define LOG_LEVEL_NONE 0
+#define LOG_LEVEL_ERROR 1
+#define LOG_LEVEL_WARN 2
+#define LOG_LEVEL_INFO 3
+#define LOG_LEVEL_DEBUG 4
+#ifndef LOG_LEVEL
+#define LOG_LEVEL LOG_LEVEL_INFO     // Записи ниже этого уровня не компилируются
+#endif
+#define LOG_RING_SIZE 128            // Записей в кольцевом буфере (степень двойки)
+#define LOG_MAX_ARGS 6
+#define LOG_LINE_SIZE 128
+#ifndef LOG_DRAIN_INTERVAL
+#define LOG_DRAIN_INTERVAL 20        // Период опроса буфера задачей вывода (мс)
+#endif
+#define LOG_TASK_STACK 3072
+#define LOG_TASK_PRIORITY 1
+#define LOG_TASK_CORE 0
+#define LOG_WS_QUEUE_SIZE 16         // Строк в очереди для топика logs
+#define LOG_WS_BATCH 8               // Строк за один проход loop()
+#define LOG_PERSIST_RECORDS 64       // Последние записи, сохраняемые в LittleFS
+#define LOG_PERSIST_INTERVAL 60000   // Период сохранения (мс)
+#define LOG_PERSIST_MIN_INTERVAL 5000 // Не чаще, даже при ошибках (мс)
+#define LOG_PERSIST_FILE "/log.bin"
 
 // Настройки GPIO
 #define DEBOUNCE_DELAY 50           // мс
 #define SAVE_DELAY 2000             // Задержка записи в NVS (мс)
 
+// Номера пинов: 0..39 - GPIO ESP32, EXPANDER_PIN_BASE.. - виртуальные пины
+// расширителя. Все номера должны помещаться в 64-битные маски.
+#define PIN_COUNT 64
+#define NATIVE_PIN_COUNT 40
+
+// Расширитель портов MCP23017 (I2C). Выключен по умолчанию: шина занимает
+// GPIO 19, 21 и 22. Включается флагом сборки -D EXPANDER_ENABLED=1.
+#ifndef EXPANDER_ENABLED
+#define EXPANDER_ENABLED 0
+#endif
+#define EXPANDER_I2C_ADDRESS 0x20
+#define EXPANDER_SDA_PIN 21
+#define EXPANDER_SCL_PIN 22
+#define EXPANDER_INT_PIN 19          // Выход INTA/INTB (активный 0); -1 - без прерывания
+#define EXPANDER_I2C_CLOCK 400000
+#define EXPANDER_PIN_BASE 40         // Виртуальные пины 40..55: GPA0..7, GPB0..7
+#define EXPANDER_PIN_COUNT 16
+#define EXPANDER_POLL_INTERVAL 20    // Опрос входов без линии прерывания (мс)
+#define EXPANDER_RESYNC_INTERVAL 1000 // Контрольное чтение при работе по прерыванию (мс)
+
 // Разрешенные пины
 const uint8_t ALLOWED_PINS[] = {2, 4, 5, 13, 14, 16, 17, 18, 19, 21, 22, 23, 25, 26, 27, 32, 33};
 const uint8_t ALLOWED_PINS_COUNT = 17;
@@ -27,20 +127,45 @@ const uint8_t ALLOWED_PINS_COUNT = 17;
 // Запрещенные пины
 const uint8_t EXCLUDED_PINS[] = {0, 1, 3, 6, 7, 8, 9, 10, 11, 12, 15, 34, 35, 36, 37, 38, 39};
 
+// Аналоговые входы: только ADC1 (ADC2 занят WiFi)
+const uint8_t ANALOG_PINS[] = {32, 33, 34, 35, 36, 39};
+const uint8_t ANALOG_PINS_COUNT = 6;
+
+// Настройки аналоговых входов (непрерывный режим ADC с DMA)
+#define ANALOG_SAMPLE_RATE 20000        // Общая частота выборок ADC на все каналы (Гц)
+#define ANALOG_DMA_FRAME 256            // Байт за одно чтение из DMA
+#define ANALOG_DEFAULT_DECIMATION 100   // Выборок на одно значение после децимации
+#define ANALOG_DEFAULT_WINDOW 8         // Окно фильтра (значений после децимации)
+#define ANALOG_MAX_WINDOW 32
+#define ANALOG_MAX_DECIMATION 10000
+#define ANALOG_EVENT_QUEUE_SIZE 16
+#define ANALOG_PUBLISH_INTERVAL 200     // Отправка значений по WebSocket по умолчанию (мс)
+#define ANALOG_MIN_PUBLISH_INTERVAL 50
+#define ANALOG_TASK_STACK 4096
+#define ANALOG_TASK_PRIORITY 5
+#define ANALOG_TASK_CORE 0
+
 // Пространства NVS
 #define NVS_CONFIG_NAMESPACE "config"
 #define NVS_STATES_NAMESPACE "states"
 #define NVS_WIFI_KEY "wifi_config"
 #define NVS_GPIO_KEY "gpio_config"
+#define NVS_MQTT_KEY "mqtt_config"
+#define NVS_FLEET_KEY "fleet_config"
 
 // Структура конфигурации пина
 struct PinConfig {
   uint8_t pin;
   char name[32];
-  char type[16];        // "input", "output"
-  char mode[16];        // "pullup", "float", "normal", "memory"
+  char type[16];        // "input", "output", "analog"
+  char mode[16];        // "pullup", "float", "normal", "memory"; для analog - "ema", "avg"
   bool memory;
   bool enabled;
+  // Только для analog
+  uint16_t decimation;
+  uint8_t window;
+  uint16_t threshold_high;  // мВ; 0 - без событий по порогу
+  uint16_t threshold_low;   // мВ; гистерезис: событие LOW при значении <= threshold_low
 };
 
 // Структура WiFi конфигурации
@@ -54,4 +179,20 @@ struct WiFiConfig {
   char dns[16];
 };
 
+// Структура MQTT конфигурации
+struct MQTTConfig {
+  bool enabled;
+  char host[64];
+  uint16_t port;
+  char user[32];
+  char password[64];
+  char base_topic[48];
+};
+
+struct FleetConfig {
+  bool announce;            // Объявления в формате JSON
+  bool state;               // Двоичные датаграммы состояния
+  uint16_t heartbeat;       // мс
+};
+
 #endif
\ No newline at end of file
@@ -0,0 +1,161 @@
+#include "fleet_announcer.h"
+#include <WiFi.h>
+#include <WiFiUdp.h>
+#include <Preferences.h>
+#include <ArduinoJson.h>
+#include "gpio_manager.h"
+
+extern Preferences preferences;
+extern GPIOManager gpioManager;
+
+static WiFiUDP fleetUdp;
+static const IPAddress fleetGroup(FLEET_MULTICAST_GROUP);
+
+void FleetAnnouncer::init() {
+    if (!loadConfig()) {
+        fleetConfig.announce = true;
+        fleetConfig.state = false;
+        fleetConfig.heartbeat = FLEET_DEFAULT_HEARTBEAT;
+    }
+    // Тот же идентификатор, что и в имени клиента MQTT
+    deviceId = (ESP.getEfuseMac() >> 24) & 0xFFFFFF;
+    announcePending = true;
+    dirty = true;
+}
+
+void FleetAnnouncer::handle(unsigned long currentMillis) {
+    if (!fleetConfig.announce && !fleetConfig.state) return;
+
+    bool connected = WiFi.status() == WL_CONNECTED;
+    if (!connected) {
+        wasConnected = false;
+        return;
+    }
+    // После (пере)подключения объявляемся и отправляем состояние сразу
+    if (!wasConnected) {
+        wasConnected = true;
+        announcePending = true;
+        dirty = true;
+    }
+
+    if (fleetConfig.announce &&
+        (announcePending || currentMillis - lastAnnounce >= FLEET_ANNOUNCE_INTERVAL)) {
+        sendAnnounce(currentMillis);
+        announcePending = false;
+        lastAnnounce = currentMillis;
+    }
+
+    if (fleetConfig.state) {
+        if (dirty) {
+            sendState(currentMillis, false);
+        } else if (currentMillis - lastState >= fleetConfig.heartbeat) {
+            sendState(currentMillis, true);
+        }
+    }
+}
+
+void FleetAnnouncer::notifyChange() {
+    // Все изменения за проход loop() уходят одной датаграммой
+    dirty = true;
+}
+
+const FleetConfig& FleetAnnouncer::getConfig() {
+    return fleetConfig;
+}
+
+const FleetStats& FleetAnnouncer::getStats() {
+    return stats;
+}
+
+void FleetAnnouncer::sendAnnounce(unsigned long currentMillis) {
+    PinBitmaps bitmaps = gpioManager.getPinBitmaps();
+    IPAddress ip = WiFi.localIP();
+
+    char buf[FLEET_ANNOUNCE_BUFFER_SIZE];
+    int len = snprintf(buf, sizeof(buf),
+        "{\"type\":\"announce\",\"id\":\"esp32gpio-%06lx\",\"ver\":\"%s\",\"ip\":\"%u.%u.%u.%u\","
+        "\"uptime\":%lu,\"ports\":[%u,%u,%u],\"pins\":%u,"
+        "\"in\":\"%016llx\",\"out\":\"%016llx\",\"analog\":\"%016llx\",\"state\":%s,\"seq\":%lu}",
+        (unsigned long)deviceId, FIRMWARE_VERSION, ip[0], ip[1], ip[2], ip[3],
+        currentMillis, WEB_SERVER_PORT, WEB_SOCKET_PORT, MODBUS_TCP_PORT,
+        (unsigned)__builtin_popcountll(bitmaps.inputMask | bitmaps.outputMask),
+        (unsigned long long)bitmaps.inputMask, (unsigned long long)bitmaps.outputMask,
+        (unsigned long long)bitmaps.analogMask,
+        fleetConfig.state ? "true" : "false", (unsigned long)sequence);
+    if (len <= 0 || len >= (int)sizeof(buf)) return;
+
+    if (sendDatagram((const uint8_t*)buf, len)) {
+        stats.announces++;
+    }
+}
+
+void FleetAnnouncer::sendState(unsigned long currentMillis, bool heartbeat) {
+    PinBitmaps bitmaps = gpioManager.getPinBitmaps();
+
+    FleetStatePacket packet;
+    packet.magic[0] = FLEET_STATE_MAGIC0;
+    packet.magic[1] = FLEET_STATE_MAGIC1;
+    packet.version = FLEET_STATE_VERSION;
+    packet.flags = heartbeat ? FLEET_STATE_HEARTBEAT_FLAG : 0;
+    packet.deviceId = deviceId;
+    packet.sequence = ++sequence;
+    packet.uptime = currentMillis;
+    packet.inputMask = bitmaps.inputMask;
+    packet.inputs = bitmaps.inputs;
+    packet.outputMask = bitmaps.outputMask;
+    packet.outputs = bitmaps.outputs;
+
+    // Номер расходуется и при ошибке отправки: получатель увидит пропуск
+    if (sendDatagram((const uint8_t*)&packet, sizeof(packet))) {
+        stats.states++;
+    }
+    dirty = false;
+    lastState = currentMillis;
+}
+
+bool FleetAnnouncer::sendDatagram(const uint8_t* data, size_t length) {
+    if (!fleetUdp.beginPacket(fleetGroup, FLEET_MULTICAST_PORT)) {
+        stats.sendErrors++;
+        return false;
+    }
+    fleetUdp.write(data, length);
+    if (!fleetUdp.endPacket()) {
+        stats.sendErrors++;
+        return false;
+    }
+    return true;
+}
+
+bool FleetAnnouncer::loadConfig() {
+    String jsonStr = preferences.getString(NVS_FLEET_KEY, "");
+    if (jsonStr.length() == 0) return false;
+
+    StaticJsonDocument<128> doc;
+    DeserializationError error = deserializeJson(doc, jsonStr);
+    if (error) return false;
+
+    fleetConfig.announce = doc["announce"] | true;
+    fleetConfig.state = doc["state"] | false;
+    fleetConfig.heartbeat = max((uint16_t)FLEET_MIN_HEARTBEAT, (uint16_t)(doc["heartbeat"] | FLEET_DEFAULT_HEARTBEAT));
+
+    return true;
+}
+
+bool FleetAnnouncer::saveFleetConfig(FleetConfig& config) {
+    config.heartbeat = max((uint16_t)FLEET_MIN_HEARTBEAT, config.heartbeat);
+
+    StaticJsonDocument<128> doc;
+    doc["announce"] = config.announce;
+    doc["state"] = config.state;
+    doc["heartbeat"] = config.heartbeat;
+
+    String jsonStr;
+    serializeJson(doc, jsonStr);
+
+    fleetConfig = config;
+    // Новые настройки сразу объявляются
+    announcePending = true;
+    dirty = true;
+
+    return preferences.putString(NVS_FLEET_KEY, jsonStr) > 0;
+}
@@ -0,0 +1,71 @@
+#ifndef FLEET_ANNOUNCER_H
+#define FLEET_ANNOUNCER_H
+
+#include <Arduino.h>
+#include "config.h"
+
+// Группа FLEET_MULTICAST_GROUP:FLEET_MULTICAST_PORT, два вида датаграмм.
+//
+// Объявление (JSON, раз в FLEET_ANNOUNCE_INTERVAL и после подключения к сети):
+//   {"type":"announce","id":"esp32gpio-ccddee","ver":"1.0.0","ip":"192.168.1.50",
+//    "uptime":123456,"ports":[80,81,502],"pins":5,"in":"0000000000003030",
+//    "out":"0000000000000004","analog":"0000000000000000","state":true,"seq":42}
+// in/out/analog - маски пинов (hex, бит n - пин n).
+//
+// Состояние (FleetStatePacket, little-endian): при каждом изменении пинов,
+// но не чаще одного раза за проход loop(), и раз в heartbeat без изменений.
+// Пропуски в sequence означают потерянные датаграммы.
+
+#define FLEET_STATE_MAGIC0 'G'
+#define FLEET_STATE_MAGIC1 'S'
+#define FLEET_STATE_VERSION 1
+#define FLEET_STATE_HEARTBEAT_FLAG 0x01     // Датаграмма по таймеру, а не по изменению
+
+struct __attribute__((packed)) FleetStatePacket {
+    uint8_t magic[2];
+    uint8_t version;
+    uint8_t flags;
+    uint32_t deviceId;              // Как в id объявления: esp32gpio-<deviceId в hex>
+    uint32_t sequence;
+    uint32_t uptime;                // мс
+    uint64_t inputMask;
+    uint64_t inputs;
+    uint64_t outputMask;
+    uint64_t outputs;
+};
+
+static_assert(sizeof(FleetStatePacket) == 48, "FleetStatePacket layout changed");
+
+struct FleetStats {
+    uint32_t announces;
+    uint32_t states;
+    uint32_t sendErrors;
+};
+
+class FleetAnnouncer {
+public:
+    void init();
+    void handle(unsigned long currentMillis);
+    void notifyChange();
+    const FleetConfig& getConfig();
+    const FleetStats& getStats();
+    bool saveFleetConfig(FleetConfig& config);
+
+private:
+    FleetConfig fleetConfig;
+    FleetStats stats = {};
+    uint32_t deviceId = 0;
+    uint32_t sequence = 0;
+    bool dirty = true;
+    bool wasConnected = false;
+    bool announcePending = true;    // Объявиться при ближайшем проходе
+    unsigned long lastAnnounce = 0;
+    unsigned long lastState = 0;
+
+    bool loadConfig();
+    void sendAnnounce(unsigned long currentMillis);
+    void sendState(unsigned long currentMillis, bool heartbeat);
+    bool sendDatagram(const uint8_t* data, size_t length);
+};
+
+#endif
@@ -1,36 +1,101 @@
 #include "gpio_manager.h"
 #include <Preferences.h>
 #include <ArduinoJson.h>
+#include "analog_sampler.h"
+#include "logger.h"
 
 extern Preferences preferences;
 
+static_assert(EXPANDER_PIN_BASE >= NATIVE_PIN_COUNT && EXPANDER_PIN_BASE + EXPANDER_PIN_COUNT <= PIN_COUNT,
+              "Expander pins must fit between native GPIOs and PIN_COUNT");
+
 void GPIOManager::init() {
+    initExpander();
+    
     for (const auto& config : pinConfigs) {
         if (config.enabled) {
             configurePin(config);
         }
     }
+    
+    // Настройки расширителя уходят на шину одной серией, затем читаются входы
+    expander.update(millis(), true);
+    for (const auto& config : pinConfigs) {
+        PinBackend* backend = backendFor(config.pin);
+        if (!config.enabled || !backend || strcmp(config.type, "input") != 0) continue;
+        lastInputState[config.pin] = backend->read(config.pin);
+        lastReading[config.pin] = lastInputState[config.pin];
+    }
+    
     loadStates();
+    analogSampler.begin(pinConfigs);
+}
+
+void GPIOManager::onChange(PinChangeCallback callback) {
+    changeCallback = callback;
+}
+
+void GPIOManager::update() {
+    // Один такт обмена с расширителем: изменённые выходы и входы по прерыванию
+    expander.update(millis(), false);
+}
+
+void GPIOManager::initExpander() {
+#if EXPANDER_ENABLED
+    // Шина I2C занимает пины, которые могут быть настроены как обычные GPIO
+    for (const auto& config : pinConfigs) {
+        if (config.enabled && isExpanderBusPin(config.pin)) {
+            LOG_WARN("Expander disabled: GPIO %u is in use", config.pin);
+            return;
+        }
+    }
+    
+    Wire.begin(EXPANDER_SDA_PIN, EXPANDER_SCL_PIN, EXPANDER_I2C_CLOCK);
+    if (expander.begin()) {
+        LOG_INFO("MCP23017 found at 0x%02x, pins %u-%u", EXPANDER_I2C_ADDRESS,
+                 EXPANDER_PIN_BASE, EXPANDER_PIN_BASE + EXPANDER_PIN_COUNT - 1);
+    } else {
+        LOG_WARN("MCP23017 not found at 0x%02x", EXPANDER_I2C_ADDRESS);
+        Wire.end();
+    }
+#endif
+}
+
+PinBackend* GPIOManager::backendFor(uint8_t pin) {
+    if (nativePins.hasPin(pin)) return &nativePins;
+    if (expander.hasPin(pin)) return &expander;
+    return nullptr;
+}
+
+bool GPIOManager::isExpanderBusPin(uint8_t pin) {
+    return EXPANDER_ENABLED &&
+           (pin == EXPANDER_SDA_PIN || pin == EXPANDER_SCL_PIN || pin == EXPANDER_INT_PIN);
 }
 
 void GPIOManager::configurePin(const PinConfig& config) {
+    PinBackend* backend = backendFor(config.pin);
+    if (!backend) {
+        LOG_WARN("Pin %u is not available", config.pin);
+        return;
+    }
+    
     if (strcmp(config.type, "input") == 0) {
         if (strcmp(config.mode, "pullup") == 0) {
-            pinMode(config.pin, INPUT_PULLUP);
+            backend->setMode(config.pin, INPUT_PULLUP);
         } else {
-            pinMode(config.pin, INPUT);
+            backend->setMode(config.pin, INPUT);
         }
-        lastInputState[config.pin] = digitalRead(config.pin);
     } else if (strcmp(config.type, "output") == 0) {
-        pinMode(config.pin, OUTPUT);
         uint8_t initialState = LOW;
         if (config.memory) {
             // Восстановление состояния из NVS - ИСПРАВЛЕНО
             char key[16];
             snprintf(key, sizeof(key), "pin_%d", config.pin);
-            initialState = preferences.getUChar(key, LOW);
+            initialState = preferences.getUChar(key, LOW) ? HIGH : LOW;
         }
-        digitalWrite(config.pin, initialState);
+        // Уровень задаётся до переключения в выход
+        backend->write(config.pin, initialState);
+        backend->setMode(config.pin, OUTPUT);
         
         PinState state;
         state.pin = config.pin;
@@ -46,10 +111,15 @@ void GPIOManager::checkInputs() {
     
     for (const auto& config : pinConfigs) {
         if (!config.enabled || strcmp(config.type, "input") != 0) continue;
+        PinBackend* backend = backendFor(config.pin);
+        if (!backend) continue;
         
-        uint8_t currentState = digitalRead(config.pin);
+        // Для расширителя - значение из последнего пакетного чтения порта
+        uint8_t currentState = backend->read(config.pin);
         
-        if (currentState != lastInputState[config.pin]) {
+        // Таймер дребезга сбрасывается при любом изменении сырого значения
+        if (currentState != lastReading[config.pin]) {
+            lastReading[config.pin] = currentState;
             lastDebounceTime[config.pin] = currentMillis;
         }
         
@@ -57,26 +127,52 @@ void GPIOManager::checkInputs() {
             if (currentState != lastInputState[config.pin]) {
                 lastInputState[config.pin] = currentState;
                 // Событие изменения входа
-                Serial.printf("Pin %d changed to %d\n", config.pin, currentState);
+                if (changeCallback) {
+                    changeCallback(config.pin, currentState);
+                }
             }
         }
     }
+    
+    // События порогов аналоговых входов (гистерезис уже учтён)
+    AnalogEvent event;
+    while (analogSampler.readEvent(event)) {
+        lastInputState[event.pin] = event.state;
+        if (changeCallback) {
+            changeCallback(event.pin, event.state);
+        }
+    }
 }
 
 void GPIOManager::setOutput(uint8_t pin, uint8_t value) {
+    // MQTT и Modbus передают произвольный байт: хранится и рассылается
+    // только фактически выставленный уровень
+    value = value ? HIGH : LOW;
     for (auto& state : pinStates) {
         if (state.pin == pin) {
-            digitalWrite(pin, value);
+            backendFor(pin)->write(pin, value);
             state.value = value;
             state.lastChange = millis();
             state.needsSave = true;
+            if (changeCallback) {
+                changeCallback(pin, value);
+            }
             break;
         }
     }
 }
 
 uint8_t GPIOManager::getInput(uint8_t pin) {
-    return lastInputState[pin];
+    return pin < PIN_COUNT ? lastInputState[pin] : 0;
+}
+
+uint8_t GPIOManager::getOutput(uint8_t pin) {
+    for (const auto& state : pinStates) {
+        if (state.pin == pin) {
+            return state.value;
+        }
+    }
+    return 0;
 }
 
 void GPIOManager::loadConfig() {
@@ -94,19 +190,70 @@ void GPIOManager::loadConfig() {
     pinConfigs.clear();
     
     for (JsonObject pinObj : pinsArray) {
+        // Конфигурация, сохранённая до проверки номеров, может содержать
+        // пины за пределами таблиц состояний
+        int pin = pinObj["pin"] | -1;
+        if (pin < 0 || pin >= PIN_COUNT) {
+            LOG_WARN("Config entry for pin %d skipped", pin);
+            continue;
+        }
+        
         PinConfig config;
-        config.pin = pinObj["pin"].as<uint8_t>();
+        config.pin = pin;
         strlcpy(config.name, pinObj["name"] | "", sizeof(config.name));
         strlcpy(config.type, pinObj["type"] | "input", sizeof(config.type));
         strlcpy(config.mode, pinObj["mode"] | "pullup", sizeof(config.mode));
         config.memory = pinObj["memory"] | false;
         config.enabled = pinObj["enabled"] | true;
+        config.decimation = pinObj["decimation"] | ANALOG_DEFAULT_DECIMATION;
+        config.window = pinObj["window"] | ANALOG_DEFAULT_WINDOW;
+        config.threshold_high = pinObj["threshold_high"] | 0;
+        config.threshold_low = pinObj["threshold_low"] | 0;
         
         pinConfigs.push_back(config);
     }
 }
 
+const char* GPIOManager::validateConfig(const std::vector<PinConfig>& configs, int& badPin) {
+    uint64_t used = 0;
+    for (const auto& config : configs) {
+        badPin = config.pin;
+        if (config.pin >= PIN_COUNT) return "Invalid pin";
+        if (!config.enabled) continue;
+
+        bool analog = strcmp(config.type, "analog") == 0;
+        if (!analog && strcmp(config.type, "input") != 0 && strcmp(config.type, "output") != 0) {
+            return "Invalid pin type";
+        }
+
+        if (analog) {
+            if (!isAnalogPin(config.pin)) return "Pin is not analog";
+            // Иначе AnalogSampler молча исправит значения, и сохранённая
+            // конфигурация разойдётся с работающей
+            if (config.decimation < 1 || config.decimation > ANALOG_MAX_DECIMATION) {
+                return "Invalid decimation";
+            }
+            if (config.window < 1 || config.window > ANALOG_MAX_WINDOW) return "Invalid window";
+            if (config.threshold_low > config.threshold_high) return "Invalid thresholds";
+        } else if (config.pin >= NATIVE_PIN_COUNT) {
+            // Виртуальные пины есть, только если расширитель найден
+            if (!expander.hasPin(config.pin)) return "Expander pin not available";
+        } else if (!isPinAllowed(config.pin) || (expander.isPresent() && isExpanderBusPin(config.pin))) {
+            return "Pin not available";
+        }
+
+        uint64_t bit = 1ULL << config.pin;
+        if (used & bit) return "Duplicate pin";
+        used |= bit;
+    }
+    badPin = -1;
+    return nullptr;
+}
+
 bool GPIOManager::saveConfig(const std::vector<PinConfig>& configs) {
+    int badPin;
+    if (validateConfig(configs, badPin)) return false;
+
     DynamicJsonDocument doc(JSON_BUFFER_SIZE);
     JsonArray pinsArray = doc.createNestedArray("pins");
     
@@ -118,6 +265,12 @@ bool GPIOManager::saveConfig(const std::vector<PinConfig>& configs) {
         pinObj["mode"] = config.mode;
         pinObj["memory"] = config.memory;
         pinObj["enabled"] = config.enabled;
+        if (strcmp(config.type, "analog") == 0) {
+            pinObj["decimation"] = config.decimation;
+            pinObj["window"] = config.window;
+            pinObj["threshold_high"] = config.threshold_high;
+            pinObj["threshold_low"] = config.threshold_low;
+        }
     }
     
     String jsonStr;
@@ -140,10 +293,10 @@ void GPIOManager::saveStatesIfNeeded() {
 
 std::vector<uint8_t> GPIOManager::getAvailablePins() {
     std::vector<uint8_t> available;
-    bool usedPins[40] = {false};
+    bool usedPins[PIN_COUNT] = {false};
     
     for (const auto& config : pinConfigs) {
-        if (config.enabled) {
+        if (config.enabled && config.pin < PIN_COUNT) {
             usedPins[config.pin] = true;
         }
     }
@@ -160,18 +313,65 @@ std::vector<uint8_t> GPIOManager::getAvailablePins() {
             }
         }
         
+        // Пины шины заняты, если расширитель найден
+        if (expander.isPresent() && isExpanderBusPin(pin)) {
+            excluded = true;
+        }
+        
         if (!excluded && !usedPins[pin]) {
             available.push_back(pin);
         }
     }
     
+    // Виртуальные пины расширителя
+    for (uint8_t pin = EXPANDER_PIN_BASE; pin < EXPANDER_PIN_BASE + EXPANDER_PIN_COUNT; pin++) {
+        if (expander.hasPin(pin) && !usedPins[pin]) {
+            available.push_back(pin);
+        }
+    }
+    
+    return available;
+}
+
+std::vector<uint8_t> GPIOManager::getAvailableAnalogPins() {
+    std::vector<uint8_t> available;
+    
+    for (uint8_t i = 0; i < ANALOG_PINS_COUNT; i++) {
+        PinConfig* config = getPinConfig(ANALOG_PINS[i]);
+        if (!config || !config->enabled) {
+            available.push_back(ANALOG_PINS[i]);
+        }
+    }
+    
     return available;
 }
 
-std::vector<PinConfig> GPIOManager::getPinConfigs() {
+const std::vector<PinConfig>& GPIOManager::getPinConfigs() {
     return pinConfigs;
 }
 
+ExpanderStats GPIOManager::getExpanderStats() {
+    return expander.getStats();
+}
+
+PinBitmaps GPIOManager::getPinBitmaps() {
+    PinBitmaps bitmaps = {};
+    for (const auto& config : pinConfigs) {
+        if (!config.enabled || config.pin >= PIN_COUNT) continue;
+
+        uint64_t bit = 1ULL << config.pin;
+        if (strcmp(config.type, "output") == 0) {
+            bitmaps.outputMask |= bit;
+            if (getOutput(config.pin)) bitmaps.outputs |= bit;
+        } else if (strcmp(config.type, "input") == 0 || strcmp(config.type, "analog") == 0) {
+            if (strcmp(config.type, "analog") == 0) bitmaps.analogMask |= bit;
+            bitmaps.inputMask |= bit;
+            if (lastInputState[config.pin]) bitmaps.inputs |= bit;
+        }
+    }
+    return bitmaps;
+}
+
 PinConfig* GPIOManager::getPinConfig(uint8_t pin) {
     for (auto& config : pinConfigs) {
         if (config.pin == pin) {
@@ -181,7 +381,7 @@ PinConfig* GPIOManager::getPinConfig(uint8_t pin) {
     return nullptr;
 }
 
-bool GPIOManager::isPinAvailable(uint8_t pin) {
+bool GPIOManager::isPinAllowed(uint8_t pin) {
     // Проверка на запрещенные пины
     for (uint8_t i = 0; i < sizeof(EXCLUDED_PINS); i++) {
         if (pin == EXCLUDED_PINS[i]) {
@@ -198,7 +398,11 @@ bool GPIOManager::isPinAvailable(uint8_t pin) {
         }
     }
     
-    if (!allowed) return false;
+    return allowed;
+}
+
+bool GPIOManager::isPinAvailable(uint8_t pin) {
+    if (!isPinAllowed(pin)) return false;
     
     // Проверка на занятость
     for (const auto& config : pinConfigs) {
@@ -210,6 +414,13 @@ bool GPIOManager::isPinAvailable(uint8_t pin) {
     return true;
 }
 
+bool GPIOManager::isAnalogPin(uint8_t pin) {
+    for (uint8_t i = 0; i < ANALOG_PINS_COUNT; i++) {
+        if (pin == ANALOG_PINS[i]) return true;
+    }
+    return false;
+}
+
 void GPIOManager::loadStates() {
     // Загрузка состояний для выходов с памятью - ИСПРАВЛЕНО
     for (auto& config : pinConfigs) {
@@ -220,7 +431,7 @@ void GPIOManager::loadStates() {
             for (auto& state : pinStates) {
                 if (state.pin == config.pin) {
                     state.value = savedState;
-                    digitalWrite(config.pin, savedState);
+                    backendFor(config.pin)->write(config.pin, savedState);
                     break;
                 }
             }
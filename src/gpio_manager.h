@@ -4,6 +4,8 @@
 #include <Arduino.h>
 #include <vector>
 #include "config.h"
+#include "pin_backend.h"
+#include "mcp23017.h"
 
 struct PinState {
     uint8_t pin;
@@ -12,27 +14,60 @@ struct PinState {
     bool needsSave;
 };
 
+// Состояния всех пинов одним словом: бит n - пин n. Аналоговые входы
+// входят в inputs состоянием по порогам.
+struct PinBitmaps {
+    uint64_t inputMask;
+    uint64_t inputs;
+    uint64_t outputMask;
+    uint64_t outputs;
+    uint64_t analogMask;
+};
+
+// Обработчик изменения состояния пина (вход после подавления дребезга,
+// пересечение порога аналогового входа или выход)
+typedef void (*PinChangeCallback)(uint8_t pin, uint8_t value);
+
 class GPIOManager {
 public:
     void init();
+    void onChange(PinChangeCallback callback);
+    void update();
     void checkInputs();
     void setOutput(uint8_t pin, uint8_t value);
     uint8_t getInput(uint8_t pin);
+    uint8_t getOutput(uint8_t pin);
     void loadConfig();
     bool saveConfig(const std::vector<PinConfig>& configs);
+    // nullptr, если конфигурацию можно применить; иначе текст ошибки,
+    // номер пина - в badPin
+    const char* validateConfig(const std::vector<PinConfig>& configs, int& badPin);
     void saveStatesIfNeeded();
     std::vector<uint8_t> getAvailablePins();
-    std::vector<PinConfig> getPinConfigs();
+    std::vector<uint8_t> getAvailableAnalogPins();
+    const std::vector<PinConfig>& getPinConfigs();
     PinConfig* getPinConfig(uint8_t pin);
+    ExpanderStats getExpanderStats();
+    PinBitmaps getPinBitmaps();
     
 private:
     std::vector<PinConfig> pinConfigs;
     std::vector<PinState> pinStates;
-    uint8_t lastInputState[40] = {0};
-    unsigned long lastDebounceTime[40] = {0};
+    PinChangeCallback changeCallback = nullptr;
+    uint8_t lastInputState[PIN_COUNT] = {0};
+    uint8_t lastReading[PIN_COUNT] = {0};
+    unsigned long lastDebounceTime[PIN_COUNT] = {0};
+    
+    NativePinBackend nativePins;
+    Mcp23017Backend expander{Wire, EXPANDER_I2C_ADDRESS, EXPANDER_PIN_BASE, EXPANDER_INT_PIN};
     
+    void initExpander();
+    PinBackend* backendFor(uint8_t pin);
+    bool isExpanderBusPin(uint8_t pin);
     void configurePin(const PinConfig& config);
+    bool isPinAllowed(uint8_t pin);
     bool isPinAvailable(uint8_t pin);
+    bool isAnalogPin(uint8_t pin);
     void loadStates();
     void saveState(uint8_t pin, uint8_t value);
 };
@@ -0,0 +1,247 @@
+#include "logger.h"
+#include <FS.h>
+#include <LittleFS.h>
+#include <esp_ota_ops.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+
+#define LOG_FILE_MAGIC 0x31474F4C   // "LOG1"
+#define LOG_BUILD_ID_SIZE 16
+
+// Кольцевой буфер (ограниченная очередь Вьюкова): писатели резервируют
+// слот атомарным CAS, порядковый номер слота показывает, свободен ли он.
+// Читатель один - задача вывода.
+struct LogSlot {
+    std::atomic<uint32_t> sequence;
+    LogRecord record;
+};
+
+struct LogFileHeader {
+    uint32_t magic;
+    char build[LOG_BUILD_ID_SIZE];
+    uint16_t count;
+    uint16_t recordSize;
+};
+
+static_assert((LOG_RING_SIZE & (LOG_RING_SIZE - 1)) == 0, "LOG_RING_SIZE must be a power of two");
+
+static LogSlot ring[LOG_RING_SIZE];
+static std::atomic<uint32_t> enqueuePos{0};
+static uint32_t dequeuePos = 0;
+
+static QueueHandle_t streamQueue = nullptr;
+static SemaphoreHandle_t historyLock = nullptr;
+static char buildId[LOG_BUILD_ID_SIZE];
+
+const char* logLevelName(uint8_t level) {
+    switch (level) {
+        case LOG_LEVEL_ERROR: return "E";
+        case LOG_LEVEL_WARN:  return "W";
+        case LOG_LEVEL_INFO:  return "I";
+        case LOG_LEVEL_DEBUG: return "D";
+    }
+    return "?";
+}
+
+size_t logRender(const LogRecord& rec, char* buf, size_t size) {
+    const uint32_t* a = rec.args;
+    int len = snprintf(buf, size, rec.format, a[0], a[1], a[2], a[3], a[4], a[5]);
+    if (len < 0) {
+        buf[0] = '\0';
+        return 0;
+    }
+    return (size_t)len < size ? len : size - 1;
+}
+
+void Logger::init() {
+    for (uint32_t i = 0; i < LOG_RING_SIZE; i++) {
+        ring[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    streamQueue = xQueueCreate(LOG_WS_QUEUE_SIZE, sizeof(LogLine));
+    historyLock = xSemaphoreCreateMutex();
+
+    // Указатели на строки формата действительны только для той же прошивки
+    char sha[65] = {0};
+    esp_ota_get_app_elf_sha256(sha, sizeof(sha));
+    memcpy(buildId, sha, sizeof(buildId));
+
+    loadPersisted();
+
+    xTaskCreatePinnedToCore(taskEntry, "logger", LOG_TASK_STACK, this,
+                            LOG_TASK_PRIORITY, nullptr, LOG_TASK_CORE);
+}
+
+void Logger::record(uint8_t level, const char* format, const uint32_t* args, uint8_t argc) {
+    uint32_t pos = enqueuePos.load(std::memory_order_relaxed);
+    LogSlot* slot;
+
+    while (true) {
+        slot = &ring[pos & (LOG_RING_SIZE - 1)];
+        uint32_t sequence = slot->sequence.load(std::memory_order_acquire);
+        int32_t diff = (int32_t)(sequence - pos);
+        if (diff == 0) {
+            if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+        } else if (diff < 0) {
+            // Буфер полон: запись теряется, но не блокирует вызывающий код
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        } else {
+            pos = enqueuePos.load(std::memory_order_relaxed);
+        }
+    }
+
+    LogRecord& rec = slot->record;
+    rec.timestamp = millis();
+    rec.format = format;
+    rec.level = level;
+    rec.argc = argc;
+    memcpy(rec.args, args, argc * sizeof(uint32_t));
+    memset(rec.args + argc, 0, (LOG_MAX_ARGS - argc) * sizeof(uint32_t));
+
+    slot->sequence.store(pos + 1, std::memory_order_release);
+    written.fetch_add(1, std::memory_order_relaxed);
+}
+
+bool Logger::pop(LogRecord& out) {
+    LogSlot* slot = &ring[dequeuePos & (LOG_RING_SIZE - 1)];
+    uint32_t sequence = slot->sequence.load(std::memory_order_acquire);
+    if ((int32_t)(sequence - (dequeuePos + 1)) < 0) return false;
+
+    out = slot->record;
+    slot->sequence.store(dequeuePos + LOG_RING_SIZE, std::memory_order_release);
+    dequeuePos++;
+    return true;
+}
+
+void Logger::setStreamEnabled(bool enabled) {
+    streamEnabled.store(enabled, std::memory_order_relaxed);
+}
+
+bool Logger::readStreamLine(LogLine& out) {
+    return streamQueue && xQueueReceive(streamQueue, &out, 0) == pdTRUE;
+}
+
+LogStats Logger::getStats() {
+    LogStats stats;
+    stats.written = written.load(std::memory_order_relaxed);
+    stats.dropped = dropped.load(std::memory_order_relaxed);
+    stats.wsDropped = wsDropped.load(std::memory_order_relaxed);
+    stats.persisted = persisted;
+    return stats;
+}
+
+void Logger::renderHistory(bool previousBoot, std::function<void(uint32_t timestamp, uint8_t level, const char* line)> emit) {
+    char line[LOG_LINE_SIZE];
+
+    xSemaphoreTake(historyLock, portMAX_DELAY);
+    if (previousBoot) {
+        for (uint16_t i = 0; i < previousCount; i++) {
+            logRender(previous[i], line, sizeof(line));
+            emit(previous[i].timestamp, previous[i].level, line);
+        }
+    } else {
+        uint16_t start = (historyNext + LOG_PERSIST_RECORDS - historyCount) % LOG_PERSIST_RECORDS;
+        for (uint16_t i = 0; i < historyCount; i++) {
+            const LogRecord& rec = history[(start + i) % LOG_PERSIST_RECORDS];
+            logRender(rec, line, sizeof(line));
+            emit(rec.timestamp, rec.level, line);
+        }
+    }
+    xSemaphoreGive(historyLock);
+}
+
+void Logger::taskEntry(void* arg) {
+    Logger* self = static_cast<Logger*>(arg);
+    while (true) {
+        self->drain();
+        vTaskDelay(pdMS_TO_TICKS(LOG_DRAIN_INTERVAL));
+    }
+}
+
+void Logger::drain() {
+    LogRecord rec;
+    LogLine line;
+
+    while (pop(rec)) {
+        logRender(rec, line.text, sizeof(line.text));
+        Serial.printf("[%8lu] %s: %s\n", (unsigned long)rec.timestamp, logLevelName(rec.level), line.text);
+
+        if (streamEnabled.load(std::memory_order_relaxed)) {
+            line.timestamp = rec.timestamp;
+            line.level = rec.level;
+            if (xQueueSend(streamQueue, &line, 0) != pdTRUE) {
+                wsDropped.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+
+        addHistory(rec);
+    }
+
+    unsigned long now = millis();
+    if (historyDirty && now - lastPersist >= LOG_PERSIST_MIN_INTERVAL &&
+        (errorPending || now - lastPersist >= LOG_PERSIST_INTERVAL)) {
+        persist();
+        lastPersist = now;
+    }
+}
+
+void Logger::addHistory(const LogRecord& rec) {
+    xSemaphoreTake(historyLock, portMAX_DELAY);
+    history[historyNext] = rec;
+    historyNext = (historyNext + 1) % LOG_PERSIST_RECORDS;
+    if (historyCount < LOG_PERSIST_RECORDS) historyCount++;
+    xSemaphoreGive(historyLock);
+
+    historyDirty = true;
+    if (rec.level == LOG_LEVEL_ERROR) errorPending = true;
+}
+
+void Logger::loadPersisted() {
+    File file = LittleFS.open(LOG_PERSIST_FILE, "r");
+    if (!file) return;
+
+    LogFileHeader header;
+    bool valid = file.read((uint8_t*)&header, sizeof(header)) == sizeof(header) &&
+                 header.magic == LOG_FILE_MAGIC &&
+                 memcmp(header.build, buildId, sizeof(buildId)) == 0 &&
+                 header.recordSize == sizeof(LogRecord) &&
+                 header.count <= LOG_PERSIST_RECORDS;
+
+    if (valid) {
+        size_t bytes = header.count * sizeof(LogRecord);
+        if (file.read((uint8_t*)previous, bytes) == bytes) {
+            previousCount = header.count;
+        }
+    }
+    file.close();
+}
+
+void Logger::persist() {
+    // Записи сохраняются в хронологическом порядке
+    static LogRecord ordered[LOG_PERSIST_RECORDS];
+    LogFileHeader header;
+
+    xSemaphoreTake(historyLock, portMAX_DELAY);
+    uint16_t start = (historyNext + LOG_PERSIST_RECORDS - historyCount) % LOG_PERSIST_RECORDS;
+    for (uint16_t i = 0; i < historyCount; i++) {
+        ordered[i] = history[(start + i) % LOG_PERSIST_RECORDS];
+    }
+    header.count = historyCount;
+    xSemaphoreGive(historyLock);
+
+    header.magic = LOG_FILE_MAGIC;
+    memcpy(header.build, buildId, sizeof(header.build));
+    header.recordSize = sizeof(LogRecord);
+
+    File file = LittleFS.open(LOG_PERSIST_FILE, "w");
+    if (!file) return;
+    file.write((const uint8_t*)&header, sizeof(header));
+    file.write((const uint8_t*)ordered, header.count * sizeof(LogRecord));
+    file.close();
+
+    historyDirty = false;
+    errorPending = false;
+    persisted++;
+}
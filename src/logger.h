@@ -0,0 +1,139 @@
+#ifndef LOGGER_H
+#define LOGGER_H
+
+#include <Arduino.h>
+#include <atomic>
+#include <functional>
+#include <type_traits>
+#include "config.h"
+
+// Журнал пишет в кольцевой буфер двоичные записи: указатель на строку
+// формата (она лежит во flash и служит идентификатором) и до LOG_MAX_ARGS
+// целочисленных аргументов. Форматирование и вывод в Serial, WebSocket
+// и LittleFS выполняет отдельная задача с низким приоритетом.
+//
+// Аргументы - только целые числа, enum и bool: строки по указателю
+// к моменту вывода могут уже не существовать.
+//
+//   LOG_INFO("Pin %u changed to %u", pin, value);
+
+struct LogRecord {
+    uint32_t timestamp;
+    const char* format;
+    uint8_t level;
+    uint8_t argc;
+    uint32_t args[LOG_MAX_ARGS];
+};
+
+// Отформатированная строка для топика logs
+struct LogLine {
+    uint32_t timestamp;
+    uint8_t level;
+    char text[LOG_LINE_SIZE];
+};
+
+struct LogStats {
+    uint32_t written;
+    uint32_t dropped;           // Буфер был полон
+    uint32_t wsDropped;         // Очередь топика logs была полна
+    uint32_t persisted;
+};
+
+class Logger {
+public:
+    void init();
+    void record(uint8_t level, const char* format, const uint32_t* args, uint8_t argc);
+
+    // Для топика logs: строки, отформатированные задачей вывода
+    void setStreamEnabled(bool enabled);
+    bool readStreamLine(LogLine& out);
+
+    LogStats getStats();
+    // Последние записи текущей и предыдущей загрузки (для /api/logs)
+    void renderHistory(bool previousBoot, std::function<void(uint32_t timestamp, uint8_t level, const char* line)> emit);
+
+    template<typename... Args>
+    void write(uint8_t level, const char* format, Args... args) {
+        static_assert(sizeof...(Args) <= LOG_MAX_ARGS, "Too many log arguments");
+        uint32_t packed[sizeof...(Args) + 1] = {toArg(args)...};
+        record(level, format, packed, sizeof...(Args));
+    }
+
+private:
+    friend struct LoggerTest;       // test/test_logger: вывод без задачи
+
+    std::atomic<uint32_t> written{0};
+    std::atomic<uint32_t> dropped{0};
+    std::atomic<uint32_t> wsDropped{0};
+    std::atomic<bool> streamEnabled{false};
+    uint32_t persisted = 0;
+
+    // Последние записи; доступны только задаче вывода и под historyLock
+    LogRecord history[LOG_PERSIST_RECORDS];
+    uint16_t historyNext = 0;
+    uint16_t historyCount = 0;
+    LogRecord previous[LOG_PERSIST_RECORDS];
+    uint16_t previousCount = 0;
+    bool historyDirty = false;
+    bool errorPending = false;
+    unsigned long lastPersist = 0;
+
+    template<typename T>
+    static uint32_t toArg(T value) {
+        static_assert(std::is_integral<T>::value || std::is_enum<T>::value,
+                      "Log arguments must be integers");
+        // logRender передаёт в snprintf ровно LOG_MAX_ARGS слов по 32 бита:
+        // %lld занял бы два слота и сдвинул остальные аргументы
+        static_assert(sizeof(T) <= sizeof(uint32_t), "64-bit log arguments are not supported");
+        return (uint32_t)value;
+    }
+
+    bool pop(LogRecord& out);
+    void drain();
+    void addHistory(const LogRecord& rec);
+    void loadPersisted();
+    void persist();
+    static void taskEntry(void* arg);
+};
+
+extern Logger logger;
+
+const char* logLevelName(uint8_t level);
+size_t logRender(const LogRecord& rec, char* buf, size_t size);
+
+// Аргументы упаковываются в uint32_t, и компилятор не видит связи со
+// строкой формата. Вызов в мёртвой ветке возвращает проверку -Wformat,
+// кода не порождает.
+static inline void logCheckFormat(const char* format, ...) __attribute__((format(printf, 1, 2)));
+static inline void logCheckFormat(const char*, ...) {}
+
+#define LOG_AT(level, ...) do { \
+    if (0) logCheckFormat(__VA_ARGS__); \
+    logger.write(level, __VA_ARGS__); \
+} while (0)
+
+#if LOG_LEVEL >= LOG_LEVEL_ERROR
+#define LOG_ERROR(...) LOG_AT(LOG_LEVEL_ERROR, __VA_ARGS__)
+#else
+#define LOG_ERROR(...) do {} while (0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_WARN
+#define LOG_WARN(...) LOG_AT(LOG_LEVEL_WARN, __VA_ARGS__)
+#else
+#define LOG_WARN(...) do {} while (0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_INFO
+#define LOG_INFO(...) LOG_AT(LOG_LEVEL_INFO, __VA_ARGS__)
+#else
+#define LOG_INFO(...) do {} while (0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_DEBUG
+#define LOG_DEBUG(...) LOG_AT(LOG_LEVEL_DEBUG, __VA_ARGS__)
+#else
+#define LOG_DEBUG(...) do {} while (0)
+#endif
+
+#endif
@@ -9,26 +9,47 @@
 #include "config.h"
 #include "wifi_manager.h"
 #include "gpio_manager.h"
+#include "analog_sampler.h"
+#include "mqtt_manager.h"
+#include "modbus_server.h"
+#include "subscription_manager.h"
+#include "logger.h"
+#include "command_journal.h"
+#include "client_monitor.h"
+#include "fleet_announcer.h"
 #include "webserver_handler.h"
 
 // Глобальные объекты
 WiFiManager wifiManager;
 GPIOManager gpioManager;
+AnalogSampler analogSampler;
+MQTTManager mqttManager;
+ModbusServer modbusServer;
+SubscriptionManager subscriptionManager;
+Logger logger;
+CommandJournal commandJournal;
+ClientMonitor clientMonitor;
+FleetAnnouncer fleetAnnouncer;
 WebServer webServer(WEB_SERVER_PORT);
 WebSocketsServer webSocket(WEB_SOCKET_PORT);
 Preferences preferences;
 
+// Статистика основного цикла для телеметрии
+LoopStats loopStats;
+
 // Таймеры
 unsigned long lastDebounceCheck = 0;
 unsigned long lastReconnectAttempt = 0;
 unsigned long lastMemorySave = 0;
 unsigned long lastInputCheck = 0;
 
-// Функция для отправки состояния входа через WebSocket
-void sendInputState(uint8_t pin, uint8_t value) {
-    String json = "{\"pin\":" + String(pin) + ",\"val\":" + String(value) + "}";
-    webSocket.broadcastTXT(json);
-    Serial.printf("Broadcasting input state: %s\n", json.c_str());
+// Рассылка изменения состояния пина подписчикам WebSocket, в MQTT, Modbus и по UDP
+void onPinChange(uint8_t pin, uint8_t value) {
+    subscriptionManager.publishPinState(pin, value);
+    mqttManager.publishPinState(pin, value);
+    modbusServer.notifyChange(pin);
+    fleetAnnouncer.notifyChange();
+    LOG_INFO("Pin %u changed to %u", pin, value);
 }
 
 void setup() {
@@ -45,6 +66,9 @@ void setup() {
     }
     Serial.println("LittleFS mounted successfully");
     
+    // Журнал; записи предыдущей загрузки читаются из LittleFS
+    logger.init();
+    
     // Показываем файлы в LittleFS
     Serial.println("Files in LittleFS:");
     File root = LittleFS.open("/");
@@ -65,8 +89,18 @@ void setup() {
     wifiManager.init();
     
     // Инициализация GPIO
+    gpioManager.onChange(onPinChange);
     gpioManager.init();
     
+    // Инициализация MQTT
+    mqttManager.init();
+    
+    // Обнаружение в сети и поток состояний по UDP multicast
+    fleetAnnouncer.init();
+    
+    // Инициализация Modbus TCP
+    modbusServer.init();
+    
     // Инициализация веб-сервера
     initWebServer();
     
@@ -87,6 +121,7 @@ void setup() {
 
 void loop() {
     unsigned long currentMillis = millis();
+    uint32_t loopStart = micros();
     
     // Обслуживание WiFi
     wifiManager.handle(currentMillis);
@@ -97,27 +132,31 @@ void loop() {
     // Обслуживание веб-сервера
     webServer.handleClient();
     
-    // Проверка входов каждые 50мс
+    // Обслуживание MQTT
+    mqttManager.handle();
+    
+    // Команды записи Modbus и обновление снимка состояний
+    modbusServer.handle();
+    
+    // Обмен с расширителем: выходы, изменённые за этот проход, уходят одной
+    // транзакцией; входы читаются только по сигналу INT
+    gpioManager.update();
+    
+    // Проверка входов каждые 50мс; изменения рассылаются через onPinChange
     if (currentMillis - lastDebounceCheck >= DEBOUNCE_DELAY) {
         gpioManager.checkInputs();
-        
-        // Проверяем изменения входов вручную
-        auto pinConfigs = gpioManager.getPinConfigs();
-        for (const auto& config : pinConfigs) {
-            if (strcmp(config.type, "input") == 0) {
-                uint8_t currentState = digitalRead(config.pin);
-                static uint8_t lastStates[40] = {0};
-                
-                if (currentState != lastStates[config.pin]) {
-                    lastStates[config.pin] = currentState;
-                    sendInputState(config.pin, currentState);
-                }
-            }
-        }
-        
         lastDebounceCheck = currentMillis;
     }
     
+    // Отложенные обновления пинов и телеметрия для подписчиков
+    subscriptionManager.handle(currentMillis);
+    
+    // Замер RTT клиентов WebSocket
+    clientMonitor.handle(currentMillis);
+    
+    // Объявления и датаграммы состояния; изменения за проход уходят одной датаграммой
+    fleetAnnouncer.handle(currentMillis);
+    
     // Автосохранение состояний с памятью
     if (currentMillis - lastMemorySave >= SAVE_DELAY) {
         gpioManager.saveStatesIfNeeded();
@@ -127,8 +166,28 @@ void loop() {
     // Фоновое переподключение к WiFi
     if (WiFi.status() != WL_CONNECTED && 
         currentMillis - lastReconnectAttempt >= STA_RETRY_INTERVAL) {
-        Serial.println("Attempting WiFi reconnection...");
+        LOG_WARN("Attempting WiFi reconnection...");
         wifiManager.reconnectSTA();
         lastReconnectAttempt = currentMillis;
     }
+    
+    uint32_t loopMicros = micros() - loopStart;
+    loopStats.iterations++;
+    loopStats.totalMicros += loopMicros;
+    if (loopMicros > loopStats.maxMicros) {
+        loopStats.maxMicros = loopMicros;
+    }
+
+    // Окно закрывается по времени, а не при отправке телеметрии:
+    // без подписчиков накопители иначе переполнились бы
+    unsigned long window = currentMillis - loopStats.windowStart;
+    if (window >= LOOP_STATS_WINDOW) {
+        loopStats.rate = (uint64_t)loopStats.iterations * 1000 / window;
+        loopStats.avgMicros = loopStats.totalMicros / loopStats.iterations;
+        loopStats.lastMaxMicros = loopStats.maxMicros;
+        loopStats.iterations = 0;
+        loopStats.totalMicros = 0;
+        loopStats.maxMicros = 0;
+        loopStats.windowStart = currentMillis;
+    }
 }
\ No newline at end of file
@@ -0,0 +1,160 @@
+#include "mcp23017.h"
+
+// Адреса регистров при IOCON.BANK = 0: регистры портов A и B идут парами,
+// поэтому пару можно прочитать или записать одной транзакцией
+#define MCP_IODIRA   0x00
+#define MCP_IPOLA    0x02
+#define MCP_GPINTENA 0x04
+#define MCP_INTCONA  0x08
+#define MCP_IOCON    0x0A
+#define MCP_GPPUA    0x0C
+#define MCP_GPIOA    0x12
+#define MCP_OLATA    0x14
+
+#define MCP_IOCON_MIRROR 0x40   // INTA и INTB объединены
+
+Mcp23017Backend::Mcp23017Backend(TwoWire& wire, uint8_t address, uint8_t basePin, int8_t intPin)
+    : wire(wire), address(address), basePin(basePin), intPin(intPin) {
+}
+
+bool Mcp23017Backend::begin() {
+    present = false;
+    stats.present = false;
+
+    wire.beginTransmission(address);
+    if (wire.endTransmission() != 0) {
+        return false;
+    }
+
+    if (intPin >= 0) {
+        pinMode(intPin, INPUT_PULLUP);
+    }
+
+    // IOCON доступен по двум адресам, запись пары задаёт одно и то же значение.
+    // INT - двухтактный выход с активным нулём; прерывание по любому
+    // изменению входа, сбрасывается чтением GPIO.
+    bool ok = writeRegister16(MCP_IOCON, MCP_IOCON_MIRROR | (MCP_IOCON_MIRROR << 8)) &&
+              writeRegister16(MCP_OLATA, latch) &&
+              writeRegister16(MCP_IODIRA, direction) &&
+              writeRegister16(MCP_IPOLA, 0) &&
+              writeRegister16(MCP_GPPUA, pullups) &&
+              writeRegister16(MCP_INTCONA, 0) &&
+              writeRegister16(MCP_GPINTENA, interruptMask) &&
+              readRegister16(MCP_GPIOA, inputs);
+    if (!ok) return false;
+
+    present = true;
+    stats.present = true;
+    configDirty = false;
+    latchDirty = false;
+    return true;
+}
+
+bool Mcp23017Backend::isPresent() {
+    return present;
+}
+
+ExpanderStats Mcp23017Backend::getStats() {
+    return stats;
+}
+
+bool Mcp23017Backend::hasPin(uint8_t pin) {
+    return present && pin >= basePin && pin < basePin + EXPANDER_PIN_COUNT;
+}
+
+void Mcp23017Backend::setMode(uint8_t pin, uint8_t mode) {
+    uint16_t bit = 1 << (pin - basePin);
+    if (mode == OUTPUT) {
+        direction &= ~bit;
+        pullups &= ~bit;
+        interruptMask &= ~bit;
+    } else {
+        direction |= bit;
+        interruptMask |= bit;
+        if (mode == INPUT_PULLUP) {
+            pullups |= bit;
+        } else {
+            pullups &= ~bit;
+        }
+    }
+    configDirty = true;
+}
+
+uint8_t Mcp23017Backend::read(uint8_t pin) {
+    uint16_t bit = 1 << (pin - basePin);
+    uint16_t port = (direction & bit) ? inputs : latch;
+    return (port & bit) ? HIGH : LOW;
+}
+
+void Mcp23017Backend::write(uint8_t pin, uint8_t value) {
+    uint16_t bit = 1 << (pin - basePin);
+    uint16_t next = value ? (latch | bit) : (latch & ~bit);
+    if (next != latch) {
+        latch = next;
+        latchDirty = true;
+    }
+}
+
+void Mcp23017Backend::update(unsigned long currentMillis, bool force) {
+    if (!present) return;
+
+    // Защёлка записывается раньше направления, чтобы новый выход
+    // сразу получил нужный уровень
+    if (latchDirty && writeRegister16(MCP_OLATA, latch)) {
+        latchDirty = false;
+        stats.writes++;
+    }
+
+    if (configDirty) {
+        if (writeRegister16(MCP_IODIRA, direction) &&
+            writeRegister16(MCP_GPPUA, pullups) &&
+            writeRegister16(MCP_GPINTENA, interruptMask)) {
+            configDirty = false;
+        }
+        force = true;
+    }
+
+    bool due;
+    if (intPin >= 0) {
+        bool interrupt = interruptPending();
+        if (interrupt) stats.interrupts++;
+        due = interrupt || currentMillis - lastRead >= EXPANDER_RESYNC_INTERVAL;
+    } else {
+        due = currentMillis - lastRead >= EXPANDER_POLL_INTERVAL;
+    }
+
+    if ((force || due) && readRegister16(MCP_GPIOA, inputs)) {
+        lastRead = currentMillis;
+        stats.reads++;
+    }
+}
+
+bool Mcp23017Backend::interruptPending() {
+    // Уровень читается из регистра ESP32 без обращения к шине
+    return digitalRead(intPin) == LOW;
+}
+
+bool Mcp23017Backend::writeRegister16(uint8_t reg, uint16_t value) {
+    wire.beginTransmission(address);
+    wire.write(reg);
+    wire.write((uint8_t)(value & 0xFF));
+    wire.write((uint8_t)(value >> 8));
+    if (wire.endTransmission() != 0) {
+        stats.errors++;
+        return false;
+    }
+    return true;
+}
+
+bool Mcp23017Backend::readRegister16(uint8_t reg, uint16_t& value) {
+    wire.beginTransmission(address);
+    wire.write(reg);
+    if (wire.endTransmission(false) != 0 || wire.requestFrom(address, (uint8_t)2) != 2) {
+        stats.errors++;
+        return false;
+    }
+    uint8_t low = wire.read();
+    uint8_t high = wire.read();
+    value = low | (high << 8);
+    return true;
+}
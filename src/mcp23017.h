@@ -0,0 +1,60 @@
+#ifndef MCP23017_H
+#define MCP23017_H
+
+#include <Arduino.h>
+#include <Wire.h>
+#include "pin_backend.h"
+
+// Расширитель MCP23017: 16 пинов, порты A и B.
+// Виртуальный пин basePin + n соответствует GPAn (n < 8) или GPB(n - 8).
+// Входы читаются одной транзакцией GPIOA+GPIOB, когда линия INT опущена
+// (или по таймеру, если линия не подключена); выходы записываются одной
+// транзакцией OLATA+OLATB, если защёлка изменилась.
+
+struct ExpanderStats {
+    bool present;
+    uint32_t reads;         // Транзакций чтения портов
+    uint32_t writes;        // Транзакций записи защёлок
+    uint32_t errors;        // Ошибок шины
+    uint32_t interrupts;    // Чтений по сигналу INT
+};
+
+class Mcp23017Backend : public PinBackend {
+public:
+    Mcp23017Backend(TwoWire& wire, uint8_t address, uint8_t basePin, int8_t intPin);
+
+    bool begin();
+    bool isPresent();
+    ExpanderStats getStats();
+
+    bool hasPin(uint8_t pin) override;
+    void setMode(uint8_t pin, uint8_t mode) override;
+    uint8_t read(uint8_t pin) override;
+    void write(uint8_t pin, uint8_t value) override;
+    void update(unsigned long currentMillis, bool force) override;
+
+private:
+    TwoWire& wire;
+    uint8_t address;
+    uint8_t basePin;
+    int8_t intPin;
+    bool present = false;
+
+    // Теневые копии регистров (бит n: GPA0..7, затем GPB0..7)
+    uint16_t direction = 0xFFFF;    // IODIR: 1 - вход
+    uint16_t pullups = 0;           // GPPU
+    uint16_t latch = 0;             // OLAT
+    uint16_t inputs = 0;            // Последнее прочитанное GPIO
+    uint16_t interruptMask = 0;     // GPINTEN: только настроенные входы
+    bool configDirty = false;
+    bool latchDirty = false;
+    unsigned long lastRead = 0;
+
+    ExpanderStats stats = {};
+
+    bool writeRegister16(uint8_t reg, uint16_t value);
+    bool readRegister16(uint8_t reg, uint16_t& value);
+    bool interruptPending();
+};
+
+#endif
@@ -0,0 +1,365 @@
+#include "modbus_server.h"
+#include <WiFi.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/task.h>
+#include "gpio_manager.h"
+
+extern GPIOManager gpioManager;
+
+// Коды функций Modbus
+#define MB_READ_COILS               0x01
+#define MB_READ_DISCRETE_INPUTS     0x02
+#define MB_READ_HOLDING_REGISTERS   0x03
+#define MB_READ_INPUT_REGISTERS     0x04
+#define MB_WRITE_SINGLE_COIL        0x05
+#define MB_WRITE_SINGLE_REGISTER    0x06
+#define MB_WRITE_MULTIPLE_COILS     0x0F
+#define MB_WRITE_MULTIPLE_REGISTERS 0x10
+
+// Коды исключений
+#define MB_EX_ILLEGAL_FUNCTION      0x01
+#define MB_EX_ILLEGAL_ADDRESS       0x02
+#define MB_EX_ILLEGAL_VALUE         0x03
+#define MB_EX_DEVICE_BUSY           0x06
+
+#define MB_MBAP_SIZE 7
+#define MB_ADU_MAX 260
+
+// Одна команда записи на запрос: диапазон адресов и их уровни (бит i -
+// адрес first + i), поэтому FC15/FC16 занимают в очереди одно место
+struct ModbusWrite {
+    uint8_t first;
+    uint8_t count;
+    uint64_t bits;
+};
+static_assert(MODBUS_ADDRESS_COUNT <= 64, "ModbusWrite.bits must cover the address range");
+
+struct ModbusClient {
+    WiFiClient client;
+    uint8_t buf[MB_ADU_MAX];
+    size_t len;
+    unsigned long lastActivity;
+};
+
+static WiFiServer modbusListener(MODBUS_TCP_PORT);
+static ModbusClient modbusClients[MODBUS_MAX_CLIENTS];
+static QueueHandle_t writeQueue = nullptr;
+
+static inline uint16_t readU16(const uint8_t* p) {
+    return ((uint16_t)p[0] << 8) | p[1];
+}
+
+static inline void writeU16(uint8_t* p, uint16_t value) {
+    p[0] = value >> 8;
+    p[1] = value & 0xFF;
+}
+
+static size_t exceptionResponse(uint8_t function, uint8_t code, uint8_t* response) {
+    response[0] = function | 0x80;
+    response[1] = code;
+    return 2;
+}
+
+void ModbusServer::init() {
+    writeQueue = xQueueCreate(MODBUS_WRITE_QUEUE_SIZE, sizeof(ModbusWrite));
+    publishSnapshot();
+
+    modbusListener.begin();
+    modbusListener.setNoDelay(true);
+
+    // Сетевой обмен идёт в отдельной задаче, чтобы опрос не задерживал loop()
+    xTaskCreatePinnedToCore(taskEntry, "modbus", MODBUS_TASK_STACK, this,
+                            MODBUS_TASK_PRIORITY, nullptr, MODBUS_TASK_CORE);
+    Serial.printf("Modbus TCP server started on port %d\n", MODBUS_TCP_PORT);
+}
+
+void ModbusServer::handle() {
+    // Команды записи выполняются здесь, в основном цикле
+    ModbusWrite write;
+    while (writeQueue && xQueueReceive(writeQueue, &write, 0) == pdTRUE) {
+        for (uint8_t i = 0; i < write.count; i++) {
+            uint8_t pin = write.first + i;
+            PinConfig* config = gpioManager.getPinConfig(pin);
+            if (config && config->enabled && strcmp(config->type, "output") == 0) {
+                gpioManager.setOutput(pin, (write.bits >> i) & 1);
+            }
+        }
+    }
+
+    if (dirty) {
+        publishSnapshot();
+    }
+}
+
+void ModbusServer::notifyChange(uint8_t pin) {
+    if (pin < MODBUS_ADDRESS_COUNT) {
+        changeCounters[pin]++;
+    }
+    dirty = true;
+}
+
+void ModbusServer::invalidate() {
+    dirty = true;
+}
+
+uint32_t ModbusServer::getRequestCount() {
+    return requestCount.load(std::memory_order_relaxed);
+}
+
+void ModbusServer::publishSnapshot() {
+    ModbusSnapshot next = {};
+
+    for (const auto& config : gpioManager.getPinConfigs()) {
+        if (!config.enabled || config.pin >= MODBUS_ADDRESS_COUNT) continue;
+
+        uint64_t bit = 1ULL << config.pin;
+        uint8_t value;
+        if (strcmp(config.type, "output") == 0) {
+            next.outputMask |= bit;
+            value = gpioManager.getOutput(config.pin);
+        } else if (strcmp(config.type, "input") == 0 || strcmp(config.type, "analog") == 0) {
+            // Для аналогового входа - состояние по порогам
+            next.inputMask |= bit;
+            value = gpioManager.getInput(config.pin);
+        } else {
+            continue;
+        }
+        next.values[config.pin] = value;
+        if (value) next.bits |= bit;
+    }
+    memcpy(next.changes, changeCounters, sizeof(next.changes));
+
+    uint32_t s = seq.load(std::memory_order_relaxed);
+    seq.store(s + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    memcpy(&snapshot, &next, sizeof(snapshot));
+    seq.store(s + 2, std::memory_order_release);
+
+    dirty = false;
+}
+
+void ModbusServer::readSnapshot(ModbusSnapshot& out) {
+    uint32_t before, after;
+    do {
+        before = seq.load(std::memory_order_acquire);
+        memcpy(&out, &snapshot, sizeof(out));
+        std::atomic_thread_fence(std::memory_order_acquire);
+        after = seq.load(std::memory_order_relaxed);
+    } while ((before & 1) || before != after);
+}
+
+bool ModbusServer::queueWrite(uint8_t first, uint8_t count, uint64_t bits) {
+    ModbusWrite write = {first, count, bits};
+    return xQueueSend(writeQueue, &write, 0) == pdTRUE;
+}
+
+size_t ModbusServer::processRequest(const uint8_t* request, size_t length, uint8_t* response) {
+    // MBAP: transaction id, protocol id, length, unit id
+    if (readU16(request + 2) != 0) return 0;
+
+    size_t pduLength = processPdu(request + MB_MBAP_SIZE, length - MB_MBAP_SIZE, response + MB_MBAP_SIZE);
+    if (pduLength == 0) return 0;
+
+    memcpy(response, request, 4);
+    writeU16(response + 4, pduLength + 1);
+    response[6] = request[6];
+    requestCount.fetch_add(1, std::memory_order_relaxed);
+    return MB_MBAP_SIZE + pduLength;
+}
+
+size_t ModbusServer::processPdu(const uint8_t* pdu, size_t length, uint8_t* response) {
+    uint8_t function = pdu[0];
+    if (length < 5) {
+        return exceptionResponse(function, MB_EX_ILLEGAL_VALUE, response);
+    }
+
+    uint16_t address = readU16(pdu + 1);
+    uint16_t quantity = readU16(pdu + 3);
+
+    ModbusSnapshot snap;
+    readSnapshot(snap);
+
+    switch (function) {
+        case MB_READ_COILS:
+        case MB_READ_DISCRETE_INPUTS: {
+            if (quantity == 0 || quantity > 2000) {
+                return exceptionResponse(function, MB_EX_ILLEGAL_VALUE, response);
+            }
+            if (address + quantity > MODBUS_ADDRESS_COUNT) {
+                return exceptionResponse(function, MB_EX_ILLEGAL_ADDRESS, response);
+            }
+            uint64_t mask = function == MB_READ_COILS ? snap.outputMask : snap.inputMask;
+            uint64_t bits = (snap.bits & mask) >> address;
+            uint8_t byteCount = (quantity + 7) / 8;
+
+            response[0] = function;
+            response[1] = byteCount;
+            for (uint8_t i = 0; i < byteCount; i++) {
+                response[2 + i] = (bits >> (i * 8)) & 0xFF;
+            }
+            // Лишние биты последнего байта должны быть нулевыми
+            if (quantity % 8) {
+                response[1 + byteCount] &= (1 << (quantity % 8)) - 1;
+            }
+            return 2 + byteCount;
+        }
+
+        case MB_READ_HOLDING_REGISTERS:
+        case MB_READ_INPUT_REGISTERS: {
+            if (quantity == 0 || quantity > 125) {
+                return exceptionResponse(function, MB_EX_ILLEGAL_VALUE, response);
+            }
+            if (address + quantity > MODBUS_ADDRESS_COUNT) {
+                return exceptionResponse(function, MB_EX_ILLEGAL_ADDRESS, response);
+            }
+            response[0] = function;
+            response[1] = quantity * 2;
+            for (uint16_t i = 0; i < quantity; i++) {
+                uint16_t pin = address + i;
+                uint16_t value = 0;
+                if (function == MB_READ_INPUT_REGISTERS) {
+                    value = snap.changes[pin];
+                } else if (snap.outputMask & (1ULL << pin)) {
+                    value = snap.values[pin];
+                }
+                writeU16(response + 2 + i * 2, value);
+            }
+            return 2 + quantity * 2;
+        }
+
+        case MB_WRITE_SINGLE_COIL:
+        case MB_WRITE_SINGLE_REGISTER: {
+            // Для одиночной записи второе поле - значение, а не количество
+            uint16_t value = quantity;
+            if (address >= MODBUS_ADDRESS_COUNT || !(snap.outputMask & (1ULL << address))) {
+                return exceptionResponse(function, MB_EX_ILLEGAL_ADDRESS, response);
+            }
+            uint8_t pinValue;
+            if (function == MB_WRITE_SINGLE_COIL) {
+                if (value != 0xFF00 && value != 0x0000) {
+                    return exceptionResponse(function, MB_EX_ILLEGAL_VALUE, response);
+                }
+                pinValue = value ? HIGH : LOW;
+            } else {
+                if (value > 1) {
+                    return exceptionResponse(function, MB_EX_ILLEGAL_VALUE, response);
+                }
+                pinValue = value;
+            }
+            if (!queueWrite(address, 1, pinValue)) {
+                return exceptionResponse(function, MB_EX_DEVICE_BUSY, response);
+            }
+            memcpy(response, pdu, 5);
+            return 5;
+        }
+
+        case MB_WRITE_MULTIPLE_COILS:
+        case MB_WRITE_MULTIPLE_REGISTERS: {
+            if (length < 6) {
+                return exceptionResponse(function, MB_EX_ILLEGAL_VALUE, response);
+            }
+            uint8_t byteCount = pdu[5];
+            bool coils = function == MB_WRITE_MULTIPLE_COILS;
+            size_t expected = coils ? (quantity + 7) / 8 : quantity * 2;
+            if (quantity == 0 || quantity > (coils ? 1968 : 123) ||
+                byteCount != expected || length < 6 + expected) {
+                return exceptionResponse(function, MB_EX_ILLEGAL_VALUE, response);
+            }
+            if (address + quantity > MODBUS_ADDRESS_COUNT) {
+                return exceptionResponse(function, MB_EX_ILLEGAL_ADDRESS, response);
+            }
+
+            // Запрос выполняется целиком или отклоняется целиком:
+            // весь диапазон уходит в основной цикл одной командой
+            const uint8_t* data = pdu + 6;
+            uint64_t bits = 0;
+            for (uint16_t i = 0; i < quantity; i++) {
+                if (!(snap.outputMask & (1ULL << (address + i)))) {
+                    return exceptionResponse(function, MB_EX_ILLEGAL_ADDRESS, response);
+                }
+                uint16_t value = coils ? (data[i / 8] >> (i % 8)) & 1 : readU16(data + i * 2);
+                if (value > 1) {
+                    return exceptionResponse(function, MB_EX_ILLEGAL_VALUE, response);
+                }
+                if (value) bits |= 1ULL << i;
+            }
+            if (!queueWrite(address, quantity, bits)) {
+                return exceptionResponse(function, MB_EX_DEVICE_BUSY, response);
+            }
+            memcpy(response, pdu, 5);
+            return 5;
+        }
+
+        default:
+            return exceptionResponse(function, MB_EX_ILLEGAL_FUNCTION, response);
+    }
+}
+
+void ModbusServer::taskEntry(void* arg) {
+    static_cast<ModbusServer*>(arg)->taskLoop();
+}
+
+void ModbusServer::taskLoop() {
+    uint8_t response[MB_ADU_MAX];
+
+    while (true) {
+        // Новые подключения
+        WiFiClient incoming = modbusListener.available();
+        if (incoming) {
+            ModbusClient* slot = nullptr;
+            for (auto& mc : modbusClients) {
+                if (!mc.client.connected()) {
+                    slot = &mc;
+                    break;
+                }
+            }
+            if (slot) {
+                slot->client.stop();
+                slot->client = incoming;
+                slot->client.setNoDelay(true);
+                slot->len = 0;
+                slot->lastActivity = millis();
+            } else {
+                incoming.stop();
+            }
+        }
+
+        for (auto& mc : modbusClients) {
+            if (!mc.client.connected()) continue;
+
+            int available = mc.client.available();
+            if (available > 0) {
+                size_t room = sizeof(mc.buf) - mc.len;
+                int received = mc.client.read(mc.buf + mc.len, min((size_t)available, room));
+                if (received > 0) {
+                    mc.len += received;
+                }
+                mc.lastActivity = millis();
+            } else if (millis() - mc.lastActivity > MODBUS_CLIENT_TIMEOUT) {
+                mc.client.stop();
+                continue;
+            }
+
+            // Разбор всех полных кадров в буфере
+            while (mc.len >= MB_MBAP_SIZE + 1) {
+                size_t frameLength = 6 + readU16(mc.buf + 4);
+                if (frameLength < MB_MBAP_SIZE + 1 || frameLength > MB_ADU_MAX) {
+                    mc.client.stop();
+                    mc.len = 0;
+                    break;
+                }
+                if (mc.len < frameLength) break;
+
+                size_t responseLength = processRequest(mc.buf, frameLength, response);
+                if (responseLength > 0) {
+                    mc.client.write(response, responseLength);
+                }
+                mc.len -= frameLength;
+                memmove(mc.buf, mc.buf + frameLength, mc.len);
+            }
+        }
+
+        vTaskDelay(1);
+    }
+}
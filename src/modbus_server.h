@@ -0,0 +1,55 @@
+#ifndef MODBUS_SERVER_H
+#define MODBUS_SERVER_H
+
+#include <Arduino.h>
+#include <atomic>
+#include "config.h"
+
+// Карта адресов Modbus (адрес = номер пина: 0..39 - GPIO, далее расширитель):
+//   Coils (01/05/15)             - выходы
+//   Discrete Inputs (02)         - входы; для аналоговых - состояние по порогам
+//   Holding Registers (03/06/16) - уровень выхода (0/1, другие значения отклоняются)
+//   Input Registers (04)         - счётчик изменений пина
+// Адреса ненастроенных пинов читаются как 0, запись в них отклоняется.
+
+#define MODBUS_ADDRESS_COUNT PIN_COUNT
+
+// Снимок состояния пинов, который читает задача Modbus
+struct ModbusSnapshot {
+    uint64_t outputMask;
+    uint64_t inputMask;
+    uint64_t bits;                          // Текущие значения (0/1)
+    uint8_t values[MODBUS_ADDRESS_COUNT];
+    uint16_t changes[MODBUS_ADDRESS_COUNT];
+};
+
+class ModbusServer {
+public:
+    void init();
+    void handle();
+    void notifyChange(uint8_t pin);
+    void invalidate();
+    uint32_t getRequestCount();
+
+private:
+    friend struct ModbusServerTest;     // test/test_modbus: разбор PDU без сети
+
+    // Seqlock: основной цикл пишет снимок, задача Modbus читает без блокировок.
+    // Нечётное значение seq означает, что идёт запись.
+    ModbusSnapshot snapshot = {};
+    std::atomic<uint32_t> seq{0};
+    std::atomic<uint32_t> requestCount{0};
+    uint16_t changeCounters[MODBUS_ADDRESS_COUNT] = {0};
+    bool dirty = true;
+
+    void publishSnapshot();
+    void readSnapshot(ModbusSnapshot& out);
+    size_t processRequest(const uint8_t* request, size_t length, uint8_t* response);
+    size_t processPdu(const uint8_t* pdu, size_t length, uint8_t* response);
+    bool queueWrite(uint8_t first, uint8_t count, uint64_t bits);
+
+    static void taskEntry(void* arg);
+    void taskLoop();
+};
+
+#endif
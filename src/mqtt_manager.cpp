@@ -0,0 +1,341 @@
+#include "mqtt_manager.h"
+#include <WiFi.h>
+#include <PubSubClient.h>
+#include <Preferences.h>
+#include <ArduinoJson.h>
+#include <freertos/queue.h>
+#include <freertos/task.h>
+#include "gpio_manager.h"
+#include "logger.h"
+
+extern Preferences preferences;
+extern GPIOManager gpioManager;
+
+// Команда из топика <base>/pin/<N>/set для основного цикла
+struct MqttCommand {
+    uint8_t pin;
+    uint8_t value;
+};
+
+static WiFiClient mqttNet;
+static PubSubClient mqttClient(mqttNet);
+static QueueHandle_t commandQueue = nullptr;
+
+void MQTTManager::init() {
+    MQTTConfig config;
+    if (!loadConfig(config)) {
+        config.enabled = false;
+        config.host[0] = '\0';
+        config.port = MQTT_DEFAULT_PORT;
+        config.user[0] = '\0';
+        config.password[0] = '\0';
+        strlcpy(config.base_topic, MQTT_DEFAULT_BASE_TOPIC, sizeof(config.base_topic));
+    }
+
+    bool first = lock == nullptr;
+    if (first) {
+        lock = xSemaphoreCreateMutex();
+        commandQueue = xQueueCreate(MQTT_COMMAND_QUEUE_SIZE, sizeof(MqttCommand));
+        stats.retryInterval = MQTT_RECONNECT_INTERVAL;
+    }
+    applyConfig(config);
+
+    if (first) {
+        xTaskCreatePinnedToCore(taskEntry, "mqtt", MQTT_TASK_STACK, this,
+                                MQTT_TASK_PRIORITY, nullptr, MQTT_TASK_CORE);
+    }
+}
+
+void MQTTManager::applyConfig(const MQTTConfig& config) {
+    // Задача подхватит новые настройки на следующем проходе
+    xSemaphoreTake(lock, portMAX_DELAY);
+    mqttConfig = config;
+    xSemaphoreGive(lock);
+    configChanged = true;
+
+    if (mqttConfig.enabled) {
+        Serial.printf("MQTT broker: %s:%u, topic: %s\n",
+            mqttConfig.host, mqttConfig.port, mqttConfig.base_topic);
+    }
+}
+
+void MQTTManager::handle() {
+    // Команды /set выполняются здесь, в основном цикле
+    MqttCommand command;
+    while (commandQueue && xQueueReceive(commandQueue, &command, 0) == pdTRUE) {
+        PinConfig* config = gpioManager.getPinConfig(command.pin);
+        if (config && config->enabled && strcmp(config->type, "output") == 0) {
+            gpioManager.setOutput(command.pin, command.value);
+        }
+    }
+
+    // После (пере)подключения обновляем retained-состояния всех пинов
+    if (resyncRequested.exchange(false)) {
+        queueAllStates();
+    }
+}
+
+void MQTTManager::publishPinState(uint8_t pin, uint8_t value) {
+    if (pin >= PIN_COUNT || !lock) return;
+
+    xSemaphoreTake(lock, portMAX_DELAY);
+    uint64_t bit = 1ULL << pin;
+    if (pendingMask & bit) {
+        stats.coalesced++;
+    } else {
+        pendingMask |= bit;
+        pendingSince[pin] = millis();
+    }
+    pendingValue[pin] = value;
+
+    stats.queueDepth = __builtin_popcountll(pendingMask);
+    if (stats.queueDepth > stats.maxQueueDepth) {
+        stats.maxQueueDepth = stats.queueDepth;
+    }
+    xSemaphoreGive(lock);
+}
+
+bool MQTTManager::isConnected() {
+    return connected;
+}
+
+const MQTTConfig& MQTTManager::getConfig() {
+    return mqttConfig;
+}
+
+MQTTStats MQTTManager::getStats() {
+    if (!lock) return stats;
+    xSemaphoreTake(lock, portMAX_DELAY);
+    MQTTStats copy = stats;
+    xSemaphoreGive(lock);
+    return copy;
+}
+
+void MQTTManager::taskEntry(void* arg) {
+    static_cast<MQTTManager*>(arg)->taskLoop();
+}
+
+void MQTTManager::taskLoop() {
+    unsigned long lastAttempt = 0;
+    bool attempted = false;
+    uint32_t retryInterval = MQTT_RECONNECT_INTERVAL;
+
+    mqttClient.setSocketTimeout(MQTT_SOCKET_TIMEOUT);
+    mqttClient.setCallback([this](char* topic, uint8_t* payload, unsigned int length) {
+        handleMessage(topic, payload, length);
+    });
+
+    while (true) {
+        if (configChanged.exchange(false)) {
+            if (mqttClient.connected()) {
+                mqttClient.disconnect();
+            }
+            xSemaphoreTake(lock, portMAX_DELAY);
+            taskConfig = mqttConfig;
+            xSemaphoreGive(lock);
+            mqttClient.setServer(taskConfig.host, taskConfig.port);
+            attempted = false;
+            retryInterval = MQTT_RECONNECT_INTERVAL;
+        }
+
+        if (!taskConfig.enabled || taskConfig.host[0] == '\0') {
+            connected = false;
+            vTaskDelay(pdMS_TO_TICKS(MQTT_TASK_INTERVAL));
+            continue;
+        }
+
+        if (!mqttClient.connected()) {
+            // Пока брокер недоступен, события копятся в очереди
+            connected = false;
+            unsigned long now = millis();
+            if (WiFi.status() != WL_CONNECTED || (attempted && now - lastAttempt < retryInterval)) {
+                vTaskDelay(pdMS_TO_TICKS(MQTT_TASK_INTERVAL));
+                continue;
+            }
+            // Первая попытка после обрыва - сразу, затем пауза удваивается
+            if (attempted) {
+                retryInterval = retryInterval * 2 > MQTT_RECONNECT_MAX_INTERVAL
+                              ? MQTT_RECONNECT_MAX_INTERVAL : retryInterval * 2;
+            }
+            attempted = true;
+            lastAttempt = now;
+            bool ok = connect();
+            if (ok) {
+                attempted = false;
+                retryInterval = MQTT_RECONNECT_INTERVAL;
+            }
+            xSemaphoreTake(lock, portMAX_DELAY);
+            stats.retryInterval = retryInterval;
+            xSemaphoreGive(lock);
+            if (!ok) continue;
+        }
+
+        flushPending();
+        mqttClient.loop();
+        vTaskDelay(pdMS_TO_TICKS(MQTT_TASK_INTERVAL));
+    }
+}
+
+bool MQTTManager::connect() {
+    char clientId[32];
+    snprintf(clientId, sizeof(clientId), "esp32gpio-%06lx", (unsigned long)(ESP.getEfuseMac() >> 24) & 0xFFFFFF);
+
+    char willTopic[MQTT_TOPIC_SIZE];
+    snprintf(willTopic, sizeof(willTopic), "%s/status", taskConfig.base_topic);
+
+    const char* user = taskConfig.user[0] ? taskConfig.user : nullptr;
+    const char* password = taskConfig.user[0] ? taskConfig.password : nullptr;
+
+    if (!mqttClient.connect(clientId, user, password, willTopic, 1, true, "offline")) {
+        LOG_WARN("MQTT connection failed, state %d", mqttClient.state());
+        return false;
+    }
+
+    xSemaphoreTake(lock, portMAX_DELAY);
+    stats.connects++;
+    xSemaphoreGive(lock);
+    LOG_INFO("MQTT connected");
+
+    mqttClient.publish(willTopic, "online", true);
+
+    char commandTopic[MQTT_TOPIC_SIZE];
+    snprintf(commandTopic, sizeof(commandTopic), "%s/pin/+/set", taskConfig.base_topic);
+    mqttClient.subscribe(commandTopic);
+
+    connected = true;
+    resyncRequested = true;
+    return true;
+}
+
+void MQTTManager::queueAllStates() {
+    for (const auto& config : gpioManager.getPinConfigs()) {
+        if (!config.enabled) continue;
+        if (strcmp(config.type, "output") == 0) {
+            publishPinState(config.pin, gpioManager.getOutput(config.pin));
+        } else if (strcmp(config.type, "input") == 0 || strcmp(config.type, "analog") == 0) {
+            publishPinState(config.pin, gpioManager.getInput(config.pin));
+        }
+    }
+}
+
+void MQTTManager::flushPending() {
+    char topic[MQTT_TOPIC_SIZE];
+    char payload[4];
+
+    for (uint8_t sent = 0; sent < MQTT_PUBLISH_BATCH; sent++) {
+        // Событие забирается из очереди до публикации; блокировка
+        // на время сетевого обмена не удерживается
+        xSemaphoreTake(lock, portMAX_DELAY);
+        if (!pendingMask) {
+            xSemaphoreGive(lock);
+            break;
+        }
+        uint8_t pin = __builtin_ctzll(pendingMask);
+        uint64_t bit = 1ULL << pin;
+        uint8_t value = pendingValue[pin];
+        unsigned long since = pendingSince[pin];
+        pendingMask &= ~bit;
+        xSemaphoreGive(lock);
+
+        snprintf(topic, sizeof(topic), "%s/pin/%u/state", taskConfig.base_topic, pin);
+        snprintf(payload, sizeof(payload), "%u", value);
+        bool ok = mqttClient.publish(topic, payload, true);
+        uint32_t latency = millis() - since;
+
+        xSemaphoreTake(lock, portMAX_DELAY);
+        if (!ok) {
+            // Событие возвращается в очередь, если его не заменило более новое
+            stats.failed++;
+            if (!(pendingMask & bit)) {
+                pendingMask |= bit;
+                pendingValue[pin] = value;
+            }
+            pendingSince[pin] = since;
+        } else {
+            stats.lastLatency = latency;
+            if (latency > stats.maxLatency) stats.maxLatency = latency;
+            avgLatencyScaled = stats.published == 0 ? latency << 3
+                             : avgLatencyScaled - (avgLatencyScaled >> 3) + latency;
+            stats.avgLatency = (avgLatencyScaled + 4) >> 3;
+            stats.published++;
+        }
+        stats.queueDepth = __builtin_popcountll(pendingMask);
+        xSemaphoreGive(lock);
+
+        if (!ok) break;
+    }
+}
+
+void MQTTManager::handleMessage(char* topic, uint8_t* payload, unsigned int length) {
+    // Ожидаемый топик: <base>/pin/<N>/set. Вызывается из задачи MQTT,
+    // поэтому команда передаётся в основной цикл через очередь
+    size_t baseLen = strlen(taskConfig.base_topic);
+    if (strncmp(topic, taskConfig.base_topic, baseLen) != 0 ||
+        strncmp(topic + baseLen, "/pin/", 5) != 0) {
+        return;
+    }
+
+    char* end;
+    long pin = strtol(topic + baseLen + 5, &end, 10);
+    if (end == topic + baseLen + 5 || strcmp(end, "/set") != 0 || pin < 0 || pin >= PIN_COUNT) {
+        return;
+    }
+
+    char value[8];
+    if (length == 0 || length >= sizeof(value)) return;
+    memcpy(value, payload, length);
+    value[length] = '\0';
+
+    MqttCommand command;
+    command.pin = pin;
+    if (strcasecmp(value, "on") == 0 || strcasecmp(value, "true") == 0) {
+        command.value = HIGH;
+    } else if (strcasecmp(value, "off") == 0 || strcasecmp(value, "false") == 0) {
+        command.value = LOW;
+    } else {
+        long parsed = strtol(value, &end, 10);
+        if (*end != '\0' || parsed < 0 || parsed > 1) return;
+        command.value = parsed;
+    }
+
+    if (xQueueSend(commandQueue, &command, 0) != pdTRUE) {
+        LOG_WARN("MQTT command queue full, pin %d dropped", command.pin);
+    }
+}
+
+bool MQTTManager::loadConfig(MQTTConfig& config) {
+    String jsonStr = preferences.getString(NVS_MQTT_KEY, "");
+    if (jsonStr.length() == 0) return false;
+
+    StaticJsonDocument<512> doc;
+    DeserializationError error = deserializeJson(doc, jsonStr);
+    if (error) return false;
+
+    config.enabled = doc["enabled"] | false;
+    strlcpy(config.host, doc["host"] | "", sizeof(config.host));
+    config.port = doc["port"] | MQTT_DEFAULT_PORT;
+    strlcpy(config.user, doc["user"] | "", sizeof(config.user));
+    strlcpy(config.password, doc["password"] | "", sizeof(config.password));
+    strlcpy(config.base_topic, doc["base_topic"] | MQTT_DEFAULT_BASE_TOPIC, sizeof(config.base_topic));
+
+    return true;
+}
+
+bool MQTTManager::saveMQTTConfig(MQTTConfig& config) {
+    StaticJsonDocument<512> doc;
+    doc["enabled"] = config.enabled;
+    doc["host"] = config.host;
+    doc["port"] = config.port;
+    doc["user"] = config.user;
+    doc["password"] = config.password;
+    doc["base_topic"] = config.base_topic;
+
+    String jsonStr;
+    serializeJson(doc, jsonStr);
+
+    if (preferences.putString(NVS_MQTT_KEY, jsonStr) == 0) return false;
+
+    // Применяем новые настройки без перезагрузки
+    applyConfig(config);
+    return true;
+}
@@ -0,0 +1,66 @@
+#ifndef MQTT_MANAGER_H
+#define MQTT_MANAGER_H
+
+#include <Arduino.h>
+#include <atomic>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include "config.h"
+
+struct MQTTStats {
+    uint32_t published;
+    uint32_t failed;
+    uint32_t coalesced;       // События, заменённые более новыми до публикации
+    uint32_t connects;
+    uint16_t queueDepth;
+    uint16_t maxQueueDepth;
+    uint32_t lastLatency;     // мс от события до публикации
+    uint32_t maxLatency;
+    uint32_t avgLatency;      // Скользящее среднее (1/8)
+    uint32_t retryInterval;   // Текущая пауза между попытками подключения (мс)
+};
+
+// Подключение к брокеру и публикации выполняются в отдельной задаче:
+// DNS и connect() с таймаутом сокета не задерживают loop(). Основной цикл
+// только кладёт события в очередь и выполняет команды /set из очереди.
+class MQTTManager {
+public:
+    void init();
+    void handle();
+    void publishPinState(uint8_t pin, uint8_t value);
+    bool isConnected();
+    const MQTTConfig& getConfig();
+    MQTTStats getStats();
+    bool saveMQTTConfig(MQTTConfig& config);
+
+private:
+    MQTTConfig mqttConfig;          // Читает и меняет основной цикл
+    MQTTConfig taskConfig;          // Копия задачи (на неё ссылается setServer)
+    MQTTStats stats = {};
+    // Среднее задержки, умноженное на 8: без масштаба сдвиг latency >> 3
+    // обнулял задержки меньше 8 мс и среднее переставало меняться
+    uint32_t avgLatencyScaled = 0;
+    SemaphoreHandle_t lock = nullptr;
+    std::atomic<bool> configChanged{false};
+    std::atomic<bool> connected{false};
+    std::atomic<bool> resyncRequested{false};
+
+    // Очередь публикаций: по одному слоту на пин, новое значение
+    // заменяет неотправленное (для retained-топиков важно только последнее).
+    // Защищена lock: пишет основной цикл, забирает задача.
+    uint64_t pendingMask = 0;
+    uint8_t pendingValue[PIN_COUNT] = {0};
+    unsigned long pendingSince[PIN_COUNT] = {0};
+
+    bool loadConfig(MQTTConfig& config);
+    void applyConfig(const MQTTConfig& config);
+    bool connect();
+    void queueAllStates();
+    void flushPending();
+    void handleMessage(char* topic, uint8_t* payload, unsigned int length);
+
+    static void taskEntry(void* arg);
+    void taskLoop();
+};
+
+#endif
@@ -0,0 +1,17 @@
+#include "pin_backend.h"
+
+bool NativePinBackend::hasPin(uint8_t pin) {
+    return pin < NATIVE_PIN_COUNT;
+}
+
+void NativePinBackend::setMode(uint8_t pin, uint8_t mode) {
+    pinMode(pin, mode);
+}
+
+uint8_t NativePinBackend::read(uint8_t pin) {
+    return digitalRead(pin);
+}
+
+void NativePinBackend::write(uint8_t pin, uint8_t value) {
+    digitalWrite(pin, value);
+}
@@ -0,0 +1,30 @@
+#ifndef PIN_BACKEND_H
+#define PIN_BACKEND_H
+
+#include <Arduino.h>
+#include "config.h"
+
+// Источник пинов для GPIOManager: собственные GPIO ESP32 или расширитель.
+// Реализации с внешней шиной кэшируют состояние: write() только меняет
+// защёлку, read() возвращает последнее прочитанное значение, а обмен
+// с устройством выполняется целыми портами в update().
+class PinBackend {
+public:
+    virtual ~PinBackend() {}
+    virtual bool hasPin(uint8_t pin) = 0;
+    virtual void setMode(uint8_t pin, uint8_t mode) = 0;     // INPUT, INPUT_PULLUP, OUTPUT
+    virtual uint8_t read(uint8_t pin) = 0;
+    virtual void write(uint8_t pin, uint8_t value) = 0;
+    // Один такт обмена; force - прочитать входы независимо от прерывания
+    virtual void update(unsigned long currentMillis, bool force) {}
+};
+
+class NativePinBackend : public PinBackend {
+public:
+    bool hasPin(uint8_t pin) override;
+    void setMode(uint8_t pin, uint8_t mode) override;
+    uint8_t read(uint8_t pin) override;
+    void write(uint8_t pin, uint8_t value) override;
+};
+
+#endif
@@ -0,0 +1,264 @@
+#include "subscription_manager.h"
+#include <WiFi.h>
+#include "gpio_manager.h"
+#include "analog_sampler.h"
+
+extern WebSocketsServer webSocket;
+extern GPIOManager gpioManager;
+extern LoopStats loopStats;
+
+void SubscriptionManager::clientConnected(uint8_t num) {
+    if (num >= WEBSOCKETS_SERVER_CLIENT_MAX) return;
+
+    // По умолчанию клиент получает все пины, как и до появления подписок
+    ClientSubscription& sub = clients[num];
+    memset(&sub, 0, sizeof(sub));
+    sub.connected = true;
+    sub.topics = WS_TOPIC_PINS;
+    sub.telemetryInterval = WS_TELEMETRY_INTERVAL;
+    sub.analogInterval = ANALOG_PUBLISH_INTERVAL;
+}
+
+void SubscriptionManager::clientDisconnected(uint8_t num) {
+    if (num >= WEBSOCKETS_SERVER_CLIENT_MAX) return;
+    clients[num].connected = false;
+}
+
+void SubscriptionManager::subscribe(uint8_t num, const WsCommand& cmd) {
+    if (num >= WEBSOCKETS_SERVER_CLIENT_MAX) return;
+    ClientSubscription& sub = clients[num];
+
+    // Пины, на которые клиент подписывается впервые
+    uint64_t newPins = 0;
+    for (const auto& config : gpioManager.getPinConfigs()) {
+        if (!config.enabled || config.pin >= PIN_COUNT) continue;
+        uint8_t typeTopic = pinTypeTopic(config.pin);
+        if (isSubscribed(sub, config.pin, typeTopic)) continue;
+        if ((cmd.topics & (WS_TOPIC_PINS | typeTopic)) || (cmd.pinMask & (1ULL << config.pin))) {
+            newPins |= 1ULL << config.pin;
+        }
+    }
+
+    sub.topics |= cmd.topics;
+    sub.pinMask |= cmd.pinMask;
+
+    if (cmd.hasRate) {
+        if (cmd.topics & WS_TOPIC_TELEMETRY) {
+            sub.telemetryInterval = max((uint16_t)WS_TELEMETRY_MIN_INTERVAL, cmd.rate);
+        }
+        if (cmd.topics & WS_TOPIC_ANALOG) {
+            sub.analogInterval = max((uint16_t)ANALOG_MIN_PUBLISH_INTERVAL, cmd.rate);
+        }
+        if (cmd.topics & WS_TOPIC_PINS) sub.pinsInterval = cmd.rate;
+        if (cmd.topics & WS_TOPIC_INPUTS) sub.inputsInterval = cmd.rate;
+        if (cmd.topics & WS_TOPIC_OUTPUTS) sub.outputsInterval = cmd.rate;
+        for (uint64_t pins = cmd.pinMask; pins; pins &= pins - 1) {
+            sub.pinInterval[__builtin_ctzll(pins)] = cmd.rate;
+        }
+    }
+
+    char buf[WS_REPLY_BUFFER_SIZE];
+    int len = snprintf(buf, sizeof(buf), "{\"subscribed\":%u}", sub.topics);
+    webSocket.sendTXT(num, buf, len);
+
+    // Текущее состояние новых пинов, чтобы клиенту не нужен был отдельный запрос
+    for (const auto& config : gpioManager.getPinConfigs()) {
+        if (!(newPins & (1ULL << config.pin))) continue;
+        uint8_t value = strcmp(config.type, "output") == 0 ? gpioManager.getOutput(config.pin)
+                                                           : gpioManager.getInput(config.pin);
+        sendPin(num, config.pin, value);
+    }
+
+    // Первая телеметрия уходит сразу
+    if (cmd.topics & WS_TOPIC_TELEMETRY) {
+        sub.lastTelemetry = 0;
+    }
+    if (cmd.topics & WS_TOPIC_ANALOG) {
+        sub.lastAnalog = 0;
+    }
+}
+
+void SubscriptionManager::unsubscribe(uint8_t num, const WsCommand& cmd) {
+    if (num >= WEBSOCKETS_SERVER_CLIENT_MAX) return;
+    ClientSubscription& sub = clients[num];
+
+    sub.topics &= ~cmd.topics;
+    sub.pinMask &= ~cmd.pinMask;
+
+    // Повторная подписка без rate начинается без ограничения частоты
+    if (cmd.topics & WS_TOPIC_PINS) sub.pinsInterval = 0;
+    if (cmd.topics & WS_TOPIC_INPUTS) sub.inputsInterval = 0;
+    if (cmd.topics & WS_TOPIC_OUTPUTS) sub.outputsInterval = 0;
+    for (uint64_t pins = cmd.pinMask; pins; pins &= pins - 1) {
+        sub.pinInterval[__builtin_ctzll(pins)] = 0;
+    }
+
+    char buf[WS_REPLY_BUFFER_SIZE];
+    int len = snprintf(buf, sizeof(buf), "{\"subscribed\":%u}", sub.topics);
+    webSocket.sendTXT(num, buf, len);
+}
+
+void SubscriptionManager::publishPinState(uint8_t pin, uint8_t value) {
+    if (pin >= PIN_COUNT) return;
+    pinValues[pin] = value;
+
+    uint8_t typeTopic = pinTypeTopic(pin);
+    unsigned long now = millis();
+    uint64_t bit = 1ULL << pin;
+
+    for (uint8_t num = 0; num < WEBSOCKETS_SERVER_CLIENT_MAX; num++) {
+        ClientSubscription& sub = clients[num];
+        if (!sub.connected || !isSubscribed(sub, pin, typeTopic)) continue;
+
+        // При превышении частоты отправляется только последнее значение
+        uint16_t interval = pinRateLimit(sub, pin, typeTopic);
+        if (interval && now - sub.lastPinSent[pin] < interval) {
+            sub.pendingPins |= bit;
+        } else {
+            sub.pendingPins &= ~bit;
+            sub.lastPinSent[pin] = now;
+            sendPin(num, pin, value);
+        }
+    }
+}
+
+void SubscriptionManager::handle(unsigned long currentMillis) {
+    char telemetry[WS_TELEMETRY_BUFFER_SIZE];
+    size_t telemetryLength = 0;
+    char analog[WS_TELEMETRY_BUFFER_SIZE];
+    size_t analogLength = 0;
+
+    sendLogs();
+
+    for (uint8_t num = 0; num < WEBSOCKETS_SERVER_CLIENT_MAX; num++) {
+        ClientSubscription& sub = clients[num];
+        if (!sub.connected) continue;
+
+        // Отложенные обновления пинов
+        uint64_t pending = sub.pendingPins;
+        while (pending) {
+            uint8_t pin = __builtin_ctzll(pending);
+            uint64_t bit = 1ULL << pin;
+            pending &= ~bit;
+            uint8_t typeTopic = pinTypeTopic(pin);
+            if (currentMillis - sub.lastPinSent[pin] < pinRateLimit(sub, pin, typeTopic)) continue;
+
+            sub.pendingPins &= ~bit;
+            if (!isSubscribed(sub, pin, typeTopic)) continue;
+            sub.lastPinSent[pin] = currentMillis;
+            sendPin(num, pin, pinValues[pin]);
+        }
+
+        // Телеметрия собирается один раз и рассылается всем, у кого подошёл срок
+        if ((sub.topics & WS_TOPIC_TELEMETRY) &&
+            (sub.lastTelemetry == 0 || currentMillis - sub.lastTelemetry >= sub.telemetryInterval)) {
+            if (telemetryLength == 0) {
+                telemetryLength = buildTelemetry(telemetry, sizeof(telemetry), currentMillis);
+            }
+            webSocket.sendTXT(num, telemetry, telemetryLength);
+            sub.lastTelemetry = currentMillis;
+        }
+
+        // Значения аналоговых входов, так же одно сообщение на всех
+        if ((sub.topics & WS_TOPIC_ANALOG) && analogSampler.getChannelCount() &&
+            (sub.lastAnalog == 0 || currentMillis - sub.lastAnalog >= sub.analogInterval)) {
+            if (analogLength == 0) {
+                analogLength = buildAnalog(analog, sizeof(analog));
+            }
+            webSocket.sendTXT(num, analog, analogLength);
+            sub.lastAnalog = currentMillis;
+        }
+    }
+}
+
+bool SubscriptionManager::isSubscribed(const ClientSubscription& sub, uint8_t pin, uint8_t typeTopic) {
+    return (sub.topics & (WS_TOPIC_PINS | typeTopic)) || (sub.pinMask & (1ULL << pin));
+}
+
+uint16_t SubscriptionManager::pinRateLimit(const ClientSubscription& sub, uint8_t pin, uint8_t typeTopic) {
+    // Отдельно подписанный пин ограничивается своим интервалом, иначе
+    // действует наименьший из топиков, через которые клиент получает пин
+    if (sub.pinMask & (1ULL << pin)) return sub.pinInterval[pin];
+
+    uint16_t interval = UINT16_MAX;
+    if (sub.topics & WS_TOPIC_PINS) interval = min(interval, sub.pinsInterval);
+    if (sub.topics & typeTopic & WS_TOPIC_INPUTS) interval = min(interval, sub.inputsInterval);
+    if (sub.topics & typeTopic & WS_TOPIC_OUTPUTS) interval = min(interval, sub.outputsInterval);
+    return interval == UINT16_MAX ? 0 : interval;
+}
+
+uint8_t SubscriptionManager::pinTypeTopic(uint8_t pin) {
+    PinConfig* config = gpioManager.getPinConfig(pin);
+    if (!config) return 0;
+    if (strcmp(config->type, "output") == 0) return WS_TOPIC_OUTPUTS;
+    // Состояние аналогового входа по порогам рассылается как обычный вход
+    if (strcmp(config->type, "input") == 0 || strcmp(config->type, "analog") == 0) return WS_TOPIC_INPUTS;
+    return 0;
+}
+
+void SubscriptionManager::sendPin(uint8_t num, uint8_t pin, uint8_t value) {
+    char buf[WS_REPLY_BUFFER_SIZE];
+    int len = snprintf(buf, sizeof(buf), "{\"pin\":%u,\"val\":%u}", pin, value);
+    webSocket.sendTXT(num, buf, len);
+}
+
+void SubscriptionManager::sendLogs() {
+    uint8_t subscribers = 0;
+    for (const auto& sub : clients) {
+        if (sub.connected && (sub.topics & WS_TOPIC_LOGS)) subscribers++;
+    }
+    // Без подписчиков задача журнала не форматирует строки для WebSocket
+    logger.setStreamEnabled(subscribers > 0);
+    if (subscribers == 0) return;
+
+    LogLine line;
+    char buf[LOG_LINE_SIZE * 2 + 64];
+    for (uint8_t i = 0; i < LOG_WS_BATCH && logger.readStreamLine(line); i++) {
+        int len = snprintf(buf, sizeof(buf), "{\"type\":\"log\",\"ts\":%lu,\"lvl\":\"%s\",\"msg\":\"",
+                           (unsigned long)line.timestamp, logLevelName(line.level));
+
+        // Экранирование для JSON
+        for (const char* p = line.text; *p && len < (int)sizeof(buf) - 4; p++) {
+            if (*p == '"' || *p == '\\') {
+                buf[len++] = '\\';
+                buf[len++] = *p;
+            } else if ((uint8_t)*p >= 0x20) {
+                buf[len++] = *p;
+            }
+        }
+        buf[len++] = '"';
+        buf[len++] = '}';
+        buf[len] = '\0';
+
+        for (uint8_t num = 0; num < WEBSOCKETS_SERVER_CLIENT_MAX; num++) {
+            if (clients[num].connected && (clients[num].topics & WS_TOPIC_LOGS)) {
+                webSocket.sendTXT(num, buf, len);
+            }
+        }
+    }
+}
+
+size_t SubscriptionManager::buildTelemetry(char* buf, size_t size, unsigned long currentMillis) {
+    int len = snprintf(buf, size,
+        "{\"type\":\"info\",\"uptime\":%lu,\"rssi\":%d,\"free_heap\":%u,\"min_free_heap\":%u,"
+        "\"loop_rate\":%u,\"loop_avg_us\":%u,\"loop_max_us\":%u}",
+        currentMillis, WiFi.RSSI(), (unsigned)ESP.getFreeHeap(), (unsigned)ESP.getMinFreeHeap(),
+        (unsigned)loopStats.rate, (unsigned)loopStats.avgMicros, (unsigned)loopStats.lastMaxMicros);
+
+    return len < (int)size ? len : size - 1;
+}
+
+size_t SubscriptionManager::buildAnalog(char* buf, size_t size) {
+    // {"type":"analog","pins":[[32,1650],[33,12]]}
+    int len = snprintf(buf, size, "{\"type\":\"analog\",\"pins\":[");
+    uint8_t count = analogSampler.getChannelCount();
+    for (uint8_t i = 0; i < count && len < (int)size; i++) {
+        uint8_t pin = analogSampler.getChannelPin(i);
+        len += snprintf(buf + len, size - len, "%s[%u,%u]", i ? "," : "",
+                        pin, analogSampler.getMillivolts(pin));
+    }
+    if (len < (int)size) {
+        len += snprintf(buf + len, size - len, "]}");
+    }
+    return len < (int)size ? len : size - 1;
+}
@@ -0,0 +1,63 @@
+#ifndef SUBSCRIPTION_MANAGER_H
+#define SUBSCRIPTION_MANAGER_H
+
+#include <Arduino.h>
+#include <WebSocketsServer.h>
+#include "config.h"
+#include "ws_command.h"
+#include "logger.h"
+
+// Статистика основного цикла. Накопители сбрасываются каждые
+// LOOP_STATS_WINDOW мс независимо от подписчиков, телеметрия
+// показывает последнее закрытое окно.
+struct LoopStats {
+    uint32_t iterations;
+    uint32_t totalMicros;
+    uint32_t maxMicros;
+    unsigned long windowStart;
+    uint32_t rate;                  // Итераций в секунду за последнее окно
+    uint32_t avgMicros;
+    uint32_t lastMaxMicros;
+};
+
+struct ClientSubscription {
+    bool connected;
+    uint8_t topics;                 // Битовая маска WsTopic
+    uint64_t pinMask;               // Отдельно подписанные пины
+    // Минимальный интервал между обновлениями пина (мс, 0 - без ограничения)
+    // для каждого топика и для отдельно подписанных пинов
+    uint16_t pinsInterval;
+    uint16_t inputsInterval;
+    uint16_t outputsInterval;
+    uint16_t pinInterval[PIN_COUNT];
+    uint16_t telemetryInterval;
+    unsigned long lastTelemetry;
+    uint16_t analogInterval;
+    unsigned long lastAnalog;
+    uint64_t pendingPins;           // Изменения, отложенные ограничением частоты
+    unsigned long lastPinSent[PIN_COUNT];
+};
+
+class SubscriptionManager {
+public:
+    void clientConnected(uint8_t num);
+    void clientDisconnected(uint8_t num);
+    void subscribe(uint8_t num, const WsCommand& cmd);
+    void unsubscribe(uint8_t num, const WsCommand& cmd);
+    void publishPinState(uint8_t pin, uint8_t value);
+    void handle(unsigned long currentMillis);
+
+private:
+    ClientSubscription clients[WEBSOCKETS_SERVER_CLIENT_MAX] = {};
+    uint8_t pinValues[PIN_COUNT] = {0};
+
+    bool isSubscribed(const ClientSubscription& sub, uint8_t pin, uint8_t typeTopic);
+    uint16_t pinRateLimit(const ClientSubscription& sub, uint8_t pin, uint8_t typeTopic);
+    uint8_t pinTypeTopic(uint8_t pin);
+    void sendPin(uint8_t num, uint8_t pin, uint8_t value);
+    void sendLogs();
+    size_t buildTelemetry(char* buf, size_t size, unsigned long currentMillis);
+    size_t buildAnalog(char* buf, size_t size);
+};
+
+#endif
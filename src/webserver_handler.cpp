@@ -4,15 +4,31 @@
 #include <Preferences.h>  // ← ДОБАВЬТЕ ЭТУ СТРОКУ
 #include <FS.h>
 #include <LittleFS.h>
+#include <stdarg.h>
 #include "config.h"
 #include "wifi_manager.h"
 #include "gpio_manager.h"
+#include "mqtt_manager.h"
+#include "modbus_server.h"
+#include "subscription_manager.h"
+#include "analog_sampler.h"
+#include "logger.h"
 #include "webserver_handler.h"
+#include "ws_command.h"
+#include "command_journal.h"
+#include "client_monitor.h"
+#include "fleet_announcer.h"
 
 extern WebServer webServer;
 extern WebSocketsServer webSocket;
 extern WiFiManager wifiManager;
 extern GPIOManager gpioManager;
+extern MQTTManager mqttManager;
+extern ModbusServer modbusServer;
+extern SubscriptionManager subscriptionManager;
+extern CommandJournal commandJournal;
+extern ClientMonitor clientMonitor;
+extern FleetAnnouncer fleetAnnouncer;
 extern Preferences preferences;  // Теперь этот тип будет известен
 
 void initWebServer() {
@@ -23,6 +39,12 @@ void initWebServer() {
     webServer.on("/api/reboot", HTTP_GET, handleGetReboot);
     webServer.on("/api/available-pins", HTTP_GET, handleGetAvailablePins);
     webServer.on("/api/wifi", HTTP_POST, handlePostWiFi);
+    webServer.on("/api/mqtt", HTTP_GET, handleGetMQTT);
+    webServer.on("/api/mqtt", HTTP_POST, handlePostMQTT);
+    webServer.on("/api/fleet", HTTP_GET, handleGetFleet);
+    webServer.on("/api/fleet", HTTP_POST, handlePostFleet);
+    webServer.on("/api/logs", HTTP_GET, handleGetLogs);
+    webServer.on("/api/clients", HTTP_GET, handleGetClients);
     
     // Корневой запрос
     webServer.on("/", HTTP_GET, []() {
@@ -57,52 +79,233 @@ void initWebServer() {
     Serial.println("HTTP server started");
 }
 
+static void sendPinState(uint8_t num, uint8_t pin, uint8_t value) {
+    char buf[WS_REPLY_BUFFER_SIZE];
+    int len = snprintf(buf, sizeof(buf), "{\"pin\":%u,\"val\":%u}", pin, value);
+    webSocket.sendTXT(num, buf, len);
+}
+
+static void sendError(uint8_t num, const char* error, int pin) {
+    char buf[WS_REPLY_BUFFER_SIZE];
+    int len;
+    if (pin >= 0) {
+        len = snprintf(buf, sizeof(buf), "{\"error\":\"%s\",\"pin\":%d}", error, pin);
+    } else {
+        len = snprintf(buf, sizeof(buf), "{\"error\":\"%s\"}", error);
+    }
+    webSocket.sendTXT(num, buf, len);
+}
+
+static void sendParseError(uint8_t num, WsParseError error, size_t pos) {
+    char buf[WS_REPLY_BUFFER_SIZE];
+    int len = snprintf(buf, sizeof(buf), "{\"error\":\"%s\",\"pos\":%u}",
+                       wsParseErrorName(error), (unsigned)pos);
+    webSocket.sendTXT(num, buf, len);
+}
+
+static void sendQueryResponse(uint8_t num, const WsCommand& cmd) {
+    for (const auto& config : gpioManager.getPinConfigs()) {
+        if (!config.enabled) continue;
+        if (cmd.hasPin && config.pin != cmd.items[0].pin) continue;
+
+        if (strcmp(config.type, "output") == 0) {
+            sendPinState(num, config.pin, gpioManager.getOutput(config.pin));
+        } else if (strcmp(config.type, "input") == 0) {
+            sendPinState(num, config.pin, gpioManager.getInput(config.pin));
+        } else if (strcmp(config.type, "analog") == 0) {
+            char buf[WS_REPLY_BUFFER_SIZE];
+            int len = snprintf(buf, sizeof(buf), "{\"pin\":%u,\"val\":%u,\"mv\":%u}", config.pin,
+                               gpioManager.getInput(config.pin), analogSampler.getMillivolts(config.pin));
+            webSocket.sendTXT(num, buf, len);
+        }
+        if (cmd.hasPin) return;
+    }
+    if (cmd.hasPin) {
+        sendError(num, "unknown_pin", cmd.items[0].pin);
+    }
+}
+
+// Причина, по которой пин нельзя установить; nullptr - можно
+static const char* outputError(uint8_t pin) {
+    PinConfig* config = gpioManager.getPinConfig(pin);
+    if (!config) return "unknown_pin";
+    if (!config->enabled || strcmp(config->type, "output") != 0) return "not_output";
+    return nullptr;
+}
+
+// Худший случай ответа должен помещаться в буфер целиком
+static_assert(WS_ACK_BUFFER_SIZE >= sizeof("{\"ack\":4294967295,\"batch\":[") - 1 +
+              WS_BATCH_MAX * (sizeof(",[255,1]") - 1) +
+              sizeof("],\"ts\":4294967295,\"dup\":true}"),
+              "WS_ACK_BUFFER_SIZE too small for WS_BATCH_MAX items");
+static_assert(WS_ACK_ITEM_MAX_LEN >= sizeof(",[255,1]") - 1, "WS_ACK_ITEM_MAX_LEN too small");
+
+// Дописывает в buf с позиции len; false - ответ не поместился
+static bool appendf(char* buf, size_t size, int& len, const char* format, ...)
+    __attribute__((format(printf, 4, 5)));
+static bool appendf(char* buf, size_t size, int& len, const char* format, ...) {
+    if (len < 0 || (size_t)len >= size) return false;
+    va_list args;
+    va_start(args, format);
+    int written = vsnprintf(buf + len, size - len, format, args);
+    va_end(args);
+    if (written < 0 || (size_t)written >= size - len) {
+        len = size - 1;
+        return false;
+    }
+    len += written;
+    return true;
+}
+
+// {"ack":7,"pin":2,"val":1,"ts":123456}
+// {"ack":8,"batch":[[2,1],[4,0]],"ts":123460,"dup":true}
+// {"nack":9,"error":"not_output","pin":5,"ts":123470}
+static void sendCommandResult(uint8_t num, const CommandRecord& record, bool duplicate) {
+    char buf[WS_ACK_BUFFER_SIZE];
+    int len = 0;
+    bool ok;
+    if (record.error) {
+        ok = appendf(buf, sizeof(buf), len, "{\"nack\":%lu,\"error\":\"%s\",\"pin\":%u",
+                     (unsigned long)record.id, record.error, record.errorPin);
+    } else if (!record.batch) {
+        ok = appendf(buf, sizeof(buf), len, "{\"ack\":%lu,\"pin\":%u,\"val\":%u",
+                     (unsigned long)record.id, record.items[0].pin, record.items[0].value);
+    } else {
+        ok = appendf(buf, sizeof(buf), len, "{\"ack\":%lu,\"batch\":[", (unsigned long)record.id);
+        for (uint8_t i = 0; i < record.count && ok; i++) {
+            ok = appendf(buf, sizeof(buf), len, "%s[%u,%u]", i ? "," : "",
+                         record.items[i].pin, record.items[i].value);
+        }
+        ok = ok && appendf(buf, sizeof(buf), len, "]");
+    }
+    ok = ok && appendf(buf, sizeof(buf), len, ",\"ts\":%lu%s}",
+                       (unsigned long)record.timestamp, duplicate ? ",\"dup\":true" : "");
+    if (!ok) {
+        // Обрезанный JSON клиент не разберёт; сообщаем, что ответа не будет
+        LOG_ERROR("[%u] Command %u reply truncated", num, (unsigned)record.id);
+        len = snprintf(buf, sizeof(buf), "{\"error\":\"reply_overflow\",\"id\":%lu}",
+                       (unsigned long)record.id);
+    }
+    webSocket.sendTXT(num, buf, len);
+}
+
+// Установка выходов из команды set/batch; новое состояние рассылается
+// подписчикам через обработчик изменений GPIOManager
+static void applySetCommand(uint8_t num, const WsCommand& cmd) {
+    if (!cmd.hasId) {
+        for (uint8_t i = 0; i < cmd.count; i++) {
+            uint8_t pin = cmd.items[i].pin;
+            const char* error = outputError(pin);
+            if (error) {
+                sendError(num, error, pin);
+            } else {
+                gpioManager.setOutput(pin, cmd.items[i].value);
+            }
+        }
+        return;
+    }
+
+    // Повтор команды, выполненной до разрыва соединения: тот же ответ,
+    // выходы не трогаем
+    if (cmd.clientId) {
+        const CommandRecord* previous = commandJournal.find(cmd.clientId, cmd.id);
+        if (previous) {
+            clientMonitor.countCommand(num, previous->error == nullptr, true);
+            sendCommandResult(num, *previous, true);
+            return;
+        }
+    }
+
+    CommandRecord record;
+    record.clientId = cmd.clientId;
+    record.id = cmd.id;
+    record.batch = cmd.type == WS_CMD_BATCH_SET;
+    record.error = nullptr;
+    record.errorPin = 0;
+    record.count = 0;
+
+    // Команда с идентификатором выполняется целиком или не выполняется
+    for (uint8_t i = 0; i < cmd.count && !record.error; i++) {
+        record.error = outputError(cmd.items[i].pin);
+        record.errorPin = cmd.items[i].pin;
+    }
+    if (!record.error) {
+        for (uint8_t i = 0; i < cmd.count; i++) {
+            uint8_t pin = cmd.items[i].pin;
+            gpioManager.setOutput(pin, cmd.items[i].value);
+            record.items[record.count].pin = pin;
+            // В ответе - фактически выставленный уровень, а не присланное значение
+            record.items[record.count].value = gpioManager.getOutput(pin) ? HIGH : LOW;
+            record.count++;
+        }
+    }
+    record.timestamp = millis();
+
+    if (cmd.clientId) commandJournal.add(record);
+    clientMonitor.countCommand(num, record.error == nullptr, false);
+    sendCommandResult(num, record, false);
+}
+
 void webSocketEvent(uint8_t num, WStype_t type, uint8_t * payload, size_t length) {
     switch (type) {
         case WStype_DISCONNECTED:
-            Serial.printf("[%u] Disconnected!\n", num);
+            LOG_INFO("[%u] Disconnected", num);
+            subscriptionManager.clientDisconnected(num);
+            clientMonitor.clientDisconnected(num);
             break;
         case WStype_CONNECTED: {
             IPAddress ip = webSocket.remoteIP(num);
-            Serial.printf("[%u] Connected from %d.%d.%d.%d\n", num, ip[0], ip[1], ip[2], ip[3]);
+            LOG_INFO("[%u] Connected from %u.%u.%u.%u", num, ip[0], ip[1], ip[2], ip[3]);
+            subscriptionManager.clientConnected(num);
+            clientMonitor.clientConnected(num);
             
             // Отправляем текущие состояния всех выходов
-            auto pinConfigs = gpioManager.getPinConfigs();
-            for (const auto& config : pinConfigs) {
+            for (const auto& config : gpioManager.getPinConfigs()) {
                 if (strcmp(config.type, "output") == 0) {
-                    uint8_t value = digitalRead(config.pin);
-                    String json = "{\"pin\":" + String(config.pin) + ",\"val\":" + String(value) + "}";
-                    webSocket.sendTXT(num, json);
+                    sendPinState(num, config.pin, gpioManager.getOutput(config.pin));
                 }
             }
             break;
         }
         case WStype_TEXT: {
-            Serial.printf("[%u] Received text: %s\n", num, payload);
-            JsonDocument doc;
-            DeserializationError error = deserializeJson(doc, payload);
+            // Разбор без JsonDocument и без вывода каждого кадра в Serial
+            WsCommand cmd;
+            size_t errorPos = 0;
+            WsParseError error = parseWsCommand(payload, length, cmd, &errorPos);
             
-            if (error) {
-                Serial.println("Failed to parse JSON");
+            if (error != WS_PARSE_OK) {
+                sendParseError(num, error, errorPos);
                 return;
             }
             
-            if (doc.containsKey("pin") && doc.containsKey("val")) {
-                uint8_t pin = doc["pin"].as<uint8_t>();
-                uint8_t value = doc["val"].as<uint8_t>();
-                
-                // Проверяем, что пин настроен как выход
-                PinConfig* config = gpioManager.getPinConfig(pin);
-                if (config && strcmp(config->type, "output") == 0) {
-                    gpioManager.setOutput(pin, value);
-                    
-                    // Рассылаем новое состояние всем клиентам
-                    String json = "{\"pin\":" + String(pin) + ",\"val\":" + String(value) + "}";
-                    webSocket.broadcastTXT(json);
+            switch (cmd.type) {
+                case WS_CMD_SET:
+                case WS_CMD_BATCH_SET:
+                    applySetCommand(num, cmd);
+                    break;
+                case WS_CMD_QUERY:
+                    sendQueryResponse(num, cmd);
+                    break;
+                case WS_CMD_SUBSCRIBE:
+                    subscriptionManager.subscribe(num, cmd);
+                    break;
+                case WS_CMD_UNSUBSCRIBE:
+                    subscriptionManager.unsubscribe(num, cmd);
+                    break;
+                case WS_CMD_PING: {
+                    char buf[WS_REPLY_BUFFER_SIZE];
+                    int len = snprintf(buf, sizeof(buf), "{\"pong\":%lu}", millis());
+                    webSocket.sendTXT(num, buf, len);
+                    break;
                 }
+                default:
+                    break;
             }
             break;
         }
+        case WStype_PONG:
+            clientMonitor.onPong(num, payload, length);
+            break;
         default:
             break;
     }
@@ -121,6 +324,12 @@ void handleGetConfig() {
         pinObj["mode"] = config.mode;
         pinObj["memory"] = config.memory;
         pinObj["enabled"] = config.enabled;
+        if (strcmp(config.type, "analog") == 0) {
+            pinObj["decimation"] = config.decimation;
+            pinObj["window"] = config.window;
+            pinObj["threshold_high"] = config.threshold_high;
+            pinObj["threshold_low"] = config.threshold_low;
+        }
     }
     
     String response;
@@ -128,6 +337,13 @@ void handleGetConfig() {
     webServer.send(200, "application/json", response);
 }
 
+// Числовое поле конфигурации без усечения до типа PinConfig:
+// false, если значение не помещается в [0, max]
+static bool readConfigNumber(JsonObject obj, const char* key, long fallback, long max, long& out) {
+    out = obj[key] | fallback;
+    return out >= 0 && out <= max;
+}
+
 void handlePostConfig() {
     if (!webServer.hasArg("plain")) {
         webServer.send(400, "application/json", "{\"error\":\"No data\"}");
@@ -146,19 +362,57 @@ void handlePostConfig() {
     std::vector<PinConfig> newConfigs;
     JsonArray pinsArray = doc["pins"].as<JsonArray>();
     
+    char reply[96];
     for (JsonObject pinObj : pinsArray) {
+        // Номер читается без усечения до uint8_t, чтобы 300 не стал пином 44
+        int pin = pinObj["pin"] | -1;
+        if (pin < 0 || pin >= PIN_COUNT) {
+            snprintf(reply, sizeof(reply), "{\"error\":\"Invalid pin\",\"pin\":%d}", pin);
+            webServer.send(400, "application/json", reply);
+            return;
+        }
+        
         PinConfig config;
-        config.pin = pinObj["pin"].as<uint8_t>();
+        config.pin = pin;
         strlcpy(config.name, pinObj["name"] | "", sizeof(config.name));
         strlcpy(config.type, pinObj["type"] | "input", sizeof(config.type));
         strlcpy(config.mode, pinObj["mode"] | "pullup", sizeof(config.mode));
         config.memory = pinObj["memory"] | false;
         config.enabled = pinObj["enabled"] | true;
         
+        long decimation, window, thresholdHigh, thresholdLow;
+        const char* invalid = nullptr;
+        if (!readConfigNumber(pinObj, "decimation", ANALOG_DEFAULT_DECIMATION, UINT16_MAX, decimation)) {
+            invalid = "Invalid decimation";
+        } else if (!readConfigNumber(pinObj, "window", ANALOG_DEFAULT_WINDOW, UINT8_MAX, window)) {
+            invalid = "Invalid window";
+        } else if (!readConfigNumber(pinObj, "threshold_high", 0, UINT16_MAX, thresholdHigh) ||
+                   !readConfigNumber(pinObj, "threshold_low", 0, UINT16_MAX, thresholdLow)) {
+            invalid = "Invalid thresholds";
+        }
+        if (invalid) {
+            snprintf(reply, sizeof(reply), "{\"error\":\"%s\",\"pin\":%d}", invalid, pin);
+            webServer.send(400, "application/json", reply);
+            return;
+        }
+        config.decimation = decimation;
+        config.window = window;
+        config.threshold_high = thresholdHigh;
+        config.threshold_low = thresholdLow;
+        
         newConfigs.push_back(config);
     }
     
+    int badPin;
+    const char* invalid = gpioManager.validateConfig(newConfigs, badPin);
+    if (invalid) {
+        snprintf(reply, sizeof(reply), "{\"error\":\"%s\",\"pin\":%d}", invalid, badPin);
+        webServer.send(400, "application/json", reply);
+        return;
+    }
+    
     if (gpioManager.saveConfig(newConfigs)) {
+        modbusServer.invalidate();
         webServer.send(200, "application/json", "{\"success\":true}");
     } else {
         webServer.send(500, "application/json", "{\"error\":\"Failed to save config\"}");
@@ -173,6 +427,20 @@ void handleGetInfo() {
     doc["free_heap"] = ESP.getFreeHeap();
     doc["ip"] = WiFi.localIP().toString();
     doc["ap_mode"] = (WiFi.getMode() == WIFI_MODE_APSTA || WiFi.getMode() == WIFI_MODE_AP);
+    doc["modbus_requests"] = modbusServer.getRequestCount();
+    doc["log_dropped"] = logger.getStats().dropped;
+    
+    AnalogStats analogStats = analogSampler.getStats();
+    doc["adc_samples"] = analogStats.samples;
+    doc["adc_overruns"] = analogStats.overruns;
+    
+    ExpanderStats expanderStats = gpioManager.getExpanderStats();
+    JsonObject expander = doc["expander"].to<JsonObject>();
+    expander["present"] = expanderStats.present;
+    expander["reads"] = expanderStats.reads;
+    expander["writes"] = expanderStats.writes;
+    expander["errors"] = expanderStats.errors;
+    expander["interrupts"] = expanderStats.interrupts;
     
     String response;
     serializeJson(doc, response);
@@ -194,6 +462,11 @@ void handleGetAvailablePins() {
         pinsArray.add(pin);
     }
     
+    JsonArray analogArray = doc["analog"].to<JsonArray>();
+    for (uint8_t pin : gpioManager.getAvailableAnalogPins()) {
+        analogArray.add(pin);
+    }
+    
     String response;
     serializeJson(doc, response);
     webServer.send(200, "application/json", response);
@@ -232,6 +505,205 @@ void handlePostWiFi() {
     }
 }
 
+void handleGetMQTT() {
+    const MQTTConfig& config = mqttManager.getConfig();
+    MQTTStats stats = mqttManager.getStats();
+    
+    JsonDocument doc;
+    doc["enabled"] = config.enabled;
+    doc["host"] = config.host;
+    doc["port"] = config.port;
+    doc["user"] = config.user;
+    doc["base_topic"] = config.base_topic;
+    doc["connected"] = mqttManager.isConnected();
+    
+    JsonObject statsObj = doc["stats"].to<JsonObject>();
+    statsObj["published"] = stats.published;
+    statsObj["failed"] = stats.failed;
+    statsObj["coalesced"] = stats.coalesced;
+    statsObj["connects"] = stats.connects;
+    statsObj["queue_depth"] = stats.queueDepth;
+    statsObj["max_queue_depth"] = stats.maxQueueDepth;
+    statsObj["latency_last_ms"] = stats.lastLatency;
+    statsObj["latency_avg_ms"] = stats.avgLatency;
+    statsObj["latency_max_ms"] = stats.maxLatency;
+    statsObj["retry_interval_ms"] = stats.retryInterval;
+    
+    String response;
+    serializeJson(doc, response);
+    webServer.send(200, "application/json", response);
+}
+
+void handlePostMQTT() {
+    if (!webServer.hasArg("plain")) {
+        webServer.send(400, "application/json", "{\"error\":\"No data\"}");
+        return;
+    }
+    
+    String body = webServer.arg("plain");
+    JsonDocument doc;
+    DeserializationError error = deserializeJson(doc, body);
+    
+    if (error) {
+        webServer.send(400, "application/json", "{\"error\":\"Invalid JSON\"}");
+        return;
+    }
+    
+    // Пустой пароль оставляет сохранённый (GET /api/mqtt его не возвращает)
+    const MQTTConfig& current = mqttManager.getConfig();
+    MQTTConfig config;
+    config.enabled = doc["enabled"] | false;
+    strlcpy(config.host, doc["host"] | "", sizeof(config.host));
+    config.port = doc["port"] | MQTT_DEFAULT_PORT;
+    strlcpy(config.user, doc["user"] | "", sizeof(config.user));
+    const char* password = doc["password"] | "";
+    strlcpy(config.password, password[0] ? password : current.password, sizeof(config.password));
+    strlcpy(config.base_topic, doc["base_topic"] | MQTT_DEFAULT_BASE_TOPIC, sizeof(config.base_topic));
+    if (config.base_topic[0] == '\0') {
+        strlcpy(config.base_topic, MQTT_DEFAULT_BASE_TOPIC, sizeof(config.base_topic));
+    }
+    
+    if (mqttManager.saveMQTTConfig(config)) {
+        webServer.send(200, "application/json", "{\"success\":true}");
+    } else {
+        webServer.send(500, "application/json", "{\"error\":\"Failed to save MQTT config\"}");
+    }
+}
+
+void handleGetFleet() {
+    const FleetConfig& config = fleetAnnouncer.getConfig();
+    const FleetStats& stats = fleetAnnouncer.getStats();
+    IPAddress group(FLEET_MULTICAST_GROUP);
+    
+    JsonDocument doc;
+    doc["announce"] = config.announce;
+    doc["state"] = config.state;
+    doc["heartbeat"] = config.heartbeat;
+    doc["group"] = group.toString();
+    doc["port"] = FLEET_MULTICAST_PORT;
+    
+    JsonObject statsObj = doc["stats"].to<JsonObject>();
+    statsObj["announces"] = stats.announces;
+    statsObj["states"] = stats.states;
+    statsObj["send_errors"] = stats.sendErrors;
+    
+    String response;
+    serializeJson(doc, response);
+    webServer.send(200, "application/json", response);
+}
+
+void handlePostFleet() {
+    if (!webServer.hasArg("plain")) {
+        webServer.send(400, "application/json", "{\"error\":\"No data\"}");
+        return;
+    }
+    
+    String body = webServer.arg("plain");
+    JsonDocument doc;
+    DeserializationError error = deserializeJson(doc, body);
+    
+    if (error) {
+        webServer.send(400, "application/json", "{\"error\":\"Invalid JSON\"}");
+        return;
+    }
+    
+    // Отсутствующие поля сохраняют текущие значения
+    FleetConfig config = fleetAnnouncer.getConfig();
+    config.announce = doc["announce"] | config.announce;
+    config.state = doc["state"] | config.state;
+    
+    // Без проверки 70000 сохранился бы как 4464
+    long heartbeat;
+    if (!readConfigNumber(doc.as<JsonObject>(), "heartbeat", config.heartbeat, UINT16_MAX, heartbeat)) {
+        webServer.send(400, "application/json", "{\"error\":\"Invalid heartbeat\"}");
+        return;
+    }
+    config.heartbeat = heartbeat;
+    
+    if (fleetAnnouncer.saveFleetConfig(config)) {
+        webServer.send(200, "application/json", "{\"success\":true}");
+    } else {
+        webServer.send(500, "application/json", "{\"error\":\"Failed to save fleet config\"}");
+    }
+}
+
+void handleGetLogs() {
+    LogStats stats = logger.getStats();
+    
+    JsonDocument doc;
+    doc["written"] = stats.written;
+    doc["dropped"] = stats.dropped;
+    doc["ws_dropped"] = stats.wsDropped;
+    doc["persisted"] = stats.persisted;
+    
+    JsonArray current = doc["current"].to<JsonArray>();
+    logger.renderHistory(false, [&current](uint32_t timestamp, uint8_t level, const char* line) {
+        JsonObject rec = current.add<JsonObject>();
+        rec["ts"] = timestamp;
+        rec["lvl"] = logLevelName(level);
+        rec["msg"] = line;
+    });
+    
+    // Последние записи перед перезагрузкой (только для той же прошивки)
+    JsonArray previous = doc["previous"].to<JsonArray>();
+    logger.renderHistory(true, [&previous](uint32_t timestamp, uint8_t level, const char* line) {
+        JsonObject rec = previous.add<JsonObject>();
+        rec["ts"] = timestamp;
+        rec["lvl"] = logLevelName(level);
+        rec["msg"] = line;
+    });
+    
+    String response;
+    serializeJson(doc, response);
+    webServer.send(200, "application/json", response);
+}
+
+static void addRttHistogram(JsonObject obj, const RttHistogram& rtt) {
+    obj["samples"] = rtt.count;
+    obj["last_us"] = rtt.lastUs;
+    obj["min_us"] = rtt.minUs;
+    obj["avg_us"] = rtt.count ? (uint32_t)(rtt.totalUs / rtt.count) : 0;
+    obj["max_us"] = rtt.maxUs;
+    obj["p50_us"] = rtt.percentileUs(50);
+    obj["p99_us"] = rtt.percentileUs(99);
+    JsonArray buckets = obj["buckets"].to<JsonArray>();
+    for (uint8_t i = 0; i < WS_RTT_BUCKETS; i++) {
+        buckets.add(rtt.buckets[i]);
+    }
+}
+
+void handleGetClients() {
+    JsonDocument doc;
+    
+    // Верхние границы корзин гистограмм; последняя корзина - больше последней границы
+    JsonArray bounds = doc["bucket_bounds_ms"].to<JsonArray>();
+    for (uint8_t i = 0; i < WS_RTT_BUCKETS - 1; i++) {
+        bounds.add(ClientMonitor::bucketBoundMs(i));
+    }
+    addRttHistogram(doc["rtt"].to<JsonObject>(), clientMonitor.getTotal());
+    
+    JsonArray clients = doc["clients"].to<JsonArray>();
+    for (uint8_t num = 0; num < WEBSOCKETS_SERVER_CLIENT_MAX; num++) {
+        const ClientStats& client = clientMonitor.getClient(num);
+        if (!client.connected) continue;
+        
+        JsonObject obj = clients.add<JsonObject>();
+        obj["num"] = num;
+        obj["ip"] = webSocket.remoteIP(num).toString();
+        obj["connected_ms"] = millis() - client.connectedAt;
+        obj["pings"] = client.pingsSent;
+        obj["pings_lost"] = client.pingsLost;
+        obj["acks"] = client.acks;
+        obj["nacks"] = client.nacks;
+        obj["duplicates"] = client.duplicates;
+        addRttHistogram(obj["rtt"].to<JsonObject>(), client.rtt);
+    }
+    
+    String response;
+    serializeJson(doc, response);
+    webServer.send(200, "application/json", response);
+}
+
 void handleNotFound() {
     String path = webServer.uri();
     if (path.endsWith("/")) {
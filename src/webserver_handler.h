@@ -14,6 +14,12 @@ void handleGetInfo();
 void handleGetReboot();
 void handleGetAvailablePins();
 void handlePostWiFi();
+void handleGetMQTT();
+void handlePostMQTT();
+void handleGetFleet();
+void handlePostFleet();
+void handleGetLogs();
+void handleGetClients();
 void handleNotFound();
 
 #endif
\ No newline at end of file
@@ -0,0 +1,398 @@
+#include "ws_command.h"
+#include <string.h>
+
+namespace {
+
+// Курсор по входному буферу. Кадр не обязан заканчиваться нулём,
+// поэтому все обращения идут через peek()/atEnd().
+struct Cursor {
+    const uint8_t* data;
+    size_t length;
+    size_t pos;
+
+    bool atEnd() const { return pos >= length; }
+    uint8_t peek() const { return pos < length ? data[pos] : 0; }
+
+    void skipSpaces() {
+        while (pos < length) {
+            uint8_t c = data[pos];
+            if (c != ' ' && c != '\t' && c != '\r' && c != '\n') break;
+            pos++;
+        }
+    }
+
+    bool consume(uint8_t expected) {
+        skipSpaces();
+        if (peek() != expected || atEnd()) return false;
+        pos++;
+        return true;
+    }
+};
+
+// Ключи и значения в нашей грамматике короткие и без экранирования,
+// поэтому строка возвращается как срез исходного буфера.
+bool readString(Cursor& cur, const uint8_t*& str, size_t& len) {
+    if (!cur.consume('"')) return false;
+    size_t start = cur.pos;
+    while (!cur.atEnd()) {
+        uint8_t c = cur.data[cur.pos];
+        if (c == '"') {
+            str = cur.data + start;
+            len = cur.pos - start;
+            cur.pos++;
+            return true;
+        }
+        if (c == '\\' || c < 0x20) return false;
+        cur.pos++;
+    }
+    return false;
+}
+
+WsParseError readUInt8(Cursor& cur, uint8_t& value) {
+    cur.skipSpaces();
+    uint8_t c = cur.peek();
+    if (cur.atEnd() || c < '0' || c > '9') return WS_PARSE_BAD_NUMBER;
+
+    uint16_t result = 0;
+    uint8_t digits = 0;
+    while (!cur.atEnd() && cur.peek() >= '0' && cur.peek() <= '9') {
+        result = result * 10 + (cur.peek() - '0');
+        if (++digits > 3 || result > 255) return WS_PARSE_BAD_NUMBER;
+        cur.pos++;
+    }
+    // Дробные числа и экспоненты не поддерживаются
+    c = cur.peek();
+    if (c == '.' || c == 'e' || c == 'E') return WS_PARSE_BAD_NUMBER;
+
+    value = (uint8_t)result;
+    return WS_PARSE_OK;
+}
+
+// Уровень выхода: только 0 или 1
+WsParseError readLevel(Cursor& cur, uint8_t& value) {
+    WsParseError err = readUInt8(cur, value);
+    if (err == WS_PARSE_OK && value > 1) return WS_PARSE_BAD_NUMBER;
+    return err;
+}
+
+WsParseError readUInt16(Cursor& cur, uint16_t& value) {
+    cur.skipSpaces();
+    uint8_t c = cur.peek();
+    if (cur.atEnd() || c < '0' || c > '9') return WS_PARSE_BAD_NUMBER;
+
+    uint32_t result = 0;
+    uint8_t digits = 0;
+    while (!cur.atEnd() && cur.peek() >= '0' && cur.peek() <= '9') {
+        result = result * 10 + (cur.peek() - '0');
+        if (++digits > 5 || result > 65535) return WS_PARSE_BAD_NUMBER;
+        cur.pos++;
+    }
+    c = cur.peek();
+    if (c == '.' || c == 'e' || c == 'E') return WS_PARSE_BAD_NUMBER;
+
+    value = (uint16_t)result;
+    return WS_PARSE_OK;
+}
+
+WsParseError readUInt32(Cursor& cur, uint32_t& value) {
+    cur.skipSpaces();
+    uint8_t c = cur.peek();
+    if (cur.atEnd() || c < '0' || c > '9') return WS_PARSE_BAD_NUMBER;
+
+    uint64_t result = 0;
+    uint8_t digits = 0;
+    while (!cur.atEnd() && cur.peek() >= '0' && cur.peek() <= '9') {
+        result = result * 10 + (cur.peek() - '0');
+        if (++digits > 10 || result > 0xFFFFFFFFULL) return WS_PARSE_BAD_NUMBER;
+        cur.pos++;
+    }
+    c = cur.peek();
+    if (c == '.' || c == 'e' || c == 'E') return WS_PARSE_BAD_NUMBER;
+
+    value = (uint32_t)result;
+    return WS_PARSE_OK;
+}
+
+bool keyEquals(const uint8_t* str, size_t len, const char* key) {
+    return len == strlen(key) && memcmp(str, key, len) == 0;
+}
+
+WsParseError readBatch(Cursor& cur, WsCommand& out) {
+    if (!cur.consume('[')) return WS_PARSE_SYNTAX;
+    out.count = 0;
+
+    cur.skipSpaces();
+    if (cur.peek() == ']') {
+        cur.pos++;
+        return WS_PARSE_OK;
+    }
+
+    while (true) {
+        if (out.count >= WS_BATCH_MAX) return WS_PARSE_BATCH_OVERFLOW;
+        WsPinValue& item = out.items[out.count];
+
+        if (!cur.consume('[')) return WS_PARSE_SYNTAX;
+        WsParseError err = readUInt8(cur, item.pin);
+        if (err != WS_PARSE_OK) return err;
+        if (!cur.consume(',')) return WS_PARSE_SYNTAX;
+        err = readLevel(cur, item.value);
+        if (err != WS_PARSE_OK) return err;
+        if (!cur.consume(']')) return WS_PARSE_SYNTAX;
+        out.count++;
+
+        cur.skipSpaces();
+        if (cur.peek() == ']') {
+            cur.pos++;
+            return WS_PARSE_OK;
+        }
+        if (!cur.consume(',')) return WS_PARSE_SYNTAX;
+    }
+}
+
+WsParseError readTopics(Cursor& cur, uint8_t& topics) {
+    if (!cur.consume('[')) return WS_PARSE_SYNTAX;
+    topics = 0;
+
+    cur.skipSpaces();
+    if (cur.peek() == ']') {
+        cur.pos++;
+        return WS_PARSE_OK;
+    }
+
+    while (true) {
+        const uint8_t* name;
+        size_t nameLen;
+        if (!readString(cur, name, nameLen)) return WS_PARSE_SYNTAX;
+
+        if (keyEquals(name, nameLen, "pins")) {
+            topics |= WS_TOPIC_PINS;
+        } else if (keyEquals(name, nameLen, "inputs")) {
+            topics |= WS_TOPIC_INPUTS;
+        } else if (keyEquals(name, nameLen, "outputs")) {
+            topics |= WS_TOPIC_OUTPUTS;
+        } else if (keyEquals(name, nameLen, "telemetry")) {
+            topics |= WS_TOPIC_TELEMETRY;
+        } else if (keyEquals(name, nameLen, "logs")) {
+            topics |= WS_TOPIC_LOGS;
+        } else if (keyEquals(name, nameLen, "analog")) {
+            topics |= WS_TOPIC_ANALOG;
+        } else {
+            return WS_PARSE_UNKNOWN_TOPIC;
+        }
+
+        cur.skipSpaces();
+        if (cur.peek() == ']') {
+            cur.pos++;
+            return WS_PARSE_OK;
+        }
+        if (!cur.consume(',')) return WS_PARSE_SYNTAX;
+    }
+}
+
+WsParseError readPinList(Cursor& cur, uint64_t& mask) {
+    if (!cur.consume('[')) return WS_PARSE_SYNTAX;
+    mask = 0;
+
+    cur.skipSpaces();
+    if (cur.peek() == ']') {
+        cur.pos++;
+        return WS_PARSE_OK;
+    }
+
+    while (true) {
+        uint8_t pin;
+        WsParseError err = readUInt8(cur, pin);
+        if (err != WS_PARSE_OK) return err;
+        if (pin >= 64) return WS_PARSE_BAD_NUMBER;
+        mask |= 1ULL << pin;
+
+        cur.skipSpaces();
+        if (cur.peek() == ']') {
+            cur.pos++;
+            return WS_PARSE_OK;
+        }
+        if (!cur.consume(',')) return WS_PARSE_SYNTAX;
+    }
+}
+
+enum : uint16_t {
+    KEY_PIN    = 1 << 0,
+    KEY_VAL    = 1 << 1,
+    KEY_BATCH  = 1 << 2,
+    KEY_ACTION = 1 << 3,
+    KEY_TOPICS = 1 << 4,
+    KEY_PINS   = 1 << 5,
+    KEY_RATE   = 1 << 6,
+    KEY_ID     = 1 << 7,
+    KEY_CID    = 1 << 8
+};
+
+WsParseError parseObject(Cursor& cur, WsCommand& out) {
+    uint16_t seen = 0;
+    uint8_t pin = 0;
+    uint8_t value = 0;
+    WsCommandType action = WS_CMD_NONE;
+
+    if (!cur.consume('{')) return WS_PARSE_SYNTAX;
+
+    cur.skipSpaces();
+    if (cur.peek() != '}') {
+        while (true) {
+            const uint8_t* key;
+            size_t keyLen;
+            if (!readString(cur, key, keyLen)) return WS_PARSE_SYNTAX;
+            if (!cur.consume(':')) return WS_PARSE_SYNTAX;
+
+            uint16_t flag;
+            WsParseError err = WS_PARSE_OK;
+            if (keyEquals(key, keyLen, "pin")) {
+                flag = KEY_PIN;
+                err = readUInt8(cur, pin);
+            } else if (keyEquals(key, keyLen, "val")) {
+                flag = KEY_VAL;
+                err = readLevel(cur, value);
+            } else if (keyEquals(key, keyLen, "batch")) {
+                flag = KEY_BATCH;
+                err = readBatch(cur, out);
+            } else if (keyEquals(key, keyLen, "topics")) {
+                flag = KEY_TOPICS;
+                err = readTopics(cur, out.topics);
+            } else if (keyEquals(key, keyLen, "pins")) {
+                flag = KEY_PINS;
+                err = readPinList(cur, out.pinMask);
+            } else if (keyEquals(key, keyLen, "rate")) {
+                flag = KEY_RATE;
+                err = readUInt16(cur, out.rate);
+            } else if (keyEquals(key, keyLen, "id")) {
+                flag = KEY_ID;
+                err = readUInt32(cur, out.id);
+            } else if (keyEquals(key, keyLen, "cid")) {
+                flag = KEY_CID;
+                err = readUInt32(cur, out.clientId);
+                if (err == WS_PARSE_OK && out.clientId == 0) err = WS_PARSE_BAD_NUMBER;
+            } else if (keyEquals(key, keyLen, "action")) {
+                flag = KEY_ACTION;
+                const uint8_t* name;
+                size_t nameLen;
+                if (!readString(cur, name, nameLen)) return WS_PARSE_SYNTAX;
+                if (keyEquals(name, nameLen, "getStates")) {
+                    action = WS_CMD_QUERY;
+                } else if (keyEquals(name, nameLen, "ping")) {
+                    action = WS_CMD_PING;
+                } else if (keyEquals(name, nameLen, "subscribe")) {
+                    action = WS_CMD_SUBSCRIBE;
+                } else if (keyEquals(name, nameLen, "unsubscribe")) {
+                    action = WS_CMD_UNSUBSCRIBE;
+                } else {
+                    return WS_PARSE_UNKNOWN_ACTION;
+                }
+            } else {
+                return WS_PARSE_UNKNOWN_KEY;
+            }
+            if (err != WS_PARSE_OK) return err;
+            if (seen & flag) return WS_PARSE_DUPLICATE_KEY;
+            seen |= flag;
+
+            cur.skipSpaces();
+            if (cur.peek() == '}') break;
+            if (!cur.consume(',')) return WS_PARSE_SYNTAX;
+        }
+    }
+    cur.pos++;  // '}'
+
+    // Проверка сочетания полей. Идентификатор есть только у команд установки
+    if ((seen & KEY_CID) && !(seen & KEY_ID)) return WS_PARSE_MISSING_FIELD;
+    if ((seen & KEY_ID) && (seen & KEY_ACTION)) return WS_PARSE_CONFLICT;
+    out.hasId = (seen & KEY_ID) != 0;
+
+    if (action == WS_CMD_SUBSCRIBE || action == WS_CMD_UNSUBSCRIBE) {
+        if (seen & (KEY_PIN | KEY_VAL | KEY_BATCH)) return WS_PARSE_CONFLICT;
+        if (!(seen & (KEY_TOPICS | KEY_PINS))) return WS_PARSE_MISSING_FIELD;
+        out.type = action;
+        out.hasRate = (seen & KEY_RATE) != 0;
+        return WS_PARSE_OK;
+    }
+    if (seen & (KEY_TOPICS | KEY_PINS | KEY_RATE)) return WS_PARSE_CONFLICT;
+
+    if (seen & KEY_ACTION) {
+        if (seen & (KEY_VAL | KEY_BATCH)) return WS_PARSE_CONFLICT;
+        if (action == WS_CMD_PING && (seen & KEY_PIN)) return WS_PARSE_CONFLICT;
+        out.type = action;
+        out.hasPin = (seen & KEY_PIN) != 0;
+        out.count = out.hasPin ? 1 : 0;
+        if (out.hasPin) {
+            out.items[0].pin = pin;
+            out.items[0].value = 0;
+        }
+        return WS_PARSE_OK;
+    }
+
+    if (seen & KEY_BATCH) {
+        if (seen & (KEY_PIN | KEY_VAL)) return WS_PARSE_CONFLICT;
+        out.type = WS_CMD_BATCH_SET;
+        return WS_PARSE_OK;
+    }
+
+    if ((seen & (KEY_PIN | KEY_VAL)) != (KEY_PIN | KEY_VAL)) return WS_PARSE_MISSING_FIELD;
+    out.type = WS_CMD_SET;
+    out.count = 1;
+    out.items[0].pin = pin;
+    out.items[0].value = value;
+    return WS_PARSE_OK;
+}
+
+}  // namespace
+
+WsParseError parseWsCommand(const uint8_t* data, size_t length, WsCommand& out, size_t* errorPos) {
+    out.type = WS_CMD_NONE;
+    out.count = 0;
+    out.hasPin = false;
+    out.topics = 0;
+    out.pinMask = 0;
+    out.hasRate = false;
+    out.rate = 0;
+    out.hasId = false;
+    out.id = 0;
+    out.clientId = 0;
+
+    WsParseError err;
+    Cursor cur = {data, length, 0};
+
+    if (data == nullptr || length == 0) {
+        err = WS_PARSE_EMPTY;
+    } else if (length > WS_MAX_FRAME_SIZE) {
+        err = WS_PARSE_TOO_LONG;
+    } else {
+        err = parseObject(cur, out);
+        if (err == WS_PARSE_OK) {
+            cur.skipSpaces();
+            if (!cur.atEnd()) err = WS_PARSE_SYNTAX;
+        }
+    }
+
+    if (err != WS_PARSE_OK) {
+        out.type = WS_CMD_NONE;
+        out.count = 0;
+        out.hasId = false;
+        if (errorPos) *errorPos = cur.pos;
+    }
+    return err;
+}
+
+const char* wsParseErrorName(WsParseError error) {
+    switch (error) {
+        case WS_PARSE_OK:             return "ok";
+        case WS_PARSE_EMPTY:          return "empty";
+        case WS_PARSE_TOO_LONG:       return "too_long";
+        case WS_PARSE_SYNTAX:         return "syntax";
+        case WS_PARSE_UNKNOWN_KEY:    return "unknown_key";
+        case WS_PARSE_DUPLICATE_KEY:  return "duplicate_key";
+        case WS_PARSE_BAD_NUMBER:     return "bad_number";
+        case WS_PARSE_UNKNOWN_ACTION: return "unknown_action";
+        case WS_PARSE_BATCH_OVERFLOW: return "batch_overflow";
+        case WS_PARSE_MISSING_FIELD:  return "missing_field";
+        case WS_PARSE_CONFLICT:       return "conflict";
+        case WS_PARSE_UNKNOWN_TOPIC:  return "unknown_topic";
+    }
+    return "unknown";
+}
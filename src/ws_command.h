@@ -0,0 +1,90 @@
+#ifndef WS_COMMAND_H
+#define WS_COMMAND_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "config.h"
+
+// Команды WebSocket:
+//   {"pin":N,"val":V}               - установка выхода
+//   {"batch":[[N,V],[N,V],...]}     - пакетная установка выходов
+//   {"action":"getStates"}          - запрос состояний всех пинов
+//   {"action":"getStates","pin":N}  - запрос состояния одного пина
+//   {"action":"ping"}               - проверка связи
+//   {"action":"subscribe","topics":["inputs","telemetry"],"pins":[2,4],"rate":1000}
+//   {"action":"unsubscribe","topics":[...],"pins":[...]}
+//                                   - подписка на топики; rate (мс) задаёт
+//                                     минимальный интервал для перечисленных топиков
+//
+// Значение V - уровень выхода, 0 или 1; другие числа отклоняются с bad_number.
+// Команды установки могут нести идентификатор: {"pin":N,"val":V,"id":I,"cid":C}.
+// На такую команду приходит ack или nack; cid (ненулевой идентификатор
+// клиента) включает подавление повторов после переподключения.
+// Разбор выполняется прямо по буферу кадра, без выделения памяти.
+
+// Топики подписки WebSocket
+enum WsTopic : uint8_t {
+    WS_TOPIC_PINS      = 1 << 0,    // Все пины
+    WS_TOPIC_INPUTS    = 1 << 1,    // Группа: все входы
+    WS_TOPIC_OUTPUTS   = 1 << 2,    // Группа: все выходы
+    WS_TOPIC_TELEMETRY = 1 << 3,    // Uptime, RSSI, память, статистика loop()
+    WS_TOPIC_LOGS      = 1 << 4,
+    WS_TOPIC_ANALOG    = 1 << 5     // Значения аналоговых входов в мВ
+};
+
+enum WsCommandType : uint8_t {
+    WS_CMD_NONE = 0,
+    WS_CMD_SET,
+    WS_CMD_BATCH_SET,
+    WS_CMD_QUERY,
+    WS_CMD_PING,
+    WS_CMD_SUBSCRIBE,
+    WS_CMD_UNSUBSCRIBE
+};
+
+enum WsParseError : uint8_t {
+    WS_PARSE_OK = 0,
+    WS_PARSE_EMPTY,
+    WS_PARSE_TOO_LONG,
+    WS_PARSE_SYNTAX,
+    WS_PARSE_UNKNOWN_KEY,
+    WS_PARSE_DUPLICATE_KEY,
+    WS_PARSE_BAD_NUMBER,
+    WS_PARSE_UNKNOWN_ACTION,
+    WS_PARSE_BATCH_OVERFLOW,
+    WS_PARSE_MISSING_FIELD,
+    WS_PARSE_CONFLICT,
+    WS_PARSE_UNKNOWN_TOPIC
+};
+
+struct WsPinValue {
+    uint8_t pin;
+    uint8_t value;
+};
+
+struct WsCommand {
+    WsCommandType type;
+    uint8_t count;                      // Количество элементов в items
+    bool hasPin;                        // Для WS_CMD_QUERY: запрос одного пина
+    WsPinValue items[WS_BATCH_MAX];
+
+    // Для WS_CMD_SUBSCRIBE / WS_CMD_UNSUBSCRIBE
+    uint8_t topics;                     // Битовая маска WsTopic
+    uint64_t pinMask;                   // Отдельные пины (бит = номер пина)
+    bool hasRate;
+    uint16_t rate;
+
+    // Для WS_CMD_SET / WS_CMD_BATCH_SET
+    bool hasId;
+    uint32_t id;                        // Идентификатор команды, назначенный клиентом
+    uint32_t clientId;                  // 0 - клиент не указал cid
+};
+
+// Разбор кадра. При ошибке в errorPos (если не nullptr) записывается
+// смещение в байтах, на котором разбор был прерван.
+WsParseError parseWsCommand(const uint8_t* data, size_t length, WsCommand& out, size_t* errorPos);
+
+// Короткое имя ошибки для ответа клиенту
+const char* wsParseErrorName(WsParseError error);
+
+#endif
@@ -0,0 +1,217 @@
+// Децимация, фильтры и пороги аналоговых входов: pio test -e native_test -f test_analog_sampler
+
+#include <Arduino.h>
+#include <driver/adc.h>
+#include <unity.h>
+#include <vector>
+#include "analog_sampler.h"
+#include "emulator.h"
+
+// Каналы ADC1 пинов 32, 33 и 34; за один круг шаблона - по выборке на каждый
+static const uint8_t patternChannels[] = {ADC1_CHANNEL_4, ADC1_CHANNEL_5, ADC1_CHANNEL_6};
+static const uint8_t patternPins[] = {32, 33, 34};
+#define PATTERN_LENGTH 3
+
+// Доступ к закрытой обработке кадров (объявлен другом AnalogSampler).
+// Задача чтения не запускается: кадры из эмулятора ADC подаются напрямую
+struct AnalogSamplerTest {
+    static void configure(AnalogSampler& sampler, const std::vector<PinConfig>& configs) {
+        sampler.configureChannels(configs);
+        sampler.running = true;
+    }
+
+    static void feed(AnalogSampler& sampler, const uint8_t* data, uint32_t length) {
+        sampler.processFrame(data, length);
+    }
+};
+
+static PinConfig makeAnalog(uint8_t pin, const char* mode, uint16_t decimation, uint8_t window,
+                            uint16_t thresholdHigh = 0, uint16_t thresholdLow = 0) {
+    PinConfig config = {};
+    config.pin = pin;
+    strlcpy(config.type, "analog", sizeof(config.type));
+    strlcpy(config.mode, mode, sizeof(config.mode));
+    config.enabled = true;
+    config.decimation = decimation;
+    config.window = window;
+    config.threshold_high = thresholdHigh;
+    config.threshold_low = thresholdLow;
+    return config;
+}
+
+// Одно напряжение на всех пинах шаблона
+static void setLevel(uint16_t millivolts) {
+    for (uint8_t i = 0; i < PATTERN_LENGTH; i++) {
+        emu::setAnalogMillivolts(patternPins[i], millivolts);
+    }
+}
+
+// rounds кругов шаблона из эмулятора ADC
+static void feed(AnalogSampler& sampler, uint32_t rounds) {
+    uint8_t frame[PATTERN_LENGTH * ADC_RESULT_BYTE];
+    for (uint32_t i = 0; i < rounds; i++) {
+        uint32_t length = 0;
+        TEST_ASSERT_EQUAL(ESP_OK, adc_digi_read_bytes(frame, sizeof(frame), &length, ADC_MAX_DELAY));
+        TEST_ASSERT_EQUAL(sizeof(frame), length);
+        AnalogSamplerTest::feed(sampler, frame, length);
+    }
+}
+
+static void feedLevel(AnalogSampler& sampler, uint16_t millivolts, uint32_t rounds) {
+    setLevel(millivolts);
+    feed(sampler, rounds);
+}
+
+static std::vector<AnalogEvent> takeEvents(AnalogSampler& sampler) {
+    std::vector<AnalogEvent> events;
+    AnalogEvent event;
+    while (sampler.readEvent(event)) events.push_back(event);
+    return events;
+}
+
+static void assertEvents(AnalogSampler& sampler, std::vector<uint8_t> states) {
+    std::vector<AnalogEvent> events = takeEvents(sampler);
+    TEST_ASSERT_EQUAL(states.size(), events.size());
+    for (size_t i = 0; i < events.size() && i < states.size(); i++) {
+        TEST_ASSERT_EQUAL(34, events[i].pin);
+        TEST_ASSERT_EQUAL(states[i], events[i].state);
+    }
+}
+
+void setUp() {
+    AnalogSampler sampler;
+    takeEvents(sampler);
+}
+
+void tearDown() {}
+
+// В эмуляторе raw = мВ * 4095 / 3300, обратно мВ = raw * 3300 / 4095:
+// 1000 мВ -> 1240 -> 999 мВ, 2000 мВ -> 2481 -> 1999 мВ
+
+static void test_decimation_averages_samples() {
+    AnalogSampler sampler;
+    AnalogSamplerTest::configure(sampler, {makeAnalog(33, "avg", 4, 1)});
+
+    feedLevel(sampler, 1000, 2);
+    feedLevel(sampler, 2000, 1);
+    // Значение появляется только после decimation выборок
+    TEST_ASSERT_EQUAL(0, sampler.getMillivolts(33));
+    feedLevel(sampler, 2000, 1);
+    // (1240 * 2 + 2481 * 2) / 4 = 1860 -> 1498 мВ
+    TEST_ASSERT_EQUAL(1498, sampler.getMillivolts(33));
+    TEST_ASSERT_EQUAL(4 * PATTERN_LENGTH, sampler.getStats().samples);
+
+    // Выборки другого канала в среднее не попадают
+    TEST_ASSERT_EQUAL(0, sampler.getMillivolts(32));
+}
+
+static void test_ema_filter() {
+    AnalogSampler sampler;
+    AnalogSamplerTest::configure(sampler, {makeAnalog(32, "ema", 1, 4)});
+
+    // Первое значение задаёт фильтр без сглаживания
+    feedLevel(sampler, 1000, 1);
+    TEST_ASSERT_EQUAL(999, sampler.getMillivolts(32));
+    // Дальше alpha = 1/4: 1240 + (2481 - 1240) / 4 = 1550.25 -> 1249 мВ
+    feedLevel(sampler, 2000, 1);
+    TEST_ASSERT_EQUAL(1249, sampler.getMillivolts(32));
+    // 1550.25 + (2481 - 1550.25) / 4 = 1782.94 -> 1783 -> 1436 мВ
+    feed(sampler, 1);
+    TEST_ASSERT_EQUAL(1436, sampler.getMillivolts(32));
+    feed(sampler, 100);
+    TEST_ASSERT_EQUAL(1999, sampler.getMillivolts(32));
+}
+
+static void test_moving_average_filter() {
+    AnalogSampler sampler;
+    AnalogSamplerTest::configure(sampler, {makeAnalog(33, "avg", 2, 2), makeAnalog(34, "avg", 1, 3)});
+
+    feedLevel(sampler, 1000, 2);
+    TEST_ASSERT_EQUAL(999, sampler.getMillivolts(33));
+    TEST_ASSERT_EQUAL(999, sampler.getMillivolts(34));
+
+    feedLevel(sampler, 2000, 2);
+    // Окно 2 из значений после децимации: (1240 + 2481) / 2 = 1860 -> 1498 мВ
+    TEST_ASSERT_EQUAL(1498, sampler.getMillivolts(33));
+    // Окно 3 без децимации: (1240 + 2481 * 2) / 3 = 2067 -> 1665 мВ
+    TEST_ASSERT_EQUAL(1665, sampler.getMillivolts(34));
+
+    feedLevel(sampler, 2000, 2);
+    TEST_ASSERT_EQUAL(1999, sampler.getMillivolts(33));
+    TEST_ASSERT_EQUAL(1999, sampler.getMillivolts(34));
+}
+
+static void test_threshold_hysteresis() {
+    AnalogSampler sampler;
+    AnalogSamplerTest::configure(sampler, {makeAnalog(34, "avg", 1, 1, 2000, 1000)});
+
+    // Ниже нижнего порога в начальном состоянии 0 - события нет
+    feedLevel(sampler, 500, 3);
+    assertEvents(sampler, {});
+
+    feedLevel(sampler, 2500, 3);
+    assertEvents(sampler, {1});
+    TEST_ASSERT_EQUAL(1, sampler.getState(34));
+
+    // Между порогами и снова выше верхнего - состояние не меняется
+    feedLevel(sampler, 1500, 3);
+    feedLevel(sampler, 1100, 3);
+    feedLevel(sampler, 2600, 3);
+    feedLevel(sampler, 1900, 3);
+    assertEvents(sampler, {});
+    TEST_ASSERT_EQUAL(1, sampler.getState(34));
+
+    // 1000 мВ читается как 999 - не выше нижнего порога
+    feedLevel(sampler, 1000, 3);
+    assertEvents(sampler, {0});
+
+    // 2000 мВ читается как 1999 - верхний порог не достигнут
+    feedLevel(sampler, 1500, 3);
+    feedLevel(sampler, 2000, 3);
+    assertEvents(sampler, {});
+
+    feedLevel(sampler, 2100, 1);
+    feedLevel(sampler, 900, 1);
+    feedLevel(sampler, 2100, 1);
+    assertEvents(sampler, {1, 0, 1});
+}
+
+static void test_filtered_crossing_reports_once() {
+    AnalogSampler sampler;
+    AnalogSamplerTest::configure(sampler, {makeAnalog(34, "ema", 1, 8, 2000, 1000)});
+
+    // EMA проходит порог за много значений, событие одно
+    feedLevel(sampler, 500, 10);
+    feedLevel(sampler, 3000, 60);
+    assertEvents(sampler, {1});
+
+    // Спад до середины гистерезиса событий не даёт
+    feedLevel(sampler, 1500, 60);
+    assertEvents(sampler, {});
+    TEST_ASSERT_EQUAL(1, sampler.getState(34));
+
+    feedLevel(sampler, 500, 60);
+    assertEvents(sampler, {0});
+}
+
+int main() {
+    // Эмулятор ADC перебирает каналы шаблона по кругу, как контроллер DMA
+    adc_digi_init_config_t initConfig = {};
+    adc_digi_initialize(&initConfig);
+    adc_digi_pattern_config_t pattern[PATTERN_LENGTH] = {};
+    for (uint8_t i = 0; i < PATTERN_LENGTH; i++) pattern[i].channel = patternChannels[i];
+    adc_digi_configuration_t digitalConfig = {};
+    digitalConfig.pattern_num = PATTERN_LENGTH;
+    digitalConfig.adc_pattern = pattern;
+    digitalConfig.sample_freq_hz = ANALOG_SAMPLE_RATE;
+    adc_digi_controller_configure(&digitalConfig);
+    adc_digi_start();
+
+    UNITY_BEGIN();
+    RUN_TEST(test_decimation_averages_samples);
+    RUN_TEST(test_ema_filter);
+    RUN_TEST(test_moving_average_filter);
+    RUN_TEST(test_threshold_hysteresis);
+    RUN_TEST(test_filtered_crossing_reports_once);
+    return UNITY_END();
+}
@@ -0,0 +1,106 @@
+// Журнал команд с cid: pio test -e native_test -f test_command_journal
+
+#include <Arduino.h>
+#include <unity.h>
+#include "command_journal.h"
+
+static CommandJournal* journal;
+
+void setUp() {
+    journal = new CommandJournal();
+}
+
+void tearDown() {
+    delete journal;
+}
+
+static void addCommand(uint32_t clientId, uint32_t id, uint8_t pin = 2, uint8_t value = 1) {
+    CommandRecord record = {};
+    record.clientId = clientId;
+    record.id = id;
+    record.timestamp = millis();
+    record.count = 1;
+    record.items[0].pin = pin;
+    record.items[0].value = value;
+    journal->add(record);
+}
+
+static void test_retry_returns_recorded_result() {
+    addCommand(1, 7, 4, 0);
+    const CommandRecord* record = journal->find(1, 7);
+    TEST_ASSERT_NOT_NULL(record);
+    TEST_ASSERT_EQUAL(4, record->items[0].pin);
+    TEST_ASSERT_EQUAL(0, record->items[0].value);
+    TEST_ASSERT_NULL(journal->find(1, 8));
+    TEST_ASSERT_NULL(journal->find(2, 7));   // id других клиентов не совпадают
+}
+
+// Клиент отправил команду и отключился; пока он переподключается, другие
+// клиенты шлют много команд. Повтор всё равно должен быть распознан
+static void test_retry_survives_other_clients_traffic() {
+    addCommand(1, 100);
+    for (uint32_t id = 1; id <= 10 * WS_COMMAND_JOURNAL_DEPTH; id++) {
+        addCommand(2 + id % 3, id);
+    }
+    TEST_ASSERT_NOT_NULL(journal->find(1, 100));
+}
+
+static void test_own_commands_evict_oldest() {
+    for (uint32_t id = 1; id <= WS_COMMAND_JOURNAL_DEPTH + 1; id++) {
+        addCommand(1, id);
+    }
+    TEST_ASSERT_NULL(journal->find(1, 1));
+    TEST_ASSERT_NOT_NULL(journal->find(1, 2));
+    TEST_ASSERT_NOT_NULL(journal->find(1, WS_COMMAND_JOURNAL_DEPTH + 1));
+}
+
+static void test_least_recent_client_is_evicted() {
+    for (uint32_t clientId = 1; clientId <= WS_COMMAND_JOURNAL_CLIENTS; clientId++) {
+        addCommand(clientId, 1);
+        delay(2);
+    }
+    addCommand(1, 2);   // Клиент 1 снова активен, самый старый теперь 2
+    addCommand(WS_COMMAND_JOURNAL_CLIENTS + 1, 1);
+
+    TEST_ASSERT_NOT_NULL(journal->find(1, 1));
+    TEST_ASSERT_NULL(journal->find(2, 1));
+    TEST_ASSERT_NOT_NULL(journal->find(3, 1));
+    TEST_ASSERT_NOT_NULL(journal->find(WS_COMMAND_JOURNAL_CLIENTS + 1, 1));
+}
+
+static void test_records_expire_after_retain_time() {
+    addCommand(1, 5);
+    delay(WS_COMMAND_RETAIN_TIME + 50);
+    TEST_ASSERT_NULL(journal->find(1, 5));
+
+    // Новая команда того же клиента не возвращает истёкшие записи
+    addCommand(1, 6);
+    TEST_ASSERT_NULL(journal->find(1, 5));
+    TEST_ASSERT_NOT_NULL(journal->find(1, 6));
+}
+
+static void test_expired_client_slot_is_reused_first() {
+    for (uint32_t clientId = 1; clientId <= WS_COMMAND_JOURNAL_CLIENTS; clientId++) {
+        addCommand(clientId, 1);
+    }
+    delay(WS_COMMAND_RETAIN_TIME + 50);
+    for (uint32_t clientId = 2; clientId <= WS_COMMAND_JOURNAL_CLIENTS; clientId++) {
+        addCommand(clientId, 2);
+    }
+    addCommand(100, 1);     // Занимает истёкший слот клиента 1
+    for (uint32_t clientId = 2; clientId <= WS_COMMAND_JOURNAL_CLIENTS; clientId++) {
+        TEST_ASSERT_NOT_NULL(journal->find(clientId, 2));
+    }
+    TEST_ASSERT_NOT_NULL(journal->find(100, 1));
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_retry_returns_recorded_result);
+    RUN_TEST(test_retry_survives_other_clients_traffic);
+    RUN_TEST(test_own_commands_evict_oldest);
+    RUN_TEST(test_least_recent_client_is_evicted);
+    RUN_TEST(test_records_expire_after_retain_time);
+    RUN_TEST(test_expired_client_slot_is_reused_first);
+    return UNITY_END();
+}
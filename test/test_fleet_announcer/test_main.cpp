@@ -0,0 +1,204 @@
+// Датаграммы состояния для сборщика парка: pio test -e native_test -f test_fleet_announcer
+
+#include <Arduino.h>
+#include <Preferences.h>
+#include <WiFiUdp.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <unity.h>
+#include <vector>
+#include "fleet_announcer.h"
+#include "gpio_manager.h"
+
+extern GPIOManager gpioManager;
+extern Preferences preferences;
+
+static FleetAnnouncer fleetAnnouncer;
+
+struct Datagram {
+    IPAddress ip;
+    uint16_t port;
+    std::vector<uint8_t> data;
+};
+
+static std::vector<Datagram> datagrams;
+static uint32_t lastSequence = 0;
+
+// Поля читаются побайтно: проверяется порядок байт, а не раскладка структуры
+static uint64_t readLittleEndian(const std::vector<uint8_t>& data, size_t offset, size_t size) {
+    uint64_t value = 0;
+    for (size_t i = 0; i < size; i++) {
+        value |= (uint64_t)data[offset + i] << (8 * i);
+    }
+    return value;
+}
+
+struct DecodedState {
+    uint8_t flags;
+    uint32_t deviceId;
+    uint32_t sequence;
+    uint32_t uptime;
+    uint64_t inputMask;
+    uint64_t inputs;
+    uint64_t outputMask;
+    uint64_t outputs;
+};
+
+static DecodedState decode(const Datagram& datagram) {
+    const std::vector<uint8_t>& data = datagram.data;
+    TEST_ASSERT_EQUAL(48, data.size());
+    TEST_ASSERT_TRUE(datagram.ip == IPAddress(FLEET_MULTICAST_GROUP));
+    TEST_ASSERT_EQUAL(FLEET_MULTICAST_PORT, datagram.port);
+    TEST_ASSERT_EQUAL('G', data[0]);
+    TEST_ASSERT_EQUAL('S', data[1]);
+    TEST_ASSERT_EQUAL(FLEET_STATE_VERSION, data[2]);
+
+    DecodedState state;
+    state.flags = data[3];
+    state.deviceId = readLittleEndian(data, 4, 4);
+    state.sequence = readLittleEndian(data, 8, 4);
+    state.uptime = readLittleEndian(data, 12, 4);
+    state.inputMask = readLittleEndian(data, 16, 8);
+    state.inputs = readLittleEndian(data, 24, 8);
+    state.outputMask = readLittleEndian(data, 32, 8);
+    state.outputs = readLittleEndian(data, 40, 8);
+    return state;
+}
+
+// Ровно одна датаграмма с номером, следующим за предыдущим
+static DecodedState takeState() {
+    TEST_ASSERT_EQUAL(1, datagrams.size());
+    DecodedState state = decode(datagrams[0]);
+    TEST_ASSERT_EQUAL(lastSequence + 1, state.sequence);
+    lastSequence = state.sequence;
+    datagrams.clear();
+    return state;
+}
+
+void setUp() {
+    datagrams.clear();
+}
+
+void tearDown() {}
+
+static void test_state_layout() {
+    // После подключения состояние отправляется сразу
+    fleetAnnouncer.handle(1000);
+    DecodedState state = takeState();
+
+    TEST_ASSERT_EQUAL(0, state.flags);
+    // EMU_MAC 0x112233445566: идентификатор - как в имени клиента MQTT
+    TEST_ASSERT_EQUAL_HEX32(0x112233, state.deviceId);
+    TEST_ASSERT_EQUAL(1000, state.uptime);
+    TEST_ASSERT_EQUAL_HEX64(1ULL << 4, state.inputMask);
+    TEST_ASSERT_EQUAL_HEX64((1ULL << 2) | (1ULL << 33), state.outputMask);
+    TEST_ASSERT_EQUAL_HEX64(1ULL << 33, state.outputs);
+
+    // Без изменений до heartbeat ничего не отправляется
+    fleetAnnouncer.handle(1500);
+    TEST_ASSERT_EQUAL(0, datagrams.size());
+}
+
+static void test_changes_in_one_pass_share_a_datagram() {
+    gpioManager.setOutput(2, HIGH);
+    fleetAnnouncer.notifyChange();
+    gpioManager.setOutput(33, LOW);
+    fleetAnnouncer.notifyChange();
+    gpioManager.setOutput(2, LOW);
+    fleetAnnouncer.notifyChange();
+    gpioManager.setOutput(2, HIGH);
+    fleetAnnouncer.notifyChange();
+
+    fleetAnnouncer.handle(2000);
+    DecodedState state = takeState();
+    TEST_ASSERT_EQUAL(0, state.flags);
+    TEST_ASSERT_EQUAL(2000, state.uptime);
+    // Датаграмма отражает уровни на момент отправки
+    TEST_ASSERT_EQUAL_HEX64(1ULL << 2, state.outputs);
+
+    fleetAnnouncer.handle(2001);
+    TEST_ASSERT_EQUAL(0, datagrams.size());
+}
+
+static void test_heartbeat_without_changes() {
+    // Последнее состояние отправлено в 2000, heartbeat 1000 мс
+    fleetAnnouncer.handle(2999);
+    TEST_ASSERT_EQUAL(0, datagrams.size());
+
+    fleetAnnouncer.handle(3000);
+    DecodedState state = takeState();
+    TEST_ASSERT_EQUAL(FLEET_STATE_HEARTBEAT_FLAG, state.flags);
+    TEST_ASSERT_EQUAL(3000, state.uptime);
+    TEST_ASSERT_EQUAL_HEX64(1ULL << 2, state.outputs);
+
+    fleetAnnouncer.handle(4000);
+    TEST_ASSERT_EQUAL(FLEET_STATE_HEARTBEAT_FLAG, takeState().flags);
+
+    // Изменение отправляется без флага и сдвигает следующий heartbeat
+    fleetAnnouncer.notifyChange();
+    fleetAnnouncer.handle(4200);
+    TEST_ASSERT_EQUAL(0, takeState().flags);
+    fleetAnnouncer.handle(5000);
+    TEST_ASSERT_EQUAL(0, datagrams.size());
+    fleetAnnouncer.handle(5200);
+    TEST_ASSERT_EQUAL(FLEET_STATE_HEARTBEAT_FLAG, takeState().flags);
+}
+
+static void test_heartbeat_is_limited() {
+    FleetConfig config = fleetAnnouncer.getConfig();
+    config.heartbeat = 10;
+    fleetAnnouncer.saveFleetConfig(config);
+    TEST_ASSERT_EQUAL(FLEET_MIN_HEARTBEAT, fleetAnnouncer.getConfig().heartbeat);
+
+    // Новые настройки отправляются сразу
+    fleetAnnouncer.handle(6000);
+    TEST_ASSERT_EQUAL(0, takeState().flags);
+    fleetAnnouncer.handle(6000 + FLEET_MIN_HEARTBEAT - 1);
+    TEST_ASSERT_EQUAL(0, datagrams.size());
+    fleetAnnouncer.handle(6000 + FLEET_MIN_HEARTBEAT);
+    TEST_ASSERT_EQUAL(FLEET_STATE_HEARTBEAT_FLAG, takeState().flags);
+}
+
+int main() {
+    // NVS эмулятора - во временном файле, чтобы не трогать .emu_nvs
+    char nvs[] = "/tmp/fleet-test-nvs-XXXXXX";
+    close(mkstemp(nvs));
+    setenv("EMU_NVS_FILE", nvs, 1);
+    setenv("EMU_MAC", "112233445566", 1);
+    preferences.begin(NVS_CONFIG_NAMESPACE, false);
+
+    // Выходы 2 и 33 (второй включён), вход 4
+    std::vector<PinConfig> pins;
+    const uint8_t numbers[] = {2, 33, 4};
+    for (uint8_t pin : numbers) {
+        PinConfig config = {};
+        config.pin = pin;
+        strlcpy(config.type, pin == 4 ? "input" : "output", sizeof(config.type));
+        config.enabled = true;
+        pins.push_back(config);
+    }
+    gpioManager.saveConfig(pins);
+    gpioManager.init();
+    gpioManager.setOutput(33, HIGH);
+
+    emu::setUdpTap([](IPAddress ip, uint16_t port, const std::vector<uint8_t>& packet) {
+        datagrams.push_back({ip, port, packet});
+    });
+
+    // Только поток состояний: объявления - JSON, их формат здесь не проверяется
+    fleetAnnouncer.init();
+    FleetConfig config = fleetAnnouncer.getConfig();
+    config.announce = false;
+    config.state = true;
+    config.heartbeat = 1000;
+    fleetAnnouncer.saveFleetConfig(config);
+
+    UNITY_BEGIN();
+    RUN_TEST(test_state_layout);
+    RUN_TEST(test_changes_in_one_pass_share_a_datagram);
+    RUN_TEST(test_heartbeat_without_changes);
+    RUN_TEST(test_heartbeat_is_limited);
+    int result = UNITY_END();
+    unlink(nvs);
+    return result;
+}
@@ -0,0 +1,133 @@
+// Проверка конфигурации пинов перед сохранением: pio test -e native_test -f test_gpio_config
+
+#include <Arduino.h>
+#include <Preferences.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <unity.h>
+#include "gpio_manager.h"
+
+extern GPIOManager gpioManager;
+extern Preferences preferences;
+
+void setUp() {}
+void tearDown() {}
+
+static PinConfig makePin(uint8_t pin, const char* type) {
+    PinConfig config = {};
+    config.pin = pin;
+    strlcpy(config.type, type, sizeof(config.type));
+    strlcpy(config.mode, "pullup", sizeof(config.mode));
+    config.enabled = true;
+    config.decimation = ANALOG_DEFAULT_DECIMATION;
+    config.window = ANALOG_DEFAULT_WINDOW;
+    return config;
+}
+
+static const char* check(std::vector<PinConfig> configs, int& badPin) {
+    return gpioManager.validateConfig(configs, badPin);
+}
+
+static void test_accepts_valid_config() {
+    int badPin = 0;
+    TEST_ASSERT_NULL(check({makePin(2, "output"), makePin(4, "input"), makePin(32, "analog"),
+                            makePin(36, "analog"), makePin(40, "output"), makePin(55, "input")}, badPin));
+    TEST_ASSERT_EQUAL(-1, badPin);
+}
+
+static void test_rejects_pins_outside_backends() {
+    int badPin;
+    TEST_ASSERT_NOT_NULL(check({makePin(2, "output"), makePin(56, "output")}, badPin));
+    TEST_ASSERT_EQUAL(56, badPin);
+    TEST_ASSERT_NOT_NULL(check({makePin(64, "input")}, badPin));
+    TEST_ASSERT_NOT_NULL(check({makePin(255, "input")}, badPin));
+    TEST_ASSERT_EQUAL(255, badPin);
+}
+
+static void test_rejects_excluded_and_bus_pins() {
+    int badPin;
+    TEST_ASSERT_NOT_NULL(check({makePin(12, "output")}, badPin));     // EXCLUDED_PINS
+    TEST_ASSERT_NOT_NULL(check({makePin(34, "input")}, badPin));      // Только АЦП
+    // Расширитель найден: SDA, SCL и INT заняты шиной
+    TEST_ASSERT_NOT_NULL(check({makePin(EXPANDER_SDA_PIN, "output")}, badPin));
+    TEST_ASSERT_NOT_NULL(check({makePin(EXPANDER_SCL_PIN, "input")}, badPin));
+    TEST_ASSERT_NOT_NULL(check({makePin(EXPANDER_INT_PIN, "input")}, badPin));
+    TEST_ASSERT_EQUAL(EXPANDER_INT_PIN, badPin);
+}
+
+static void test_rejects_analog_on_digital_pin() {
+    int badPin;
+    TEST_ASSERT_NOT_NULL(check({makePin(4, "analog")}, badPin));
+    TEST_ASSERT_NOT_NULL(check({makePin(40, "analog")}, badPin));
+    TEST_ASSERT_EQUAL(40, badPin);
+}
+
+static PinConfig makeAnalog(uint8_t pin, uint16_t decimation, uint8_t window,
+                            uint16_t thresholdHigh, uint16_t thresholdLow) {
+    PinConfig config = makePin(pin, "analog");
+    strlcpy(config.mode, "ema", sizeof(config.mode));
+    config.decimation = decimation;
+    config.window = window;
+    config.threshold_high = thresholdHigh;
+    config.threshold_low = thresholdLow;
+    return config;
+}
+
+static void test_rejects_out_of_range_analog_fields() {
+    int badPin;
+    TEST_ASSERT_NULL(check({makeAnalog(32, 1, 1, 0, 0), makeAnalog(33, ANALOG_MAX_DECIMATION,
+                            ANALOG_MAX_WINDOW, 2000, 2000)}, badPin));
+
+    TEST_ASSERT_EQUAL_STRING("Invalid decimation", check({makeAnalog(32, 0, 8, 0, 0)}, badPin));
+    TEST_ASSERT_EQUAL(32, badPin);
+    TEST_ASSERT_EQUAL_STRING("Invalid decimation",
+                             check({makeAnalog(33, ANALOG_MAX_DECIMATION + 1, 8, 0, 0)}, badPin));
+    TEST_ASSERT_EQUAL_STRING("Invalid window", check({makeAnalog(32, 100, 0, 0, 0)}, badPin));
+    TEST_ASSERT_EQUAL_STRING("Invalid window",
+                             check({makeAnalog(32, 100, ANALOG_MAX_WINDOW + 1, 0, 0)}, badPin));
+    TEST_ASSERT_EQUAL_STRING("Invalid thresholds", check({makeAnalog(32, 100, 8, 1000, 1001)}, badPin));
+    TEST_ASSERT_EQUAL_STRING("Invalid thresholds", check({makeAnalog(36, 100, 8, 0, 500)}, badPin));
+    TEST_ASSERT_EQUAL(36, badPin);
+
+    // Для цифровых пинов аналоговые поля не используются
+    PinConfig digital = makePin(4, "input");
+    digital.window = 200;
+    TEST_ASSERT_NULL(check({digital}, badPin));
+}
+
+static void test_rejects_duplicates_and_unknown_types() {
+    int badPin;
+    TEST_ASSERT_NOT_NULL(check({makePin(2, "output"), makePin(2, "input")}, badPin));
+    TEST_ASSERT_EQUAL(2, badPin);
+    TEST_ASSERT_NOT_NULL(check({makePin(2, "pwm")}, badPin));
+
+    // Отключённая запись не занимает пин
+    PinConfig disabled = makePin(2, "input");
+    disabled.enabled = false;
+    TEST_ASSERT_NULL(check({disabled, makePin(2, "output")}, badPin));
+}
+
+static void test_save_refuses_invalid_config() {
+    TEST_ASSERT_FALSE(gpioManager.saveConfig({makePin(12, "output")}));
+    TEST_ASSERT_EQUAL(0, gpioManager.getPinConfigs().size());
+}
+
+int main() {
+    char nvs[] = "/tmp/gpio-test-nvs-XXXXXX";
+    close(mkstemp(nvs));
+    setenv("EMU_NVS_FILE", nvs, 1);
+    preferences.begin(NVS_CONFIG_NAMESPACE, false);
+    gpioManager.init();
+
+    UNITY_BEGIN();
+    RUN_TEST(test_accepts_valid_config);
+    RUN_TEST(test_rejects_pins_outside_backends);
+    RUN_TEST(test_rejects_excluded_and_bus_pins);
+    RUN_TEST(test_rejects_analog_on_digital_pin);
+    RUN_TEST(test_rejects_out_of_range_analog_fields);
+    RUN_TEST(test_rejects_duplicates_and_unknown_types);
+    RUN_TEST(test_save_refuses_invalid_config);
+    int result = UNITY_END();
+    unlink(nvs);
+    return result;
+}
@@ -0,0 +1,155 @@
+// Двоичный журнал: pio test -e native_test -f test_logger
+// В native_test задача вывода спит LOG_DRAIN_INTERVAL (час) после первого
+// прохода, поэтому буфер разбирает сам тест через drain().
+
+#include <Arduino.h>
+#include <LittleFS.h>
+#include <stdlib.h>
+#include <unity.h>
+#include <filesystem>
+#include <string>
+#include <vector>
+#include "logger.h"
+
+struct LoggerTest {
+    static void drain() {
+        logger.drain();
+    }
+};
+
+struct HistoryLine {
+    uint8_t level;
+    std::string text;
+};
+
+static std::vector<HistoryLine> history() {
+    std::vector<HistoryLine> lines;
+    logger.renderHistory(false, [&lines](uint32_t, uint8_t level, const char* line) {
+        lines.push_back({level, line});
+    });
+    return lines;
+}
+
+void setUp() {
+    LoggerTest::drain();
+}
+
+void tearDown() {}
+
+static void test_render_formats_packed_arguments() {
+    LogRecord rec = {};
+    rec.format = "Pin %u changed to %u";
+    rec.args[0] = 4;
+    rec.args[1] = 1;
+    char buf[LOG_LINE_SIZE];
+    TEST_ASSERT_EQUAL(18, logRender(rec, buf, sizeof(buf)));
+    TEST_ASSERT_EQUAL_STRING("Pin 4 changed to 1", buf);
+
+    rec.format = "%d %u %x %c %d %u";
+    int negative = -5;
+    rec.args[0] = (uint32_t)negative;
+    rec.args[1] = 4000000000u;
+    rec.args[2] = 0xBEEF;
+    rec.args[3] = 'Z';
+    rec.args[4] = 0;
+    rec.args[5] = 6;
+    logRender(rec, buf, sizeof(buf));
+    TEST_ASSERT_EQUAL_STRING("-5 4000000000 beef Z 0 6", buf);
+
+    // Обрезка: возвращается фактическая длина в буфере
+    char small[8];
+    rec.format = "Pin %u changed to %u";
+    rec.args[0] = 40;
+    TEST_ASSERT_EQUAL(7, logRender(rec, small, sizeof(small)));
+    TEST_ASSERT_EQUAL_STRING("Pin 40 ", small);
+}
+
+static void test_ring_wraps_in_order() {
+    LogStats before = logger.getStats();
+    // Три оборота кольца, с разбором после каждой половины
+    for (uint32_t i = 0; i < LOG_RING_SIZE * 3; i++) {
+        LOG_INFO("wrap %u", i);
+        if (i % (LOG_RING_SIZE / 2) == LOG_RING_SIZE / 2 - 1) LoggerTest::drain();
+    }
+    LoggerTest::drain();
+
+    LogStats after = logger.getStats();
+    TEST_ASSERT_EQUAL(before.written + LOG_RING_SIZE * 3, after.written);
+    TEST_ASSERT_EQUAL(before.dropped, after.dropped);
+
+    std::vector<HistoryLine> lines = history();
+    TEST_ASSERT_EQUAL(LOG_PERSIST_RECORDS, lines.size());
+    for (size_t i = 0; i < lines.size(); i++) {
+        std::string expected = "wrap " + std::to_string(LOG_RING_SIZE * 3 - LOG_PERSIST_RECORDS + i);
+        TEST_ASSERT_EQUAL_STRING(expected.c_str(), lines[i].text.c_str());
+        TEST_ASSERT_EQUAL(LOG_LEVEL_INFO, lines[i].level);
+    }
+}
+
+static void test_full_ring_counts_dropped() {
+    LogStats before = logger.getStats();
+    for (uint32_t i = 0; i < LOG_RING_SIZE + 5; i++) {
+        LOG_WARN("full %u", i);
+    }
+    LogStats full = logger.getStats();
+    TEST_ASSERT_EQUAL(before.written + LOG_RING_SIZE, full.written);
+    TEST_ASSERT_EQUAL(before.dropped + 5, full.dropped);
+
+    // Сохраняются первые записи, потерянные - последние
+    LoggerTest::drain();
+    std::vector<HistoryLine> lines = history();
+    std::string last = "full " + std::to_string(LOG_RING_SIZE - 1);
+    TEST_ASSERT_EQUAL_STRING(last.c_str(), lines.back().text.c_str());
+    TEST_ASSERT_EQUAL(LOG_LEVEL_WARN, lines.back().level);
+
+    // После разбора запись снова проходит
+    LOG_ERROR("after %u", 1);
+    TEST_ASSERT_EQUAL(full.dropped, logger.getStats().dropped);
+}
+
+static void test_stream_queue_drops_when_full() {
+    LogLine line;
+    while (logger.readStreamLine(line)) {}
+
+    // Без подписчиков строки в очередь не попадают
+    logger.setStreamEnabled(false);
+    LOG_INFO("hidden %u", 1);
+    LoggerTest::drain();
+    TEST_ASSERT_FALSE(logger.readStreamLine(line));
+
+    logger.setStreamEnabled(true);
+    LogStats before = logger.getStats();
+    for (uint32_t i = 0; i < LOG_WS_QUEUE_SIZE + 3; i++) {
+        LOG_INFO("stream %u", i);
+    }
+    LoggerTest::drain();
+    TEST_ASSERT_EQUAL(before.wsDropped + 3, logger.getStats().wsDropped);
+
+    for (uint32_t i = 0; i < LOG_WS_QUEUE_SIZE; i++) {
+        TEST_ASSERT_TRUE(logger.readStreamLine(line));
+        std::string expected = "stream " + std::to_string(i);
+        TEST_ASSERT_EQUAL_STRING(expected.c_str(), line.text);
+        TEST_ASSERT_EQUAL(LOG_LEVEL_INFO, line.level);
+    }
+    TEST_ASSERT_FALSE(logger.readStreamLine(line));
+    logger.setStreamEnabled(false);
+}
+
+int main() {
+    // Сохранение журнала - во временный каталог
+    char root[] = "/tmp/logger-test-XXXXXX";
+    setenv("EMU_FS_ROOT", mkdtemp(root), 1);
+    LittleFS.begin(false);
+    logger.init();
+    // Первый проход задачи вывода, дальше она спит
+    delay(100);
+
+    UNITY_BEGIN();
+    RUN_TEST(test_render_formats_packed_arguments);
+    RUN_TEST(test_ring_wraps_in_order);
+    RUN_TEST(test_full_ring_counts_dropped);
+    RUN_TEST(test_stream_queue_drops_when_full);
+    int result = UNITY_END();
+    std::filesystem::remove_all(root);
+    return result;
+}
@@ -0,0 +1,124 @@
+// MCP23017 против модели в host/src/wire.cpp: pio test -e native_test -f test_mcp23017
+
+#include <Arduino.h>
+#include <Wire.h>
+#include <unity.h>
+#include "emulator.h"
+#include "mcp23017.h"
+
+static Mcp23017Backend expander(Wire, EXPANDER_I2C_ADDRESS, EXPANDER_PIN_BASE, EXPANDER_INT_PIN);
+static unsigned long now = 0;
+
+void setUp() {}
+void tearDown() {}
+
+static void test_begin_detects_expander() {
+    TEST_ASSERT_TRUE(expander.begin());
+    TEST_ASSERT_TRUE(expander.isPresent());
+    TEST_ASSERT_TRUE(expander.hasPin(EXPANDER_PIN_BASE));
+    TEST_ASSERT_TRUE(expander.hasPin(EXPANDER_PIN_BASE + EXPANDER_PIN_COUNT - 1));
+    TEST_ASSERT_FALSE(expander.hasPin(EXPANDER_PIN_BASE + EXPANDER_PIN_COUNT));
+    TEST_ASSERT_FALSE(expander.hasPin(EXPANDER_PIN_BASE - 1));
+}
+
+static void test_writes_wait_for_update() {
+    uint32_t writes = expander.getStats().writes;
+    emu::setExternalLevel(40, LOW);
+
+    // Порядок как в GPIOManager::configurePin: уровень, затем направление
+    expander.write(40, HIGH);
+    expander.setMode(40, OUTPUT);
+    TEST_ASSERT_EQUAL(HIGH, expander.read(40));         // Теневая защёлка
+    TEST_ASSERT_EQUAL(0, emu::expanderOutputLevel(0));  // На шину ещё ничего не ушло
+    TEST_ASSERT_EQUAL(writes, expander.getStats().writes);
+
+    expander.update(now, false);
+    TEST_ASSERT_EQUAL(1, emu::expanderOutputLevel(0));
+    TEST_ASSERT_EQUAL(writes + 1, expander.getStats().writes);
+}
+
+static void test_outputs_share_one_latch_write() {
+    for (uint8_t pin = 41; pin < 48; pin++) {
+        expander.setMode(pin, OUTPUT);
+        expander.write(pin, pin & 1);
+    }
+    expander.write(50, HIGH);
+    expander.setMode(50, OUTPUT);
+
+    uint32_t writes = expander.getStats().writes;
+    expander.update(now, false);
+    TEST_ASSERT_EQUAL(writes + 1, expander.getStats().writes);
+    for (uint8_t pin = 41; pin < 48; pin++) {
+        TEST_ASSERT_EQUAL(pin & 1, emu::expanderOutputLevel(pin - EXPANDER_PIN_BASE));
+    }
+    TEST_ASSERT_EQUAL(1, emu::expanderOutputLevel(50 - EXPANDER_PIN_BASE));
+
+    // Запись того же уровня не меняет защёлку и не занимает шину
+    expander.write(41, HIGH);
+    expander.write(42, LOW);
+    expander.update(now, false);
+    TEST_ASSERT_EQUAL(writes + 1, expander.getStats().writes);
+}
+
+static void test_input_is_read_on_interrupt() {
+    emu::setExternalLevel(48, HIGH);
+    expander.setMode(48, INPUT_PULLUP);
+    expander.update(now, false);                        // Смена направления - чтение входов
+    TEST_ASSERT_EQUAL(HIGH, expander.read(48));
+    TEST_ASSERT_FALSE(emu::expanderInterruptLine());
+    TEST_ASSERT_EQUAL(HIGH, digitalRead(EXPANDER_INT_PIN));
+
+    ExpanderStats before = expander.getStats();
+    emu::setExternalLevel(48, LOW);
+    TEST_ASSERT_EQUAL(LOW, digitalRead(EXPANDER_INT_PIN));
+    TEST_ASSERT_EQUAL(HIGH, expander.read(48));         // До update() - прежнее значение
+
+    now += 1;
+    expander.update(now, false);
+    ExpanderStats after = expander.getStats();
+    TEST_ASSERT_EQUAL(LOW, expander.read(48));
+    TEST_ASSERT_EQUAL(before.interrupts + 1, after.interrupts);
+    TEST_ASSERT_EQUAL(before.reads + 1, after.reads);
+    // Чтение GPIO сбрасывает прерывание
+    TEST_ASSERT_EQUAL(HIGH, digitalRead(EXPANDER_INT_PIN));
+}
+
+static void test_no_reads_without_interrupt() {
+    uint32_t reads = expander.getStats().reads;
+
+    for (int i = 0; i < 10; i++) {
+        now += 10;
+        expander.update(now, false);
+    }
+    TEST_ASSERT_EQUAL(reads, expander.getStats().reads);
+
+    // Контрольное чтение раз в EXPANDER_RESYNC_INTERVAL
+    now += EXPANDER_RESYNC_INTERVAL;
+    expander.update(now, false);
+    TEST_ASSERT_EQUAL(reads + 1, expander.getStats().reads);
+}
+
+static void test_output_pins_do_not_raise_interrupt() {
+    // Изменение защёлки выхода не должно будить чтение входов
+    uint32_t interrupts = expander.getStats().interrupts;
+    expander.write(40, LOW);
+    now += 1;
+    expander.update(now, false);
+    TEST_ASSERT_FALSE(emu::expanderInterruptLine());
+    now += 1;
+    expander.update(now, false);
+    TEST_ASSERT_EQUAL(interrupts, expander.getStats().interrupts);
+}
+
+int main() {
+    Wire.begin(EXPANDER_SDA_PIN, EXPANDER_SCL_PIN, EXPANDER_I2C_CLOCK);
+
+    UNITY_BEGIN();
+    RUN_TEST(test_begin_detects_expander);
+    RUN_TEST(test_writes_wait_for_update);
+    RUN_TEST(test_outputs_share_one_latch_write);
+    RUN_TEST(test_input_is_read_on_interrupt);
+    RUN_TEST(test_no_reads_without_interrupt);
+    RUN_TEST(test_output_pins_do_not_raise_interrupt);
+    return UNITY_END();
+}
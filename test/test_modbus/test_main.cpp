@@ -0,0 +1,200 @@
+// Разбор запросов Modbus и запись в выходы: pio test -e native_test -f test_modbus
+
+#include <Arduino.h>
+#include <Preferences.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <unity.h>
+#include <vector>
+#include "emulator.h"
+#include "gpio_manager.h"
+#include "modbus_server.h"
+
+extern GPIOManager gpioManager;
+extern Preferences preferences;
+
+static ModbusServer modbusServer;
+
+// Доступ к закрытому разбору PDU (объявлен другом ModbusServer)
+struct ModbusServerTest {
+    static std::vector<uint8_t> request(std::vector<uint8_t> pdu) {
+        uint8_t response[260];
+        size_t length = modbusServer.processPdu(pdu.data(), pdu.size(), response);
+        return std::vector<uint8_t>(response, response + length);
+    }
+};
+
+static std::vector<uint8_t> request(std::vector<uint8_t> pdu) {
+    return ModbusServerTest::request(pdu);
+}
+
+static void assertResponse(std::vector<uint8_t> expected, std::vector<uint8_t> actual) {
+    TEST_ASSERT_EQUAL(expected.size(), actual.size());
+    for (size_t i = 0; i < expected.size() && i < actual.size(); i++) {
+        TEST_ASSERT_EQUAL(expected[i], actual[i]);
+    }
+}
+
+static void assertException(uint8_t function, uint8_t code, std::vector<uint8_t> pdu) {
+    assertResponse({(uint8_t)(function | 0x80), code}, request(pdu));
+}
+
+static void notifyChange(uint8_t pin, uint8_t) {
+    modbusServer.notifyChange(pin);
+}
+
+void setUp() {
+    // Команды записи и снимок обрабатывает основной цикл
+    modbusServer.handle();
+}
+
+void tearDown() {}
+
+static void test_read_coils() {
+    // Выходы 2, 5, 13, 16-18; высокий уровень у 5 и 13
+    assertResponse({0x01, 2, 0x20, 0x20}, request({0x01, 0, 0, 0, 16}));
+    // Лишние биты последнего байта обнуляются
+    assertResponse({0x01, 1, 0x00}, request({0x01, 0, 0, 0, 5}));
+    assertResponse({0x01, 1, 0x01}, request({0x01, 0, 5, 0, 1}));
+}
+
+static void test_read_discrete_inputs() {
+    // Вход 4 высокий; выходы в дискретных входах не видны
+    assertResponse({0x02, 1, 0x10}, request({0x02, 0, 0, 0, 8}));
+}
+
+static void test_read_holding_registers() {
+    // Пин 4 - вход (0), пин 5 - выход (1)
+    assertResponse({0x03, 4, 0, 0, 0, 1}, request({0x03, 0, 4, 0, 2}));
+}
+
+static void test_read_input_registers() {
+    modbusServer.notifyChange(4);
+    modbusServer.notifyChange(4);
+    modbusServer.handle();
+    assertResponse({0x04, 2, 0, 2}, request({0x04, 0, 4, 0, 1}));
+}
+
+static void test_write_single_coil() {
+    assertResponse({0x05, 0, 13, 0x00, 0x00}, request({0x05, 0, 13, 0x00, 0x00}));
+    modbusServer.handle();
+    TEST_ASSERT_EQUAL(LOW, gpioManager.getOutput(13));
+    assertResponse({0x01, 2, 0x20, 0x00}, request({0x01, 0, 0, 0, 16}));
+
+    assertException(0x05, 0x03, {0x05, 0, 13, 0x12, 0x34});
+    assertException(0x05, 0x02, {0x05, 0, 4, 0xFF, 0x00});     // Вход
+    assertException(0x05, 0x02, {0x05, 0, 64, 0xFF, 0x00});
+}
+
+static void test_write_single_register_is_limited_to_level() {
+    assertResponse({0x06, 0, 2, 0, 1}, request({0x06, 0, 2, 0, 1}));
+    modbusServer.handle();
+    TEST_ASSERT_EQUAL(HIGH, gpioManager.getOutput(2));
+
+    assertException(0x06, 0x03, {0x06, 0, 2, 0, 2});
+    assertException(0x06, 0x03, {0x06, 0, 2, 0x01, 0x00});
+    modbusServer.handle();
+    TEST_ASSERT_EQUAL(HIGH, gpioManager.getOutput(2));
+}
+
+static void test_write_multiple_coils_bitmap() {
+    // 16 = 1, 17 = 0, 18 = 1 одной командой
+    assertResponse({0x0F, 0, 16, 0, 3}, request({0x0F, 0, 16, 0, 3, 1, 0b101}));
+    modbusServer.handle();
+    TEST_ASSERT_EQUAL(HIGH, gpioManager.getOutput(16));
+    TEST_ASSERT_EQUAL(LOW, gpioManager.getOutput(17));
+    TEST_ASSERT_EQUAL(HIGH, gpioManager.getOutput(18));
+
+    // Диапазон с ненастроенным пином 19 отклоняется целиком
+    assertException(0x0F, 0x02, {0x0F, 0, 16, 0, 4, 1, 0b0000});
+    assertException(0x0F, 0x03, {0x0F, 0, 16, 0, 3, 2, 0, 0});   // Неверный byteCount
+    assertException(0x0F, 0x03, {0x0F, 0, 16, 0, 3, 1});         // Нет данных
+    modbusServer.handle();
+    TEST_ASSERT_EQUAL(HIGH, gpioManager.getOutput(16));
+    TEST_ASSERT_EQUAL(HIGH, gpioManager.getOutput(18));
+}
+
+static void test_write_multiple_registers() {
+    assertResponse({0x10, 0, 16, 0, 3}, request({0x10, 0, 16, 0, 3, 6, 0, 0, 0, 1, 0, 0}));
+    modbusServer.handle();
+    TEST_ASSERT_EQUAL(LOW, gpioManager.getOutput(16));
+    TEST_ASSERT_EQUAL(HIGH, gpioManager.getOutput(17));
+    TEST_ASSERT_EQUAL(LOW, gpioManager.getOutput(18));
+
+    // Значение больше 1 отклоняет весь запрос
+    assertException(0x10, 0x03, {0x10, 0, 16, 0, 3, 6, 0, 1, 0, 2, 0, 1});
+    modbusServer.handle();
+    TEST_ASSERT_EQUAL(LOW, gpioManager.getOutput(16));
+    TEST_ASSERT_EQUAL(HIGH, gpioManager.getOutput(17));
+}
+
+static void test_exceptions() {
+    assertException(0x07, 0x01, {0x07, 0, 0, 0, 0});
+    assertException(0x01, 0x02, {0x01, 0, 60, 0, 8});     // За пределами адресов
+    assertException(0x03, 0x02, {0x03, 0, 63, 0, 2});
+    assertException(0x01, 0x03, {0x01, 0, 0, 0, 0});      // Нулевое количество
+    assertException(0x03, 0x03, {0x03, 0, 0, 0, 126});
+    assertException(0x03, 0x03, {0x03, 0, 0});            // Короткий PDU
+}
+
+static void test_full_queue_reports_busy() {
+    for (int i = 0; i < MODBUS_WRITE_QUEUE_SIZE; i++) {
+        assertResponse({0x05, 0, 2, 0x00, 0x00}, request({0x05, 0, 2, 0x00, 0x00}));
+    }
+    assertException(0x05, 0x06, {0x05, 0, 2, 0xFF, 0x00});
+    assertException(0x0F, 0x06, {0x0F, 0, 16, 0, 3, 1, 0b111});
+    modbusServer.handle();
+    TEST_ASSERT_EQUAL(LOW, gpioManager.getOutput(2));
+    assertResponse({0x05, 0, 2, 0xFF, 0x00}, request({0x05, 0, 2, 0xFF, 0x00}));
+}
+
+int main() {
+    char nvs[] = "/tmp/modbus-test-nvs-XXXXXX";
+    close(mkstemp(nvs));
+    setenv("EMU_NVS_FILE", nvs, 1);
+    // Слушающий сокет задачи Modbus не должен конфликтовать с эмулятором
+    setenv("EMU_PORT_OFFSET", "30000", 1);
+    preferences.begin(NVS_CONFIG_NAMESPACE, false);
+
+    std::vector<PinConfig> pins;
+    const uint8_t outputs[] = {2, 5, 13, 16, 17, 18};
+    for (uint8_t pin : outputs) {
+        PinConfig config = {};
+        config.pin = pin;
+        strlcpy(config.type, "output", sizeof(config.type));
+        config.enabled = true;
+        pins.push_back(config);
+    }
+    PinConfig input = {};
+    input.pin = 4;
+    strlcpy(input.type, "input", sizeof(input.type));
+    strlcpy(input.mode, "pullup", sizeof(input.mode));
+    input.enabled = true;
+    pins.push_back(input);
+
+    emu::setExternalLevel(4, HIGH);
+    gpioManager.saveConfig(pins);
+    gpioManager.init();
+    gpioManager.setOutput(5, HIGH);
+    gpioManager.setOutput(13, HIGH);
+    gpioManager.onChange(notifyChange);
+    modbusServer.init();
+
+    UNITY_BEGIN();
+    RUN_TEST(test_read_coils);
+    RUN_TEST(test_read_discrete_inputs);
+    RUN_TEST(test_read_holding_registers);
+    RUN_TEST(test_read_input_registers);
+    RUN_TEST(test_write_single_coil);
+    RUN_TEST(test_write_single_register_is_limited_to_level);
+    RUN_TEST(test_write_multiple_coils_bitmap);
+    RUN_TEST(test_write_multiple_registers);
+    RUN_TEST(test_exceptions);
+    RUN_TEST(test_full_queue_reports_busy);
+    int result = UNITY_END();
+    unlink(nvs);
+    // Задача сервера не завершается; деструкторы глобальных объектов
+    // выполнялись бы параллельно с ней
+    fflush(stdout);
+    _exit(result);
+}
@@ -0,0 +1,209 @@
+// Публикации MQTT через брокер-заглушку эмулятора: pio test -e native_test -f test_mqtt
+
+#include <Arduino.h>
+#include <PubSubClient.h>
+#include <Preferences.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <unity.h>
+#include <vector>
+#include "gpio_manager.h"
+#include "mqtt_manager.h"
+
+extern Preferences preferences;
+extern GPIOManager gpioManager;
+
+static MQTTManager mqttManager;
+
+// Вызовы GPIOManager::setOutput, дошедшие из топиков /set
+struct OutputChange {
+    uint8_t pin;
+    uint8_t value;
+};
+static std::vector<OutputChange> outputChanges;
+
+static void recordChange(uint8_t pin, uint8_t value) {
+    outputChanges.push_back({pin, value});
+}
+
+void setUp() {}
+void tearDown() {}
+
+// Задача MQTT работает параллельно: ждём условие с таймаутом
+template <typename Predicate>
+static bool waitFor(Predicate predicate, unsigned long timeout = 2000) {
+    unsigned long start = millis();
+    while (!predicate()) {
+        if (millis() - start > timeout) return false;
+        delay(5);
+    }
+    return true;
+}
+
+static size_t countPublished(const char* topic) {
+    size_t count = 0;
+    for (const auto& message : emu::mqttBroker().published()) {
+        if (message.topic == topic) count++;
+    }
+    return count;
+}
+
+static void test_connect_announces_and_subscribes() {
+    emu::mqttBroker().setAvailable(true);
+
+    MQTTConfig config = {};
+    config.enabled = true;
+    strlcpy(config.host, "broker.test", sizeof(config.host));
+    config.port = MQTT_DEFAULT_PORT;
+    strlcpy(config.base_topic, "esp32_gpio", sizeof(config.base_topic));
+    TEST_ASSERT_TRUE(mqttManager.saveMQTTConfig(config));
+
+    TEST_ASSERT_TRUE(waitFor([] { return mqttManager.isConnected(); }));
+    mqttManager.handle();
+
+    auto retained = emu::mqttBroker().retained();
+    TEST_ASSERT_EQUAL_STRING("online", retained["esp32_gpio/status"].c_str());
+    auto subscriptions = emu::mqttBroker().subscriptions();
+    TEST_ASSERT_EQUAL(1, subscriptions.size());
+    TEST_ASSERT_EQUAL_STRING("esp32_gpio/pin/+/set", subscriptions[0].c_str());
+}
+
+static void test_pin_state_is_retained_per_pin() {
+    mqttManager.publishPinState(4, 1);
+    mqttManager.publishPinState(16, 0);
+
+    TEST_ASSERT_TRUE(waitFor([] { return emu::mqttBroker().retained().count("esp32_gpio/pin/16/state") > 0; }));
+    auto retained = emu::mqttBroker().retained();
+    TEST_ASSERT_EQUAL_STRING("1", retained["esp32_gpio/pin/4/state"].c_str());
+    TEST_ASSERT_EQUAL_STRING("0", retained["esp32_gpio/pin/16/state"].c_str());
+
+    for (const auto& message : emu::mqttBroker().published()) {
+        if (message.topic.find("/pin/") != std::string::npos) {
+            TEST_ASSERT_TRUE(message.retained);
+        }
+    }
+}
+
+// Команды приходят в задаче MQTT и выполняются в handle() основного цикла
+static bool waitForOutputChanges(size_t count) {
+    return waitFor([count] {
+        mqttManager.handle();
+        return outputChanges.size() >= count;
+    });
+}
+
+static void test_set_topic_drives_output() {
+    outputChanges.clear();
+    emu::mqttBroker().deliver("esp32_gpio/pin/2/set", "1");
+    TEST_ASSERT_TRUE(waitForOutputChanges(1));
+    TEST_ASSERT_EQUAL(2, outputChanges[0].pin);
+    TEST_ASSERT_EQUAL(HIGH, outputChanges[0].value);
+    TEST_ASSERT_EQUAL(HIGH, gpioManager.getOutput(2));
+
+    emu::mqttBroker().deliver("esp32_gpio/pin/2/set", "OFF");
+    emu::mqttBroker().deliver("esp32_gpio/pin/2/set", "true");
+    TEST_ASSERT_TRUE(waitForOutputChanges(3));
+    TEST_ASSERT_EQUAL(LOW, outputChanges[1].value);
+    TEST_ASSERT_EQUAL(HIGH, outputChanges[2].value);
+}
+
+static void test_set_topic_rejects_bad_pins_and_payloads() {
+    outputChanges.clear();
+    emu::mqttBroker().deliver("esp32_gpio/pin/4/set", "1");     // Вход
+    emu::mqttBroker().deliver("esp32_gpio/pin/13/set", "1");    // Не настроен
+    emu::mqttBroker().deliver("esp32_gpio/pin/64/set", "1");
+    emu::mqttBroker().deliver("esp32_gpio/pin/-1/set", "1");
+    emu::mqttBroker().deliver("esp32_gpio/pin/x/set", "1");
+    emu::mqttBroker().deliver("esp32_gpio/pin/2/state", "1");
+    emu::mqttBroker().deliver("other/pin/2/set", "1");
+    emu::mqttBroker().deliver("esp32_gpio/pin/2/set", "2");
+    emu::mqttBroker().deliver("esp32_gpio/pin/2/set", "255");
+    emu::mqttBroker().deliver("esp32_gpio/pin/2/set", "1x");
+    emu::mqttBroker().deliver("esp32_gpio/pin/2/set", "");
+    emu::mqttBroker().deliver("esp32_gpio/pin/2/set", "012345678");
+    // Сообщения обрабатываются по порядку: после этой команды все
+    // предыдущие уже разобраны
+    emu::mqttBroker().deliver("esp32_gpio/pin/16/set", "0");
+
+    TEST_ASSERT_TRUE(waitForOutputChanges(1));
+    mqttManager.handle();
+    TEST_ASSERT_EQUAL(1, outputChanges.size());
+    TEST_ASSERT_EQUAL(16, outputChanges[0].pin);
+    TEST_ASSERT_EQUAL(LOW, outputChanges[0].value);
+    TEST_ASSERT_EQUAL(HIGH, gpioManager.getOutput(2));
+}
+
+static void test_events_coalesce_while_broker_is_down() {
+    emu::mqttBroker().setAvailable(false);
+    TEST_ASSERT_TRUE(waitFor([] { return !mqttManager.isConnected(); }));
+    TEST_ASSERT_EQUAL_STRING("offline", emu::mqttBroker().retained()["esp32_gpio/status"].c_str());
+
+    size_t before = countPublished("esp32_gpio/pin/5/state");
+    MQTTStats stats = mqttManager.getStats();
+    for (int i = 0; i < 5; i++) {
+        mqttManager.publishPinState(5, i & 1);
+    }
+    MQTTStats queued = mqttManager.getStats();
+    TEST_ASSERT_EQUAL(stats.coalesced + 4, queued.coalesced);
+    TEST_ASSERT_EQUAL(1, queued.queueDepth);
+
+    // После переподключения уходит только последнее значение
+    emu::mqttBroker().setAvailable(true);
+    TEST_ASSERT_TRUE(waitFor([] { return mqttManager.getStats().queueDepth == 0 && mqttManager.isConnected(); }));
+    TEST_ASSERT_EQUAL(before + 1, countPublished("esp32_gpio/pin/5/state"));
+    TEST_ASSERT_EQUAL_STRING("0", emu::mqttBroker().retained()["esp32_gpio/pin/5/state"].c_str());
+    TEST_ASSERT_EQUAL_STRING("online", emu::mqttBroker().retained()["esp32_gpio/status"].c_str());
+    TEST_ASSERT_EQUAL(stats.connects + 1, mqttManager.getStats().connects);
+}
+
+static void test_reconnect_backs_off() {
+    emu::mqttBroker().setAvailable(false);
+    TEST_ASSERT_TRUE(waitFor([] { return !mqttManager.isConnected(); }));
+    uint32_t attempts = emu::mqttBroker().connectAttempts();
+
+    // Паузы растут: за 4 начальных интервала не больше 3 попыток (0, 1, 2, 4)
+    delay(MQTT_RECONNECT_INTERVAL * 4);
+    uint32_t made = emu::mqttBroker().connectAttempts() - attempts;
+    TEST_ASSERT_GREATER_OR_EQUAL(2, made);
+    TEST_ASSERT_LESS_OR_EQUAL(3, made);
+    TEST_ASSERT_GREATER_THAN(MQTT_RECONNECT_INTERVAL, mqttManager.getStats().retryInterval);
+
+    emu::mqttBroker().setAvailable(true);
+    TEST_ASSERT_TRUE(waitFor([] { return mqttManager.isConnected(); }, MQTT_RECONNECT_MAX_INTERVAL * 2));
+    TEST_ASSERT_EQUAL(MQTT_RECONNECT_INTERVAL, mqttManager.getStats().retryInterval);
+}
+
+int main() {
+    // NVS эмулятора - во временном файле, чтобы не трогать .emu_nvs
+    char nvs[] = "/tmp/mqtt-test-nvs-XXXXXX";
+    close(mkstemp(nvs));
+    setenv("EMU_NVS_FILE", nvs, 1);
+    preferences.begin(NVS_CONFIG_NAMESPACE, false);
+
+    // Выходы 2 и 16, вход 4; как в прошивке, конфигурация применяется в init()
+    std::vector<PinConfig> pins;
+    const uint8_t numbers[] = {2, 16, 4};
+    for (uint8_t pin : numbers) {
+        PinConfig config = {};
+        config.pin = pin;
+        strlcpy(config.type, pin == 4 ? "input" : "output", sizeof(config.type));
+        config.enabled = true;
+        pins.push_back(config);
+    }
+    gpioManager.saveConfig(pins);
+    gpioManager.init();
+    gpioManager.onChange(recordChange);
+
+    mqttManager.init();
+
+    UNITY_BEGIN();
+    RUN_TEST(test_connect_announces_and_subscribes);
+    RUN_TEST(test_pin_state_is_retained_per_pin);
+    RUN_TEST(test_set_topic_drives_output);
+    RUN_TEST(test_set_topic_rejects_bad_pins_and_payloads);
+    RUN_TEST(test_events_coalesce_while_broker_is_down);
+    RUN_TEST(test_reconnect_backs_off);
+    int result = UNITY_END();
+    unlink(nvs);
+    return result;
+}
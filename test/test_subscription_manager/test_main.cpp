@@ -0,0 +1,169 @@
+// Подписки WebSocket и ограничение частоты: pio test -e native_test -f test_subscription_manager
+
+#include <Arduino.h>
+#include <Preferences.h>
+#include <WebSocketsServer.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <unity.h>
+#include <string>
+#include <vector>
+#include "gpio_manager.h"
+#include "subscription_manager.h"
+
+extern GPIOManager gpioManager;
+extern Preferences preferences;
+
+static SubscriptionManager subscriptions;
+static std::vector<std::string> sent;     // Сообщения клиенту 0
+
+static void command(const char* text) {
+    WsCommand cmd;
+    TEST_ASSERT_EQUAL(WS_PARSE_OK, parseWsCommand((const uint8_t*)text, strlen(text), cmd, nullptr));
+    if (cmd.type == WS_CMD_SUBSCRIBE) {
+        subscriptions.subscribe(0, cmd);
+    } else {
+        subscriptions.unsubscribe(0, cmd);
+    }
+}
+
+static std::string pinMessage(uint8_t pin, uint8_t value) {
+    char buf[32];
+    snprintf(buf, sizeof(buf), "{\"pin\":%u,\"val\":%u}", pin, value);
+    return buf;
+}
+
+static size_t countPin(uint8_t pin) {
+    char prefix[16];
+    snprintf(prefix, sizeof(prefix), "{\"pin\":%u,", pin);
+    size_t count = 0;
+    for (const auto& message : sent) {
+        if (message.rfind(prefix, 0) == 0) count++;
+    }
+    return count;
+}
+
+void setUp() {
+    // Новый клиент получает все пины; начинаем без подписок
+    subscriptions.clientConnected(0);
+    command("{\"action\":\"unsubscribe\",\"topics\":[\"pins\"]}");
+    // Разнесённые во времени тесты не должны ограничивать друг друга
+    delay(350);
+    sent.clear();
+}
+
+void tearDown() {
+    subscriptions.clientDisconnected(0);
+}
+
+static void test_pin_interval_overrides_group() {
+    command("{\"action\":\"subscribe\",\"topics\":[\"inputs\"],\"rate\":300}");
+    command("{\"action\":\"subscribe\",\"pins\":[4],\"rate\":0}");
+    sent.clear();
+
+    // Пин 4 подписан отдельно без ограничения, пин 5 - только через inputs
+    subscriptions.publishPinState(4, 1);
+    subscriptions.publishPinState(4, 0);
+    subscriptions.publishPinState(5, 1);
+    subscriptions.publishPinState(5, 0);
+    TEST_ASSERT_EQUAL(2, countPin(4));
+    TEST_ASSERT_EQUAL(1, countPin(5));
+}
+
+static void test_smallest_topic_interval_applies() {
+    command("{\"action\":\"subscribe\",\"topics\":[\"pins\"],\"rate\":300}");
+    command("{\"action\":\"subscribe\",\"topics\":[\"inputs\"],\"rate\":50}");
+    sent.clear();
+
+    // Вход 4 получен через pins и inputs: действует 50 мс.
+    // Выход 2 - только через pins: 300 мс
+    subscriptions.publishPinState(4, 1);
+    subscriptions.publishPinState(2, 1);
+    delay(80);
+    subscriptions.publishPinState(4, 0);
+    subscriptions.publishPinState(2, 0);
+    TEST_ASSERT_EQUAL(2, countPin(4));
+    TEST_ASSERT_EQUAL(1, countPin(2));
+}
+
+static void test_rate_limited_updates_coalesce_to_latest() {
+    command("{\"action\":\"subscribe\",\"topics\":[\"inputs\"],\"rate\":100}");
+    sent.clear();
+
+    subscriptions.publishPinState(4, 1);
+    subscriptions.publishPinState(4, 0);
+    subscriptions.publishPinState(4, 1);
+    subscriptions.publishPinState(4, 0);
+    TEST_ASSERT_EQUAL(1, sent.size());
+    TEST_ASSERT_EQUAL_STRING(pinMessage(4, 1).c_str(), sent[0].c_str());
+
+    // До конца интервала отложенное значение не уходит
+    subscriptions.handle(millis());
+    TEST_ASSERT_EQUAL(1, sent.size());
+
+    delay(120);
+    subscriptions.handle(millis());
+    subscriptions.handle(millis());
+    TEST_ASSERT_EQUAL(2, sent.size());
+    TEST_ASSERT_EQUAL_STRING(pinMessage(4, 0).c_str(), sent[1].c_str());
+}
+
+static void test_unsubscribe_resets_interval() {
+    command("{\"action\":\"subscribe\",\"topics\":[\"inputs\"],\"pins\":[2],\"rate\":300}");
+    command("{\"action\":\"unsubscribe\",\"topics\":[\"inputs\"],\"pins\":[2]}");
+    // Повторная подписка без rate - без ограничения
+    command("{\"action\":\"subscribe\",\"topics\":[\"inputs\"],\"pins\":[2]}");
+    sent.clear();
+
+    subscriptions.publishPinState(4, 1);
+    subscriptions.publishPinState(4, 0);
+    subscriptions.publishPinState(2, 1);
+    subscriptions.publishPinState(2, 0);
+    TEST_ASSERT_EQUAL(2, countPin(4));
+    TEST_ASSERT_EQUAL(2, countPin(2));
+}
+
+static void test_unsubscribed_pin_is_not_sent() {
+    command("{\"action\":\"subscribe\",\"topics\":[\"outputs\"]}");
+    sent.clear();
+
+    subscriptions.publishPinState(4, 1);
+    subscriptions.publishPinState(2, 1);
+    TEST_ASSERT_EQUAL(0, countPin(4));
+    TEST_ASSERT_EQUAL(1, countPin(2));
+}
+
+int main() {
+    char nvs[] = "/tmp/subscription-test-nvs-XXXXXX";
+    close(mkstemp(nvs));
+    setenv("EMU_NVS_FILE", nvs, 1);
+    preferences.begin(NVS_CONFIG_NAMESPACE, false);
+
+    // Выход 2, входы 4 и 5
+    std::vector<PinConfig> pins;
+    const uint8_t numbers[] = {2, 4, 5};
+    for (uint8_t pin : numbers) {
+        PinConfig config = {};
+        config.pin = pin;
+        strlcpy(config.type, pin == 2 ? "output" : "input", sizeof(config.type));
+        config.enabled = true;
+        pins.push_back(config);
+    }
+    gpioManager.saveConfig(pins);
+    gpioManager.init();
+
+    emu::setWebSocketTap([](uint8_t num, const std::string& payload) {
+        if (num == 0) sent.push_back(payload);
+    });
+
+    UNITY_BEGIN();
+    RUN_TEST(test_pin_interval_overrides_group);
+    RUN_TEST(test_smallest_topic_interval_applies);
+    RUN_TEST(test_rate_limited_updates_coalesce_to_latest);
+    RUN_TEST(test_unsubscribe_resets_interval);
+    RUN_TEST(test_unsubscribed_pin_is_not_sent);
+    int result = UNITY_END();
+    unlink(nvs);
+    return result;
+}
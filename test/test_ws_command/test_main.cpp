@@ -0,0 +1,115 @@
+// Разбор команд WebSocket: pio test -e native_test -f test_ws_command
+
+#include <string.h>
+#include <unity.h>
+#include "ws_command.h"
+
+void setUp() {}
+void tearDown() {}
+
+static WsParseError parse(const char* text, WsCommand& cmd, size_t* errorPos = nullptr) {
+    return parseWsCommand((const uint8_t*)text, strlen(text), cmd, errorPos);
+}
+
+static void test_set() {
+    WsCommand cmd;
+    TEST_ASSERT_EQUAL(WS_PARSE_OK, parse("{\"pin\":2,\"val\":1}", cmd));
+    TEST_ASSERT_EQUAL(WS_CMD_SET, cmd.type);
+    TEST_ASSERT_EQUAL(1, cmd.count);
+    TEST_ASSERT_EQUAL(2, cmd.items[0].pin);
+    TEST_ASSERT_EQUAL(1, cmd.items[0].value);
+    TEST_ASSERT_FALSE(cmd.hasId);
+}
+
+static void test_set_rejects_level_above_one() {
+    WsCommand cmd;
+    size_t pos = 0;
+    TEST_ASSERT_EQUAL(WS_PARSE_BAD_NUMBER, parse("{\"pin\":2,\"val\":2}", cmd, &pos));
+    TEST_ASSERT_EQUAL(WS_CMD_NONE, cmd.type);
+    TEST_ASSERT_EQUAL(16, pos);
+    TEST_ASSERT_EQUAL(WS_PARSE_BAD_NUMBER, parse("{\"pin\":2,\"val\":255}", cmd));
+    TEST_ASSERT_EQUAL(WS_PARSE_BAD_NUMBER, parse("{\"batch\":[[2,1],[4,255]]}", cmd));
+    TEST_ASSERT_EQUAL(0, cmd.count);
+}
+
+static void test_batch_with_id() {
+    WsCommand cmd;
+    TEST_ASSERT_EQUAL(WS_PARSE_OK, parse("{\"batch\":[[2,1],[4,0]],\"id\":4294967295,\"cid\":7}", cmd));
+    TEST_ASSERT_EQUAL(WS_CMD_BATCH_SET, cmd.type);
+    TEST_ASSERT_EQUAL(2, cmd.count);
+    TEST_ASSERT_EQUAL(4, cmd.items[1].pin);
+    TEST_ASSERT_EQUAL(0, cmd.items[1].value);
+    TEST_ASSERT_TRUE(cmd.hasId);
+    TEST_ASSERT_EQUAL_UINT32(4294967295u, cmd.id);
+    TEST_ASSERT_EQUAL_UINT32(7, cmd.clientId);
+}
+
+static void test_batch_overflow() {
+    char frame[WS_MAX_FRAME_SIZE];
+    int len = snprintf(frame, sizeof(frame), "{\"batch\":[");
+    for (int i = 0; i <= WS_BATCH_MAX; i++) {
+        len += snprintf(frame + len, sizeof(frame) - len, "%s[%d,1]", i ? "," : "", i);
+    }
+    snprintf(frame + len, sizeof(frame) - len, "]}");
+
+    WsCommand cmd;
+    TEST_ASSERT_EQUAL(WS_PARSE_BATCH_OVERFLOW, parse(frame, cmd));
+}
+
+static void test_query() {
+    WsCommand cmd;
+    TEST_ASSERT_EQUAL(WS_PARSE_OK, parse("{\"action\":\"getStates\"}", cmd));
+    TEST_ASSERT_EQUAL(WS_CMD_QUERY, cmd.type);
+    TEST_ASSERT_FALSE(cmd.hasPin);
+    TEST_ASSERT_FALSE(cmd.hasId);
+
+    TEST_ASSERT_EQUAL(WS_PARSE_OK, parse(" { \"pin\" : 40 , \"action\" : \"getStates\" } ", cmd));
+    TEST_ASSERT_EQUAL(WS_CMD_QUERY, cmd.type);
+    TEST_ASSERT_TRUE(cmd.hasPin);
+    TEST_ASSERT_EQUAL(40, cmd.items[0].pin);
+}
+
+static void test_ping() {
+    WsCommand cmd;
+    TEST_ASSERT_EQUAL(WS_PARSE_OK, parse("{\"action\":\"ping\"}", cmd));
+    TEST_ASSERT_EQUAL(WS_CMD_PING, cmd.type);
+    TEST_ASSERT_EQUAL(0, cmd.count);
+    TEST_ASSERT_FALSE(cmd.hasPin);
+    TEST_ASSERT_EQUAL(WS_PARSE_UNKNOWN_ACTION, parse("{\"action\":\"pong\"}", cmd));
+}
+
+static void test_field_combinations() {
+    WsCommand cmd;
+    TEST_ASSERT_EQUAL(WS_PARSE_MISSING_FIELD, parse("{\"pin\":2}", cmd));
+    TEST_ASSERT_EQUAL(WS_PARSE_MISSING_FIELD, parse("{\"pin\":2,\"val\":1,\"cid\":3}", cmd));
+    TEST_ASSERT_EQUAL(WS_PARSE_CONFLICT, parse("{\"action\":\"ping\",\"id\":1}", cmd));
+    TEST_ASSERT_EQUAL(WS_PARSE_DUPLICATE_KEY, parse("{\"pin\":2,\"pin\":3,\"val\":1}", cmd));
+    TEST_ASSERT_EQUAL(WS_PARSE_BAD_NUMBER, parse("{\"pin\":2,\"val\":1,\"id\":1,\"cid\":0}", cmd));
+    TEST_ASSERT_EQUAL(WS_PARSE_SYNTAX, parse("{\"pin\":2,\"val\":1} x", cmd));
+}
+
+static void test_subscribe() {
+    WsCommand cmd;
+    TEST_ASSERT_EQUAL(WS_PARSE_OK,
+                      parse("{\"action\":\"subscribe\",\"topics\":[\"inputs\",\"telemetry\"],\"pins\":[2,63],\"rate\":250}", cmd));
+    TEST_ASSERT_EQUAL(WS_CMD_SUBSCRIBE, cmd.type);
+    TEST_ASSERT_EQUAL(WS_TOPIC_INPUTS | WS_TOPIC_TELEMETRY, cmd.topics);
+    TEST_ASSERT_TRUE(cmd.pinMask == ((1ULL << 2) | (1ULL << 63)));
+    TEST_ASSERT_TRUE(cmd.hasRate);
+    TEST_ASSERT_EQUAL(250, cmd.rate);
+    TEST_ASSERT_EQUAL(WS_PARSE_UNKNOWN_TOPIC, parse("{\"action\":\"subscribe\",\"topics\":[\"x\"]}", cmd));
+    TEST_ASSERT_EQUAL(WS_PARSE_BAD_NUMBER, parse("{\"action\":\"subscribe\",\"pins\":[64]}", cmd));
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_set);
+    RUN_TEST(test_set_rejects_level_above_one);
+    RUN_TEST(test_batch_with_id);
+    RUN_TEST(test_batch_overflow);
+    RUN_TEST(test_query);
+    RUN_TEST(test_ping);
+    RUN_TEST(test_field_combinations);
+    RUN_TEST(test_subscribe);
+    return UNITY_END();
+}
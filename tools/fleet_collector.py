@@ -0,0 +1,492 @@
+#!/usr/bin/env python3
+"""Сборщик объявлений и датаграмм состояния устройств по UDP multicast.
+
+Один сокет, подписанный на группу 239.255.70.71:4270, принимает:
+  * объявления (JSON, type=announce) - версия прошивки, адрес, сводка пинов;
+  * двоичные датаграммы состояния (48 байт, см. src/fleet_announcer.h) -
+    номер последовательности и битовые маски входов и выходов.
+
+Для каждого устройства ведётся: когда видели последний раз, версия, адрес,
+потерянные датаграммы по пропускам в номерах, частота датаграмм и текущие
+уровни пинов. Раз в --report секунд печатается таблица.
+
+С --spawn N сборщик сам запускает N эмуляторов (.pio/build/native/program)
+с разными портами и MAC, включает на них поток состояний, переключает
+входы через управляющий канал и проверяет, что датаграммы отражают уровни:
+задержка от фронта до датаграммы, фронты, не дошедшие за --timeout или
+перекрытые следующим фронтом того же пина.
+
+Только стандартная библиотека Python 3.8+.
+
+  python3 tools/fleet_collector.py --interface 192.168.1.20
+  python3 tools/fleet_collector.py --spawn 8 --inputs 4,5 --duration 60
+"""
+
+import argparse
+import asyncio
+import json
+import os
+import shutil
+import signal
+import socket
+import struct
+import subprocess
+import tempfile
+import time
+
+FLEET_GROUP = "239.255.70.71"   # config.h, FLEET_MULTICAST_GROUP
+FLEET_PORT = 4270               # config.h, FLEET_MULTICAST_PORT
+DEBOUNCE_DELAY_MS = 50          # config.h
+
+STATE_FORMAT = "<2sBBIII4Q"     # FleetStatePacket
+STATE_SIZE = struct.calcsize(STATE_FORMAT)
+STATE_MAGIC = b"GS"
+STATE_VERSION = 1
+HEARTBEAT_FLAG = 0x01
+
+SPAWN_PORT_BASE = 20000         # смещение портов первого эмулятора
+SPAWN_PORT_STEP = 10
+SPAWN_MAC_BASE = 0xF1EE00       # идентификатор первого эмулятора
+
+
+def percentile(values, fraction):
+    if not values:
+        return 0.0
+    ordered = sorted(values)
+    index = min(len(ordered) - 1, int(round(fraction * (len(ordered) - 1))))
+    return ordered[index]
+
+
+def parse_pins(text):
+    return [int(p) for p in text.split(",") if p.strip()] if text else []
+
+
+def pin_list(mask):
+    return [pin for pin in range(64) if mask & (1 << pin)]
+
+
+class Device:
+    """Всё, что известно об устройстве по его датаграммам."""
+
+    def __init__(self, device_id):
+        self.id = device_id
+        self.version = "?"
+        self.ip = "?"
+        self.source = None
+        self.first_seen = time.monotonic()
+        self.last_seen = self.first_seen
+        self.announces = 0
+        self.states = 0
+        self.heartbeats = 0
+        self.lost = 0
+        self.reordered = 0
+        self.restarts = 0
+        self.sequence = None
+        self.uptime = 0
+        self.input_mask = 0
+        self.inputs = 0
+        self.output_mask = 0
+        self.outputs = 0
+        self.window_states = 0
+
+    def on_announce(self, message, source):
+        self.announces += 1
+        self.version = message.get("ver", "?")
+        self.ip = message.get("ip", "?")
+        self.source = source
+        self.input_mask = int(message.get("in", "0"), 16)
+        self.output_mask = int(message.get("out", "0"), 16)
+
+    def on_state(self, sequence, flags, uptime, input_mask, inputs, output_mask, outputs):
+        self.states += 1
+        self.window_states += 1
+        if flags & HEARTBEAT_FLAG:
+            self.heartbeats += 1
+
+        if self.sequence is not None:
+            gap = (sequence - self.sequence) & 0xFFFFFFFF
+            if uptime < self.uptime or sequence == 1:
+                # Перезагрузка: нумерация начинается заново
+                self.restarts += 1
+            elif gap == 0 or gap > 0x80000000:
+                self.reordered += 1
+                return False
+            else:
+                self.lost += gap - 1
+        self.sequence = sequence
+        self.uptime = uptime
+        self.input_mask = input_mask
+        self.inputs = inputs
+        self.output_mask = output_mask
+        self.outputs = outputs
+        return True
+
+    def level(self, pin):
+        return (self.inputs >> pin) & 1
+
+
+class Collector(asyncio.DatagramProtocol):
+    def __init__(self, on_state=None):
+        self.devices = {}
+        self.on_state = on_state
+        self.datagrams = 0
+        self.malformed = 0
+
+    def device(self, device_id):
+        if device_id not in self.devices:
+            self.devices[device_id] = Device(device_id)
+        device = self.devices[device_id]
+        device.last_seen = time.monotonic()
+        return device
+
+    def datagram_received(self, data, addr):
+        self.datagrams += 1
+        if len(data) == STATE_SIZE and data[:2] == STATE_MAGIC:
+            self.state_received(data)
+        elif data[:1] == b"{":
+            self.announce_received(data, addr)
+        else:
+            self.malformed += 1
+
+    def state_received(self, data):
+        (_, version, flags, device_id, sequence, uptime,
+         input_mask, inputs, output_mask, outputs) = struct.unpack(STATE_FORMAT, data)
+        if version != STATE_VERSION:
+            self.malformed += 1
+            return
+        device = self.device(device_id)
+        if device.on_state(sequence, flags, uptime, input_mask, inputs, output_mask, outputs) and self.on_state:
+            self.on_state(device)
+
+    def announce_received(self, data, addr):
+        try:
+            message = json.loads(data)
+            # "esp32gpio-ccddee" -> 0xccddee, тот же id, что в датаграммах состояния
+            device_id = int(message["id"].rsplit("-", 1)[1], 16)
+        except (ValueError, KeyError, IndexError):
+            self.malformed += 1
+            return
+        if message.get("type") != "announce":
+            self.malformed += 1
+            return
+        self.device(device_id).on_announce(message, addr[0])
+
+
+def open_socket(interface):
+    sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM, socket.IPPROTO_UDP)
+    sock.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
+    if hasattr(socket, "SO_REUSEPORT"):
+        sock.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEPORT, 1)
+    sock.bind(("", FLEET_PORT))
+    membership = socket.inet_aton(FLEET_GROUP) + socket.inet_aton(interface)
+    sock.setsockopt(socket.IPPROTO_IP, socket.IP_ADD_MEMBERSHIP, membership)
+    sock.setblocking(False)
+    return sock
+
+
+def print_table(collector, window):
+    now = time.monotonic()
+    print(f"\n--- {len(collector.devices)} devices, {collector.datagrams} datagrams, "
+          f"{collector.malformed} malformed ---")
+    print(f"{'id':>8} {'version':>8} {'ip':>15} {'seen':>6} {'ann':>5} {'states':>7} "
+          f"{'rate/s':>7} {'lost':>5} {'inputs':>16} {'outputs':>16}")
+    for device in sorted(collector.devices.values(), key=lambda d: d.id):
+        rate = device.window_states / window if window > 0 else 0
+        device.window_states = 0
+        print(f"{device.id:>8x} {device.version:>8} {device.ip:>15} {now - device.last_seen:>5.1f}s "
+              f"{device.announces:>5} {device.states:>7} {rate:>7.1f} {device.lost:>5} "
+              f"{device.inputs & device.input_mask:>16x} {device.outputs & device.output_mask:>16x}")
+
+
+def device_summary(device):
+    return {
+        "id": f"{device.id:06x}",
+        "version": device.version,
+        "ip": device.ip,
+        "announces": device.announces,
+        "states": device.states,
+        "heartbeats": device.heartbeats,
+        "lost": device.lost,
+        "reordered": device.reordered,
+        "restarts": device.restarts,
+        "inputs": pin_list(device.input_mask),
+        "outputs": pin_list(device.output_mask),
+        "input_levels": f"{device.inputs & device.input_mask:016x}",
+        "output_levels": f"{device.outputs & device.output_mask:016x}",
+    }
+
+
+# ==================== Эмуляторы ====================
+
+class Emulator:
+    """Процесс эмулятора со своими портами, MAC, файловой системой и NVS."""
+
+    def __init__(self, args, index, workdir):
+        self.index = index
+        self.offset = SPAWN_PORT_BASE + SPAWN_PORT_STEP * index
+        self.device_id = SPAWN_MAC_BASE + index
+        self.root = os.path.join(workdir, f"dev{index}")
+        self.http_port = 80 + self.offset
+        self.control_port = 7000 + self.offset
+        shutil.copytree(args.data, self.root)
+        env = dict(os.environ,
+                   EMU_PORT_OFFSET=str(self.offset),
+                   EMU_FS_ROOT=self.root,
+                   EMU_NVS_FILE=os.path.join(workdir, f"nvs{index}.json"),
+                   EMU_MAC=f"{self.device_id << 24:x}",
+                   EMU_MULTICAST_IF=args.interface)
+        self.log = open(os.path.join(workdir, f"dev{index}.log"), "wb")
+        self.process = subprocess.Popen([args.emulator], env=env, stdout=self.log, stderr=subprocess.STDOUT)
+        self.control_reader = None
+        self.control_writer = None
+        # Пин -> (уровень, время фронта), ещё не отражённые датаграммой
+        self.pending = {}
+        self.expected = {}
+
+    async def http_request(self, method, path, body=b""):
+        reader, writer = await asyncio.open_connection("127.0.0.1", self.http_port)
+        writer.write((f"{method} {path} HTTP/1.1\r\nHost: 127.0.0.1\r\n"
+                      f"Content-Type: application/json\r\nContent-Length: {len(body)}\r\n"
+                      "Connection: close\r\n\r\n").encode() + body)
+        await writer.drain()
+        response = await asyncio.wait_for(reader.read(), 5)
+        writer.close()
+        return response
+
+    async def wait_ready(self):
+        for _ in range(60):
+            if self.process.poll() is not None:
+                raise SystemExit(f"emulator {self.index} exited with code {self.process.returncode}")
+            try:
+                await self.http_request("GET", "/api/info")
+                return
+            except (OSError, asyncio.TimeoutError):
+                await asyncio.sleep(0.5)
+        raise SystemExit(f"emulator {self.index} did not start")
+
+    async def configure(self, args):
+        await self.wait_ready()
+        fleet = {"announce": True, "state": True, "heartbeat": args.heartbeat}
+        await self.http_request("POST", "/api/fleet", json.dumps(fleet).encode())
+        if args.inputs:
+            pins = [{"pin": p, "name": f"in{p}", "type": "input", "mode": "pullup"} for p in args.inputs]
+            await self.http_request("POST", "/api/config", json.dumps({"pins": pins}).encode())
+            # Конфигурация пинов применяется после перезагрузки
+            await self.http_request("GET", "/api/reboot")
+            await asyncio.sleep(2)
+            await self.wait_ready()
+
+    async def control(self, line):
+        if self.control_writer is None:
+            self.control_reader, self.control_writer = await asyncio.open_connection("127.0.0.1", self.control_port)
+        try:
+            self.control_writer.write((line + "\n").encode())
+            await self.control_writer.drain()
+            reply = await asyncio.wait_for(self.control_reader.readline(), 5)
+            if not reply:
+                raise ConnectionError("control channel closed")
+            return reply.decode().strip()
+        except (OSError, asyncio.TimeoutError, ConnectionError):
+            self.control_writer.close()
+            self.control_writer = None
+            raise
+
+    def stop(self):
+        if self.control_writer is not None:
+            self.control_writer.close()
+        if self.process.poll() is None:
+            self.process.terminate()
+            try:
+                self.process.wait(5)
+            except subprocess.TimeoutExpired:
+                self.process.kill()
+        self.log.close()
+
+
+class FleetTest:
+    def __init__(self, args):
+        self.args = args
+        self.collector = Collector(self.on_state)
+        self.stop = asyncio.Event()
+        self.emulators = {}
+        self.latencies = []
+        self.edges = 0
+        self.missed = 0
+        self.control_errors = 0
+
+    def on_state(self, device):
+        emulator = self.emulators.get(device.id)
+        if emulator is None:
+            return
+        now = time.monotonic()
+        for pin, (level, when) in list(emulator.pending.items()):
+            if device.level(pin) == level:
+                self.latencies.append((now - when) * 1000)
+                del emulator.pending[pin]
+
+    async def toggler(self, emulator, pin, offset):
+        period = self.args.period / 1000.0
+        level = 1
+        await asyncio.sleep(offset)
+        while not self.stop.is_set():
+            level ^= 1
+            when = time.monotonic()
+            try:
+                await emulator.control(f"set {pin} {level}")
+            except (OSError, asyncio.TimeoutError, ConnectionError):
+                self.control_errors += 1
+                await asyncio.sleep(1)
+                continue
+            self.edges += 1
+            # Предыдущий фронт так и не отразился в датаграммах
+            if pin in emulator.pending:
+                self.missed += 1
+            emulator.pending[pin] = (level, when)
+            emulator.expected[pin] = level
+            await asyncio.sleep(period)
+
+    def expire(self):
+        now = time.monotonic()
+        for emulator in self.emulators.values():
+            for pin, (level, when) in list(emulator.pending.items()):
+                if now - when >= self.args.timeout:
+                    self.missed += 1
+                    del emulator.pending[pin]
+
+    async def reporter(self):
+        last = time.monotonic()
+        while not self.stop.is_set():
+            try:
+                await asyncio.wait_for(self.stop.wait(), self.args.report)
+            except asyncio.TimeoutError:
+                pass
+            now = time.monotonic()
+            self.expire()
+            print_table(self.collector, now - last)
+            if self.emulators:
+                print(f"edges {self.edges}, missed {self.missed}, "
+                      f"latency p50 {percentile(self.latencies, 0.5):.1f} ms, "
+                      f"p99 {percentile(self.latencies, 0.99):.1f} ms")
+            last = now
+
+    def mismatches(self):
+        # После остановки переключений последняя датаграмма должна совпадать с уровнями
+        result = 0
+        for emulator in self.emulators.values():
+            device = self.collector.devices.get(emulator.device_id)
+            for pin, level in emulator.expected.items():
+                if device is None or device.level(pin) != level:
+                    result += 1
+        return result
+
+    async def run(self):
+        loop = asyncio.get_event_loop()
+        for sig in (signal.SIGINT, signal.SIGTERM):
+            loop.add_signal_handler(sig, self.stop.set)
+
+        transport, _ = await loop.create_datagram_endpoint(lambda: self.collector,
+                                                           sock=open_socket(self.args.interface))
+        workdir = tempfile.mkdtemp(prefix="fleet-")
+        try:
+            if self.args.spawn:
+                for index in range(self.args.spawn):
+                    emulator = Emulator(self.args, index, workdir)
+                    self.emulators[emulator.device_id] = emulator
+                await asyncio.gather(*(e.configure(self.args) for e in self.emulators.values()))
+            return await self.measure()
+        finally:
+            for emulator in self.emulators.values():
+                emulator.stop()
+            transport.close()
+            shutil.rmtree(workdir, ignore_errors=True)
+
+    async def measure(self):
+        started = time.monotonic()
+        reporter = asyncio.ensure_future(self.reporter())
+        period = self.args.period / 1000.0
+        total = max(1, len(self.emulators) * len(self.args.inputs))
+        tasks = []
+        for i, emulator in enumerate(self.emulators.values()):
+            for j, pin in enumerate(self.args.inputs):
+                offset = period * (i * len(self.args.inputs) + j) / total
+                tasks.append(asyncio.ensure_future(self.toggler(emulator, pin, offset)))
+
+        if self.args.duration > 0:
+            try:
+                await asyncio.wait_for(self.stop.wait(), self.args.duration)
+            except asyncio.TimeoutError:
+                pass
+        else:
+            await self.stop.wait()
+        for task in tasks:
+            task.cancel()
+        await asyncio.gather(*tasks, return_exceptions=True)
+        # Последние фронты успевают дойти до сборщика
+        if tasks:
+            await asyncio.sleep(self.args.timeout)
+        self.stop.set()
+        await reporter
+        self.expire()
+
+        summary = {
+            "duration_s": round(time.monotonic() - started, 1),
+            "datagrams": self.collector.datagrams,
+            "malformed": self.collector.malformed,
+            "devices": [device_summary(d) for d in sorted(self.collector.devices.values(), key=lambda d: d.id)],
+        }
+        if self.emulators:
+            missing = [f"{e.device_id:06x}" for e in self.emulators.values()
+                       if e.device_id not in self.collector.devices]
+            summary.update({
+                "spawned": len(self.emulators),
+                "missing_devices": missing,
+                "edges": self.edges,
+                "missed": self.missed,
+                "final_mismatches": self.mismatches(),
+                "control_errors": self.control_errors,
+                "lost_datagrams": sum(d.lost for d in self.collector.devices.values()),
+                "latency_p50_ms": round(percentile(self.latencies, 0.5), 2),
+                "latency_p99_ms": round(percentile(self.latencies, 0.99), 2),
+                "latency_max_ms": round(max(self.latencies, default=0), 2),
+            })
+        return summary
+
+
+def main():
+    parser = argparse.ArgumentParser(description="UDP multicast fleet collector for the GPIO controller")
+    parser.add_argument("--interface", default=None,
+                        help="local address to join the group on (default 0.0.0.0, 127.0.0.1 with --spawn)")
+    parser.add_argument("--spawn", type=int, default=0, help="start this many emulators and test them")
+    parser.add_argument("--emulator", default=".pio/build/native/program", help="emulator binary for --spawn")
+    parser.add_argument("--data", default="data", help="web files copied into each emulator's file system")
+    parser.add_argument("--inputs", type=parse_pins, default=[], help="input pins to toggle with --spawn, e.g. 4,5")
+    parser.add_argument("--period", type=int, default=500, help="toggle period per input pin, ms (default 500)")
+    parser.add_argument("--heartbeat", type=int, default=1000, help="heartbeat configured with --spawn, ms")
+    parser.add_argument("--timeout", type=float, default=2.0,
+                        help="an edge not seen in a state datagram within this many seconds "
+                             "(or before the next edge on the pin) counts as missed")
+    parser.add_argument("--duration", type=float, default=0, help="seconds, 0 = until Ctrl+C")
+    parser.add_argument("--report", type=float, default=5, help="report interval, seconds")
+    parser.add_argument("--json", help="write the summary to this file")
+    args = parser.parse_args()
+
+    if args.interface is None:
+        args.interface = "127.0.0.1" if args.spawn else "0.0.0.0"
+    if args.spawn and args.period <= 2 * DEBOUNCE_DELAY_MS:
+        parser.error(f"--period must be above {2 * DEBOUNCE_DELAY_MS} ms or edges are lost to debounce")
+    if args.spawn and not os.path.exists(args.emulator):
+        parser.error(f"{args.emulator} not found, build it with: pio run -e native")
+
+    summary = asyncio.get_event_loop().run_until_complete(FleetTest(args).run())
+
+    print("\n=== summary ===")
+    for key, value in summary.items():
+        if key != "devices":
+            print(f"{key:>20}: {value}")
+    if args.json:
+        with open(args.json, "w") as f:
+            json.dump(summary, f, indent=2)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,515 @@
+#!/usr/bin/env python3
+"""Нагрузочный и длительный (soak) тест прошивки, запущенной в эмуляторе.
+
+Сценарий:
+  * через управляющий канал эмулятора (порт 7000) входы переключаются
+    с заданным периодом, как это делала бы внешняя схема;
+  * N клиентов WebSocket получают изменения пинов, для каждого изменения
+    замеряется задержка от фронта до клиента;
+  * M клиентов HTTP опрашивают /api/info;
+  * при необходимости один из клиентов WebSocket переключает выходы
+    командами с id; задержка ack - это сеть плюс обработка в прошивке,
+    RTT по ping устройства (/api/clients) - только сеть.
+
+Раз в --report секунд печатается сводка: пропускная способность,
+p50/p99 задержки, потерянные обновления, рост кучи и RSS процесса.
+Итог в конце прогона (по --duration или Ctrl+C), при --json - в файл.
+
+Только стандартная библиотека Python 3.8+.
+
+  python3 tools/loadgen.py --inputs 4,5,13,14 --outputs 2,16 \\
+      --configure --ws-clients 4 --http-clients 2 --duration 3600
+"""
+
+import argparse
+import asyncio
+import base64
+import json
+import os
+import signal
+import struct
+import time
+
+DEBOUNCE_DELAY_MS = 50          # config.h, период переключения должен быть больше
+
+
+def percentile(values, fraction):
+    if not values:
+        return 0.0
+    ordered = sorted(values)
+    index = min(len(ordered) - 1, int(round(fraction * (len(ordered) - 1))))
+    return ordered[index]
+
+
+def parse_pins(text):
+    return [int(p) for p in text.split(",") if p.strip()] if text else []
+
+
+class Stats:
+    """Счётчики за интервал отчёта и за весь прогон."""
+
+    def __init__(self):
+        self.total = {}
+        self.window = {}
+        self.latency_total = []
+        self.latency_window = []
+        self.http_total = []
+        self.http_window = []
+        self.ack_total = []
+        self.ack_window = []
+
+    def add(self, name, value=1):
+        self.total[name] = self.total.get(name, 0) + value
+        self.window[name] = self.window.get(name, 0) + value
+
+    def latency(self, ms):
+        self.latency_total.append(ms)
+        self.latency_window.append(ms)
+
+    def http(self, ms):
+        self.http_total.append(ms)
+        self.http_window.append(ms)
+
+    def ack(self, ms):
+        self.ack_total.append(ms)
+        self.ack_window.append(ms)
+
+    def reset_window(self):
+        self.window = {}
+        self.latency_window = []
+        self.http_window = []
+        self.ack_window = []
+
+
+# ==================== Управляющий канал ====================
+
+class Control:
+    def __init__(self, host, port):
+        self.host = host
+        self.port = port
+        self.lock = asyncio.Lock()
+        self.reader = None
+        self.writer = None
+
+    async def command(self, line):
+        async with self.lock:
+            if self.writer is None:
+                self.reader, self.writer = await asyncio.open_connection(self.host, self.port)
+            try:
+                self.writer.write((line + "\n").encode())
+                await self.writer.drain()
+                reply = await asyncio.wait_for(self.reader.readline(), 5)
+                if not reply:
+                    raise ConnectionError("control channel closed")
+                return reply.decode().strip()
+            except (OSError, asyncio.TimeoutError, ConnectionError):
+                self.writer.close()
+                self.writer = None
+                raise
+
+    async def stats(self):
+        reply = await self.command("stats")
+        return {k: int(v) for k, v in (item.split("=") for item in reply.split())}
+
+
+# ==================== WebSocket ====================
+
+class WsClient:
+    """Минимальный клиент RFC 6455: текстовые кадры без фрагментации."""
+
+    def __init__(self, host, port):
+        self.host = host
+        self.port = port
+        self.reader = None
+        self.writer = None
+
+    async def connect(self):
+        self.reader, self.writer = await asyncio.open_connection(self.host, self.port)
+        key = base64.b64encode(os.urandom(16)).decode()
+        request = (
+            "GET / HTTP/1.1\r\n"
+            f"Host: {self.host}:{self.port}\r\n"
+            "Upgrade: websocket\r\n"
+            "Connection: Upgrade\r\n"
+            f"Sec-WebSocket-Key: {key}\r\n"
+            "Sec-WebSocket-Version: 13\r\n\r\n"
+        )
+        self.writer.write(request.encode())
+        await self.writer.drain()
+        status = await asyncio.wait_for(self.reader.readline(), 5)
+        if b" 101 " not in status:
+            raise ConnectionError(f"handshake failed: {status!r}")
+        while (await self.reader.readline()) not in (b"\r\n", b""):
+            pass
+
+    async def send(self, text):
+        await self.send_frame(0x1, text.encode())
+
+    async def send_frame(self, opcode, payload):
+        mask = os.urandom(4)
+        header = bytearray([0x80 | opcode])
+        if len(payload) < 126:
+            header.append(0x80 | len(payload))
+        else:
+            header.append(0x80 | 126)
+            header += struct.pack(">H", len(payload))
+        masked = bytes(b ^ mask[i % 4] for i, b in enumerate(payload))
+        self.writer.write(bytes(header) + mask + masked)
+        await self.writer.drain()
+
+    async def receive(self):
+        """Следующее текстовое сообщение; None, если соединение закрыто."""
+        while True:
+            head = await self.reader.readexactly(2)
+            opcode = head[0] & 0x0F
+            length = head[1] & 0x7F
+            if length == 126:
+                length = struct.unpack(">H", await self.reader.readexactly(2))[0]
+            elif length == 127:
+                length = struct.unpack(">Q", await self.reader.readexactly(8))[0]
+            payload = await self.reader.readexactly(length)
+            if opcode == 0x1:
+                return payload.decode(errors="replace")
+            if opcode == 0x8:
+                return None
+            if opcode == 0x9:
+                # Как браузер: pong с тем же содержимым (по нему устройство считает RTT)
+                await self.send_frame(0xA, payload)
+
+    def close(self):
+        if self.writer:
+            self.writer.close()
+
+
+# ==================== Нагрузка ====================
+
+class LoadTest:
+    def __init__(self, args):
+        self.args = args
+        self.stats = Stats()
+        self.control = Control(args.host, args.control_port)
+        self.stop = asyncio.Event()
+        # Для каждого клиента: пин -> время фронта, ещё не дошедшего до клиента
+        self.pending = [dict() for _ in range(args.ws_clients)]
+        self.connected = [False] * args.ws_clients
+        self.samples = []
+        self.started = time.monotonic()
+        # Команды установки выходов: id -> время отправки
+        self.client_id = int.from_bytes(os.urandom(4), "big") >> 1 or 1
+        self.next_command_id = 1
+        self.pending_acks = {}
+
+    def edge(self, pin, when):
+        for num, pending in enumerate(self.pending):
+            if not self.connected[num]:
+                continue
+            if pin in pending:
+                # Предыдущий фронт так и не дошёл до клиента
+                self.stats.add("dropped")
+            pending[pin] = when
+
+    def expire(self, now):
+        timeout = self.args.timeout
+        for pending in self.pending:
+            for pin, when in list(pending.items()):
+                if now - when > timeout:
+                    del pending[pin]
+                    self.stats.add("dropped")
+
+    async def toggler(self, pin, offset):
+        period = self.args.period / 1000.0
+        level = 1
+        await asyncio.sleep(offset)
+        while not self.stop.is_set():
+            level ^= 1
+            when = time.monotonic()
+            try:
+                await self.control.command(f"set {pin} {level}")
+                self.edge(pin, when)
+                self.stats.add("edges")
+            except (OSError, asyncio.TimeoutError, ConnectionError):
+                self.stats.add("control_errors")
+                await asyncio.sleep(1)
+            await asyncio.sleep(period)
+
+    async def ws_client(self, num):
+        inputs = set(self.args.inputs)
+        while not self.stop.is_set():
+            client = WsClient(self.args.host, self.args.ws_port)
+            try:
+                await client.connect()
+                self.stats.add("ws_connects")
+                self.connected[num] = True
+                setter = None
+                if num == 0 and self.args.outputs and self.args.set_rate > 0:
+                    setter = asyncio.ensure_future(self.ws_setter(client))
+                try:
+                    while True:
+                        text = await client.receive()
+                        if text is None:
+                            break
+                        self.stats.add("ws_messages")
+                        self.stats.add("ws_bytes", len(text))
+                        self.on_message(num, text, inputs)
+                finally:
+                    if setter:
+                        setter.cancel()
+            except (OSError, asyncio.IncompleteReadError, asyncio.TimeoutError, ConnectionError):
+                pass
+            finally:
+                client.close()
+                self.connected[num] = False
+                self.pending[num].clear()
+            if not self.stop.is_set():
+                self.stats.add("ws_disconnects")
+                await asyncio.sleep(1)
+
+    def on_message(self, num, text, inputs):
+        try:
+            message = json.loads(text)
+        except ValueError:
+            self.stats.add("ws_bad_json")
+            return
+        if not isinstance(message, dict):
+            return
+        if "ack" in message or "nack" in message:
+            sent = self.pending_acks.pop(message.get("ack", message.get("nack")), None)
+            if sent is not None:
+                self.stats.ack((time.monotonic() - sent) * 1000)
+                self.stats.add("acks" if "ack" in message else "nacks")
+            return
+        if "pin" not in message or message["pin"] not in inputs:
+            return
+        when = self.pending[num].pop(message["pin"], None)
+        if when is not None:
+            self.stats.latency((time.monotonic() - when) * 1000)
+            self.stats.add("delivered")
+
+    async def ws_setter(self, client):
+        interval = 1.0 / self.args.set_rate
+        value = 0
+        while True:
+            value ^= 1
+            for pin in self.args.outputs:
+                command_id = self.next_command_id
+                self.next_command_id += 1
+                self.pending_acks[command_id] = time.monotonic()
+                await client.send(json.dumps({"pin": pin, "val": value, "id": command_id,
+                                              "cid": self.client_id}))
+                self.stats.add("ws_sets")
+            await asyncio.sleep(interval)
+
+    async def http_client(self):
+        request = (
+            "GET /api/info HTTP/1.1\r\n"
+            f"Host: {self.args.host}\r\n"
+            "Connection: close\r\n\r\n"
+        ).encode()
+        while not self.stop.is_set():
+            begin = time.monotonic()
+            try:
+                reader, writer = await asyncio.open_connection(self.args.host, self.args.http_port)
+                writer.write(request)
+                await writer.drain()
+                response = await asyncio.wait_for(reader.read(), 5)
+                writer.close()
+                if response.startswith(b"HTTP/1.1 200"):
+                    self.stats.http((time.monotonic() - begin) * 1000)
+                    self.stats.add("http_ok")
+                else:
+                    self.stats.add("http_errors")
+            except (OSError, asyncio.TimeoutError):
+                self.stats.add("http_errors")
+            await asyncio.sleep(self.args.http_interval / 1000.0)
+
+    async def reporter(self):
+        interval = self.args.report
+        last = time.monotonic()
+        last_loops = None
+        while not self.stop.is_set():
+            try:
+                await asyncio.wait_for(self.stop.wait(), interval)
+            except asyncio.TimeoutError:
+                pass
+            now = time.monotonic()
+            self.expire(now)
+            elapsed = now - last
+            last = now
+
+            try:
+                device = await self.control.stats()
+            except (OSError, asyncio.TimeoutError, ConnectionError):
+                device = {}
+            loops = device.get("loop_count")
+            loop_rate = (loops - last_loops) / elapsed if loops is not None and last_loops is not None else 0
+            last_loops = loops
+
+            window = self.stats.window
+            sample = {
+                "t": round(now - self.started, 1),
+                "edges_per_s": round(window.get("edges", 0) / elapsed, 1),
+                "ws_msgs_per_s": round(window.get("ws_messages", 0) / elapsed, 1),
+                "http_per_s": round(window.get("http_ok", 0) / elapsed, 1),
+                "p50_ms": round(percentile(self.stats.latency_window, 0.50), 2),
+                "p99_ms": round(percentile(self.stats.latency_window, 0.99), 2),
+                "http_p99_ms": round(percentile(self.stats.http_window, 0.99), 2),
+                "ack_p99_ms": round(percentile(self.stats.ack_window, 0.99), 2),
+                "dropped": window.get("dropped", 0),
+                "heap_used": device.get("heap_used", 0),
+                "rss_kb": device.get("rss_kb", 0),
+                "loop_rate": round(loop_rate),
+            }
+            self.samples.append(sample)
+            self.stats.reset_window()
+            print("[{t:>8}s] edges {edges_per_s}/s  ws {ws_msgs_per_s}/s  http {http_per_s}/s  "
+                  "p50 {p50_ms}ms p99 {p99_ms}ms  http p99 {http_p99_ms}ms  ack p99 {ack_p99_ms}ms  "
+                  "dropped {dropped}  "
+                  "heap {heap_used}  rss {rss_kb}kB  loop {loop_rate}/s".format(**sample), flush=True)
+
+    def summary(self):
+        total = self.stats.total
+        duration = time.monotonic() - self.started
+        first = self.samples[0] if self.samples else {}
+        last = self.samples[-1] if self.samples else {}
+        latency = self.stats.latency_total
+        expected = total.get("delivered", 0) + total.get("dropped", 0)
+        return {
+            "duration_s": round(duration, 1),
+            "ws_clients": self.args.ws_clients,
+            "http_clients": self.args.http_clients,
+            "edges": total.get("edges", 0),
+            "delivered": total.get("delivered", 0),
+            "dropped": total.get("dropped", 0),
+            "drop_ratio": round(total.get("dropped", 0) / expected, 6) if expected else 0,
+            "latency_p50_ms": round(percentile(latency, 0.50), 2),
+            "latency_p99_ms": round(percentile(latency, 0.99), 2),
+            "latency_max_ms": round(max(latency), 2) if latency else 0,
+            "ws_messages": total.get("ws_messages", 0),
+            "ws_messages_per_s": round(total.get("ws_messages", 0) / duration, 1) if duration else 0,
+            "ws_sets": total.get("ws_sets", 0),
+            "acks": total.get("acks", 0),
+            "nacks": total.get("nacks", 0),
+            "ack_p50_ms": round(percentile(self.stats.ack_total, 0.50), 2),
+            "ack_p99_ms": round(percentile(self.stats.ack_total, 0.99), 2),
+            "ws_disconnects": total.get("ws_disconnects", 0),
+            "http_ok": total.get("http_ok", 0),
+            "http_errors": total.get("http_errors", 0),
+            "http_p99_ms": round(percentile(self.stats.http_total, 0.99), 2),
+            "control_errors": total.get("control_errors", 0),
+            # Рост считается от первого отчёта, когда прогрев уже прошёл
+            "heap_growth": last.get("heap_used", 0) - first.get("heap_used", 0),
+            "rss_growth_kb": last.get("rss_kb", 0) - first.get("rss_kb", 0),
+            "samples": self.samples,
+        }
+
+    async def configure(self):
+        pins = [{"pin": p, "name": f"in{p}", "type": "input", "mode": "pullup"} for p in self.args.inputs]
+        pins += [{"pin": p, "name": f"out{p}", "type": "output", "mode": ""} for p in self.args.outputs]
+        body = json.dumps({"pins": pins}).encode()
+        await self.http_request("POST", "/api/config", body)
+        # Конфигурация пинов применяется после перезагрузки
+        await self.http_request("GET", "/api/reboot")
+        await asyncio.sleep(2)
+        for _ in range(30):
+            try:
+                await self.http_request("GET", "/api/info")
+                return
+            except (OSError, asyncio.TimeoutError):
+                await asyncio.sleep(1)
+        raise SystemExit("device did not come back after reboot")
+
+    async def http_request(self, method, path, body=b""):
+        reader, writer = await asyncio.open_connection(self.args.host, self.args.http_port)
+        writer.write((f"{method} {path} HTTP/1.1\r\nHost: {self.args.host}\r\n"
+                      f"Content-Type: application/json\r\nContent-Length: {len(body)}\r\n"
+                      "Connection: close\r\n\r\n").encode() + body)
+        await writer.drain()
+        response = await asyncio.wait_for(reader.read(), 5)
+        writer.close()
+        return response
+
+    async def run(self):
+        if self.args.configure:
+            await self.configure()
+
+        loop = asyncio.get_event_loop()
+        for sig in (signal.SIGINT, signal.SIGTERM):
+            loop.add_signal_handler(sig, self.stop.set)
+
+        tasks = [asyncio.ensure_future(self.ws_client(n)) for n in range(self.args.ws_clients)]
+        tasks += [asyncio.ensure_future(self.http_client()) for _ in range(self.args.http_clients)]
+        # Клиентам нужно время на подключение до первых фронтов
+        await asyncio.sleep(1)
+        period = self.args.period / 1000.0
+        count = max(1, len(self.args.inputs))
+        tasks += [asyncio.ensure_future(self.toggler(pin, period * i / count))
+                  for i, pin in enumerate(self.args.inputs)]
+        reporter = asyncio.ensure_future(self.reporter())
+
+        if self.args.duration > 0:
+            try:
+                await asyncio.wait_for(self.stop.wait(), self.args.duration)
+            except asyncio.TimeoutError:
+                pass
+        else:
+            await self.stop.wait()
+        self.stop.set()
+        await reporter
+        for task in tasks:
+            task.cancel()
+        await asyncio.gather(*tasks, return_exceptions=True)
+        summary = self.summary()
+        samples = summary.pop("samples")
+        # RTT, замеренный самим устройством по ping/pong (только сеть)
+        try:
+            response = await self.http_request("GET", "/api/clients")
+            rtt = json.loads(response.split(b"\r\n\r\n", 1)[1])["rtt"]
+            summary["device_rtt_p50_ms"] = rtt["p50_us"] / 1000
+            summary["device_rtt_p99_ms"] = rtt["p99_us"] / 1000
+        except (OSError, asyncio.TimeoutError, ValueError, KeyError, IndexError):
+            pass
+        summary["samples"] = samples
+        return summary
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Load and soak test for the GPIO controller emulator")
+    parser.add_argument("--host", default="127.0.0.1")
+    parser.add_argument("--port-offset", type=int, default=int(os.environ.get("EMU_PORT_OFFSET", 8000)),
+                        help="EMU_PORT_OFFSET of the emulator (default 8000)")
+    parser.add_argument("--inputs", type=parse_pins, default=[], help="input pins to toggle, e.g. 4,5,13")
+    parser.add_argument("--outputs", type=parse_pins, default=[], help="output pins for --set-rate")
+    parser.add_argument("--configure", action="store_true",
+                        help="write --inputs/--outputs to the pin config and reboot the device first")
+    parser.add_argument("--period", type=int, default=200,
+                        help="toggle period per input pin, ms (default 200)")
+    parser.add_argument("--ws-clients", type=int, default=4)
+    parser.add_argument("--http-clients", type=int, default=1)
+    parser.add_argument("--http-interval", type=int, default=500, help="ms between /api/info requests")
+    parser.add_argument("--set-rate", type=float, default=0, help="output set commands per second")
+    parser.add_argument("--timeout", type=float, default=2.0,
+                        help="an edge not delivered within this many seconds counts as dropped")
+    parser.add_argument("--duration", type=float, default=60, help="seconds, 0 = until Ctrl+C")
+    parser.add_argument("--report", type=float, default=10, help="report interval, seconds")
+    parser.add_argument("--json", help="write the summary to this file")
+    args = parser.parse_args()
+
+    if args.period <= 2 * DEBOUNCE_DELAY_MS:
+        parser.error(f"--period must be above {2 * DEBOUNCE_DELAY_MS} ms or edges are lost to debounce")
+    args.http_port = 80 + args.port_offset
+    args.ws_port = 81 + args.port_offset
+    args.control_port = 7000 + args.port_offset
+
+    summary = asyncio.get_event_loop().run_until_complete(LoadTest(args).run())
+
+    print("\n=== summary ===")
+    for key, value in summary.items():
+        if key != "samples":
+            print(f"{key:>20}: {value}")
+    if args.json:
+        with open(args.json, "w") as f:
+            json.dump(summary, f, indent=2)
+
+
+if __name__ == "__main__":
+    main()